@@ -115,6 +115,7 @@ fn buildPango(
         "-DPANGO_COMPILATION",
         "-DSYSCONFDIR=\"\"",
         "-DLIBDIR=\"\"",
+        "-DDICTDIR=\"\"",
     };
     lib.addCSourceFiles(.{
         .files = &.{
@@ -0,0 +1,491 @@
+/* Pango
+ * break-dict.c: Dictionary-based word breaking
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include "config.h"
+
+#include "pango-break.h"
+#include "pango-impl-utils.h"
+#include <string.h>
+
+/* Scripts like Thai, Lao, Khmer and Myanmar don't mark word
+ * boundaries, so we find them by segmenting runs of letters
+ * into dictionary words.
+ *
+ * The dictionaries are tries compiled from word lists by
+ * tools/gen-break-dict.py, and are mapped from disk as they
+ * are. They are looked up as <script>.dict in $PANGO_DICTDIR,
+ * then in the dictionary directory of the installation, then
+ * in pango/dict in the system data directories.
+ *
+ * The file starts with a BreakDictHeader, followed by
+ * n_nodes BreakDictNodes, then the target node of each edge
+ * as a guint32 and the label of each edge as a guint8. All
+ * numbers are little-endian. Labels are codepoints relative
+ * to header->base; the edges of a node are sorted by label.
+ * Node 0 is the root.
+ */
+
+#define BREAK_DICT_MAGIC 0x44424750 /* "PGBD" */
+#define BREAK_DICT_VERSION 1
+
+typedef struct
+{
+  guint32 magic;
+  guint32 version;
+  guint32 base;
+  guint32 n_nodes;
+  guint32 n_edges;
+  guint32 max_word_length;
+} BreakDictHeader;
+
+typedef struct
+{
+  guint32 first_edge;
+  guint16 n_edges;
+  guint16 is_word;
+} BreakDictNode;
+
+typedef struct
+{
+  GMappedFile *file;
+  gunichar base;
+  guint32 n_nodes;
+  guint32 n_edges;
+  guint max_word_length;
+  const BreakDictNode *nodes;
+  const guint32 *targets;
+  const guint8 *labels;
+} BreakDict;
+
+typedef enum
+{
+  BREAK_DICT_THAI,
+  BREAK_DICT_LAO,
+  BREAK_DICT_KHMER,
+  BREAK_DICT_MYANMAR,
+  N_BREAK_DICTS
+} BreakDictId;
+
+static const char *break_dict_names[N_BREAK_DICTS] = {
+  "thai",
+  "lao",
+  "khmer",
+  "myanmar",
+};
+
+static BreakDict *
+break_dict_open (const char *filename)
+{
+  GMappedFile *file;
+  const char *data;
+  gsize size;
+  BreakDictHeader header;
+  BreakDict *dict;
+
+  file = g_mapped_file_new (filename, FALSE, NULL);
+  if (!file)
+    return NULL;
+
+  data = g_mapped_file_get_contents (file);
+  size = g_mapped_file_get_length (file);
+
+  if (size < sizeof (BreakDictHeader))
+    goto invalid;
+
+  memcpy (&header, data, sizeof (BreakDictHeader));
+  header.magic = GUINT32_FROM_LE (header.magic);
+  header.version = GUINT32_FROM_LE (header.version);
+  header.base = GUINT32_FROM_LE (header.base);
+  header.n_nodes = GUINT32_FROM_LE (header.n_nodes);
+  header.n_edges = GUINT32_FROM_LE (header.n_edges);
+  header.max_word_length = GUINT32_FROM_LE (header.max_word_length);
+
+  if (header.magic != BREAK_DICT_MAGIC ||
+      header.version != BREAK_DICT_VERSION ||
+      header.n_nodes == 0 ||
+      header.n_nodes > size / sizeof (BreakDictNode) ||
+      header.n_edges > size / (sizeof (guint32) + 1) ||
+      size < sizeof (BreakDictHeader) +
+             header.n_nodes * sizeof (BreakDictNode) +
+             header.n_edges * (sizeof (guint32) + 1))
+    goto invalid;
+
+  dict = g_new0 (BreakDict, 1);
+  dict->file = file;
+  dict->base = header.base;
+  dict->n_nodes = header.n_nodes;
+  dict->n_edges = header.n_edges;
+  dict->max_word_length = header.max_word_length;
+  dict->nodes = (const BreakDictNode *) (data + sizeof (BreakDictHeader));
+  dict->targets = (const guint32 *) (dict->nodes + header.n_nodes);
+  dict->labels = (const guint8 *) (dict->targets + header.n_edges);
+
+  return dict;
+
+invalid:
+  g_warning ("Ignoring invalid break dictionary %s", filename);
+  g_mapped_file_unref (file);
+  return NULL;
+}
+
+static BreakDict *
+break_dict_try (const char *dir,
+                const char *basename)
+{
+  char *filename;
+  BreakDict *dict = NULL;
+
+  if (!dir || !*dir)
+    return NULL;
+
+  filename = g_build_filename (dir, basename, NULL);
+  if (g_file_test (filename, G_FILE_TEST_EXISTS))
+    dict = break_dict_open (filename);
+  g_free (filename);
+
+  return dict;
+}
+
+static BreakDict *
+break_dict_find (const char *name)
+{
+  const char * const *dirs;
+  char *basename;
+  BreakDict *dict;
+
+  basename = g_strconcat (name, ".dict", NULL);
+
+  dict = break_dict_try (g_getenv ("PANGO_DICTDIR"), basename);
+
+  if (!dict)
+    dict = break_dict_try (DICTDIR, basename);
+
+  for (dirs = g_get_system_data_dirs (); *dirs && !dict; dirs++)
+    {
+      char *dir = g_build_filename (*dirs, "pango", "dict", NULL);
+      dict = break_dict_try (dir, basename);
+      g_free (dir);
+    }
+
+  g_free (basename);
+
+  return dict;
+}
+
+/* Dictionaries are loaded on first use and kept for the
+ * lifetime of the process. Returns NULL if there is no
+ * dictionary for @id.
+ */
+static BreakDict *
+break_dict_get (BreakDictId id)
+{
+  static gsize loaded[N_BREAK_DICTS];
+  static BreakDict *dicts[N_BREAK_DICTS];
+
+  if (g_once_init_enter (&loaded[id]))
+    {
+      dicts[id] = break_dict_find (break_dict_names[id]);
+      g_once_init_leave (&loaded[id], 1);
+    }
+
+  return dicts[id];
+}
+
+/* Returns the child of @node along the edge for @ch, or 0 */
+static inline guint32
+break_dict_child (const BreakDict *dict,
+                  guint32          node,
+                  gunichar         ch)
+{
+  const BreakDictNode *n = &dict->nodes[node];
+  guint32 first = GUINT32_FROM_LE (n->first_edge);
+  guint n_edges = GUINT16_FROM_LE (n->n_edges);
+  int lower, upper;
+  guint label;
+
+  if (ch < dict->base || ch - dict->base > G_MAXUINT8)
+    return 0;
+  label = ch - dict->base;
+
+  /* Don't trust the file */
+  if (first > dict->n_edges || n_edges > dict->n_edges - first)
+    return 0;
+
+  lower = 0;
+  upper = (int) n_edges - 1;
+  while (lower <= upper)
+    {
+      int mid = (lower + upper) / 2;
+      guint l = dict->labels[first + mid];
+
+      if (label < l)
+        upper = mid - 1;
+      else if (label > l)
+        lower = mid + 1;
+      else
+        {
+          guint32 target = GUINT32_FROM_LE (dict->targets[first + mid]);
+          return target < dict->n_nodes ? target : 0;
+        }
+    }
+
+  return 0;
+}
+
+/* Segmentation works on phrases, runs of letters of the
+ * dictionary's script that are up to this long. Longer runs are
+ * segmented in pieces, which keeps all the state on the stack.
+ */
+#define MAX_PHRASE_LENGTH 256
+
+typedef struct
+{
+  guint16 unknown;   /* characters not covered by dictionary words */
+  guint16 words;     /* number of segments */
+  gint16 prev;       /* start of the last segment, -1 if unreachable */
+  guint8 is_unknown; /* whether the last segment is unknown */
+} SegmentState;
+
+static inline gboolean
+segment_better (guint unknown,
+                guint words,
+                const SegmentState *s)
+{
+  return s->prev < 0 ||
+         unknown < s->unknown ||
+         (unknown == s->unknown && words < s->words);
+}
+
+static void
+mark_boundary (PangoLogAttr *attr)
+{
+  if (!attr->is_line_break)
+    {
+      /* Satisfy invariants by marking it as char break too */
+      attr->is_char_break = TRUE;
+      attr->is_line_break = TRUE;
+    }
+  if (!(attr->is_word_start || attr->is_word_end))
+    {
+      /* Only end and start a word if default_break
+       * didn't find a boundary here already
+       */
+      attr->is_word_start = TRUE;
+      attr->is_word_end = TRUE;
+    }
+}
+
+/* Finds word boundaries in the phrase @chars[0..n_chars] by
+ * maximal matching: among the segmentations into dictionary words
+ * and unknown clusters, pick the one with the fewest characters in
+ * unknown clusters, then the one with the fewest words. Boundaries
+ * are only placed where @attrs has a cursor position.
+ *
+ * Returns the position of the last boundary marked, or 0
+ */
+static int
+segment_phrase (const BreakDict *dict,
+                const gunichar  *chars,
+                int              n_chars,
+                PangoLogAttr    *attrs)
+{
+  SegmentState state[MAX_PHRASE_LENGTH + 1];
+  int last = 0;
+  int i, j;
+
+  state[0].unknown = 0;
+  state[0].words = 0;
+  state[0].prev = 0;
+  state[0].is_unknown = FALSE;
+  for (i = 1; i <= n_chars; i++)
+    state[i].prev = -1;
+
+  for (i = 0; i < n_chars; i++)
+    {
+      guint32 node = 0;
+      guint unknown, words;
+
+      if (state[i].prev < 0)
+        continue;
+
+      unknown = state[i].unknown;
+      words = state[i].words + 1;
+
+      /* Dictionary words starting here */
+      for (j = i; j < n_chars && j - i < (int) dict->max_word_length; j++)
+        {
+          node = break_dict_child (dict, node, chars[j]);
+          if (node == 0)
+            break;
+
+          if (GUINT16_FROM_LE (dict->nodes[node].is_word) &&
+              (j + 1 == n_chars || attrs[j + 1].is_cursor_position) &&
+              segment_better (unknown, words, &state[j + 1]))
+            {
+              state[j + 1].unknown = unknown;
+              state[j + 1].words = words;
+              state[j + 1].prev = i;
+              state[j + 1].is_unknown = FALSE;
+            }
+        }
+
+      /* Or an unknown cluster */
+      for (j = i + 1; j < n_chars && !attrs[j].is_cursor_position; j++)
+        ;
+      unknown += j - i;
+      if (segment_better (unknown, words, &state[j]))
+        {
+          state[j].unknown = unknown;
+          state[j].words = words;
+          state[j].prev = i;
+          state[j].is_unknown = TRUE;
+        }
+    }
+
+  /* Walk back and mark the boundaries, keeping runs
+   * of unknown clusters together
+   */
+  for (i = n_chars; i > 0; i = state[i].prev)
+    {
+      j = state[i].prev;
+
+      if (j == 0 || (state[i].is_unknown && state[j].is_unknown))
+        continue;
+
+      mark_boundary (&attrs[j]);
+      last = MAX (last, j);
+    }
+
+  return last;
+}
+
+static inline gboolean
+is_phrase_char (const BreakDict *dict,
+                gunichar         ch)
+{
+  if (ch < dict->base || ch - dict->base > G_MAXUINT8)
+    return FALSE;
+
+  switch ((int) g_unichar_type (ch))
+    {
+    case G_UNICODE_OTHER_LETTER:
+    case G_UNICODE_MODIFIER_LETTER:
+    case G_UNICODE_NON_SPACING_MARK:
+    case G_UNICODE_SPACING_MARK:
+      return TRUE;
+    default:
+      return FALSE;
+    }
+}
+
+/* Returns FALSE if there is no dictionary for @id */
+static gboolean
+break_dict (BreakDictId    id,
+            const char    *text,
+            int            length,
+            PangoLogAttr  *attrs)
+{
+  const BreakDict *dict;
+  gunichar chars[MAX_PHRASE_LENGTH];
+  const char *p;
+  int i, n_chars, start;
+
+  dict = break_dict_get (id);
+  if (!dict)
+    return FALSE;
+
+  n_chars = 0;
+  start = 0;
+  for (p = text, i = 0; ; p = g_utf8_next_char (p), i++)
+    {
+      gunichar ch = p < text + length ? g_utf8_get_char (p) : 0;
+      gboolean in_phrase = ch != 0 && is_phrase_char (dict, ch);
+
+      if (in_phrase && n_chars == MAX_PHRASE_LENGTH)
+        {
+          int end;
+
+          /* Segment an overlong phrase and carry what follows its
+           * last boundary over, to be segmented together with the
+           * rest. Without a boundary, cut at the last cursor position
+           */
+          end = segment_phrase (dict, chars, n_chars, attrs + start);
+          if (end == 0)
+            {
+              for (end = n_chars - 1; end > 0 && !attrs[start + end].is_cursor_position; end--)
+                ;
+              if (end > 0)
+                mark_boundary (&attrs[start + end]);
+              else
+                end = n_chars;
+            }
+
+          memmove (chars, chars + end, (n_chars - end) * sizeof (gunichar));
+          n_chars -= end;
+          start += end;
+        }
+
+      if (in_phrase)
+        {
+          if (n_chars == 0)
+            start = i;
+          chars[n_chars++] = ch;
+          continue;
+        }
+
+      if (n_chars > 0)
+        segment_phrase (dict, chars, n_chars, attrs + start);
+      n_chars = 0;
+
+      if (p >= text + length)
+        break;
+    }
+
+  return TRUE;
+}
+
+static void
+break_lao (const char          *text,
+           int                  length,
+           const PangoAnalysis *analysis G_GNUC_UNUSED,
+           PangoLogAttr        *attrs,
+           int                  attrs_len G_GNUC_UNUSED)
+{
+  break_dict (BREAK_DICT_LAO, text, length, attrs);
+}
+
+static void
+break_khmer (const char          *text,
+             int                  length,
+             const PangoAnalysis *analysis G_GNUC_UNUSED,
+             PangoLogAttr        *attrs,
+             int                  attrs_len G_GNUC_UNUSED)
+{
+  break_dict (BREAK_DICT_KHMER, text, length, attrs);
+}
+
+static void
+break_myanmar (const char          *text,
+               int                  length,
+               const PangoAnalysis *analysis G_GNUC_UNUSED,
+               PangoLogAttr        *attrs,
+               int                  attrs_len G_GNUC_UNUSED)
+{
+  break_dict (BREAK_DICT_MYANMAR, text, length, attrs);
+}
@@ -66,7 +66,13 @@ break_thai (const char          *text,
   thchar_t *tis_text;
   int *brk_pnts;
   int cnt;
+#endif
+
+  /* Prefer the built-in segmenter when a dictionary is installed */
+  if (break_dict (BREAK_DICT_THAI, text, len, attrs))
+    return;
 
+#ifdef HAVE_LIBTHAI
   cnt = pango_utf8_strlen (text, len) + 1;
 
   tis_text = tis_stack;
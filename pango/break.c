@@ -150,7 +150,8 @@ default_break (const char    *text,
                int            length,
                PangoAnalysis *analysis G_GNUC_UNUSED,
                PangoLogAttr  *attrs,
-               int            attrs_len G_GNUC_UNUSED)
+               int            attrs_len G_GNUC_UNUSED,
+               gboolean       with_sentences)
 {
   /* The rationale for all this is in section 5.15 of the Unicode 3.0 book,
    * the line breaking stuff is also in TR14 on unicode.org
@@ -318,7 +319,7 @@ default_break (const char    *text,
       /* UAX#29 boundaries */
       gboolean is_grapheme_boundary;
       gboolean is_word_boundary;
-      gboolean is_sentence_boundary;
+      gboolean is_sentence_boundary = FALSE;
 
       /* Emoji extended pictographics */
       gboolean is_Extended_Pictographic;
@@ -858,6 +859,7 @@ default_break (const char    *text,
       }
 
       /* ---- UAX#29 Sentence Boundaries ---- */
+      if (with_sentences)
       {
 	is_sentence_boundary = FALSE;
 	if (is_word_boundary ||
@@ -1800,6 +1802,13 @@ default_break (const char    *text,
 	}
 
       /* ---- Sentence breaks ---- */
+      if (!with_sentences)
+        {
+	  attrs[i].is_sentence_boundary = FALSE;
+	  attrs[i].is_sentence_start = FALSE;
+	  attrs[i].is_sentence_end = FALSE;
+        }
+      else
       {
 
 	/* default to not a sentence start/end */
@@ -1937,6 +1946,7 @@ default_break (const char    *text,
 
 #include "break-arabic.c"
 #include "break-indic.c"
+#include "break-dict.c"
 #include "break-thai.c"
 #include "break-latin.c"
 
@@ -1970,6 +1980,18 @@ break_script (const char          *item_text,
       break_thai (item_text, item_length, analysis, attrs, attrs_len);
       break;
 
+    case PANGO_SCRIPT_LAO:
+      break_lao (item_text, item_length, analysis, attrs, attrs_len);
+      break;
+
+    case PANGO_SCRIPT_KHMER:
+      break_khmer (item_text, item_length, analysis, attrs, attrs_len);
+      break;
+
+    case PANGO_SCRIPT_MYANMAR:
+      break_myanmar (item_text, item_length, analysis, attrs, attrs_len);
+      break;
+
     case PANGO_SCRIPT_LATIN:
       break_latin (item_text, item_length, analysis, attrs, attrs_len);
       break;
@@ -2455,7 +2477,33 @@ pango_default_break (const char    *text,
 {
   PangoLogAttr before = *attrs;
 
-  default_break (text, length, analysis, attrs, attrs_len);
+  default_break (text, length, analysis, attrs, attrs_len, TRUE);
+
+  attrs->is_line_break      |= before.is_line_break;
+  attrs->is_mandatory_break |= before.is_mandatory_break;
+  attrs->is_cursor_position |= before.is_cursor_position;
+}
+
+/*< private >
+ * _pango_default_break_without_sentences:
+ * @text: text to break. Must be valid UTF-8
+ * @length: length of text in bytes (may be -1 if @text is nul-terminated)
+ * @attrs: logical attributes to fill in
+ * @attrs_len: size of the array passed as @attrs
+ *
+ * Like [func@Pango.default_break], but skips the sentence boundary
+ * rules and leaves all sentence attributes unset. Line breaking does
+ * not need them, so the layout code fills them in on demand.
+ */
+void
+_pango_default_break_without_sentences (const char   *text,
+                                        int           length,
+                                        PangoLogAttr *attrs,
+                                        int           attrs_len)
+{
+  PangoLogAttr before = *attrs;
+
+  default_break (text, length, NULL, attrs, attrs_len, FALSE);
 
   attrs->is_line_break      |= before.is_line_break;
   attrs->is_mandatory_break |= before.is_mandatory_break;
@@ -2488,7 +2536,7 @@ pango_break (const char    *text,
   g_return_if_fail (analysis != NULL);
   g_return_if_fail (attrs != NULL);
 
-  default_break (text, length, analysis, attrs, attrs_len);
+  default_break (text, length, analysis, attrs, attrs_len, TRUE);
   tailor_break (text, length, analysis, -1, attrs, attrs_len);
 }
 
@@ -2513,6 +2561,15 @@ pango_break (const char    *text,
  * Note that it is better to pass -1 for @offset and use [func@Pango.attr_break]
  * to apply attributes to the whole paragraph.
  *
+ * Words in Thai, Lao, Khmer and Myanmar text are found with a dictionary,
+ * if one is installed for the script. Dictionaries are looked up as
+ * `<script>.dict`, for example `lao.dict`, first in the directory named
+ * by the `PANGO_DICTDIR` environment variable, then in `pango/dict` in
+ * the data directory of Pango, then in `pango/dict` in the system data
+ * directories. Pango's `break-dicts` build option creates them from
+ * word lists. Without a dictionary, Thai text is broken with libthai,
+ * if available.
+ *
  * Since: 1.44
  */
 void
@@ -2540,6 +2597,65 @@ pango_tailor_break (const char    *text,
     }
 }
 
+/*< private >
+ * _pango_tailor_break_items:
+ * @text: the paragraph text
+ * @items: (element-type PangoItem): the items of the paragraph,
+ *   in logical order
+ * @attrs: (array length=attrs_len): the log attrs of the paragraph,
+ *   as produced by [func@Pango.default_break]
+ * @attrs_len: length of @attrs array
+ *
+ * Applies [func@Pango.tailor_break] to all of @items.
+ *
+ * Adjacent items that only differ in font or other properties
+ * that don't affect breaking are tailored together, so each
+ * script- or language-specific pass runs once over a span of
+ * text instead of once per item. This also lets the tailoring
+ * see context across such item boundaries.
+ */
+void
+_pango_tailor_break_items (const char   *text,
+                           GList        *items,
+                           PangoLogAttr *attrs,
+                           int           attrs_len)
+{
+  GList *l;
+  int offset = 0;
+
+  l = items;
+  while (l)
+    {
+      PangoItem *item = l->data;
+      int length = item->length;
+      int num_chars = item->num_chars;
+
+      for (l = l->next; l; l = l->next)
+        {
+          PangoItem *next = l->data;
+
+          if (next->offset != item->offset + length ||
+              next->analysis.script != item->analysis.script ||
+              next->analysis.language != item->analysis.language)
+            break;
+
+          length += next->length;
+          num_chars += next->num_chars;
+        }
+
+      g_assert (offset + num_chars < attrs_len);
+
+      pango_tailor_break (text + item->offset,
+                          length,
+                          &item->analysis,
+                          -1,
+                          attrs + offset,
+                          num_chars + 1);
+
+      offset += num_chars;
+    }
+}
+
 /**
  * pango_attr_break:
  * @text: text to break. Must be valid UTF-8
@@ -25,12 +25,16 @@
 #include "pango-glyph-item.h"
 #include "pango-layout-private.h"
 #include "pango-font-private.h"
+#include "pango-item-private.h"
 #include "pango-attributes-private.h"
 #include "pango-impl-utils.h"
 
-typedef struct _EllipsizeState EllipsizeState;
-typedef struct _RunInfo        RunInfo;
-typedef struct _LineIter       LineIter;
+typedef struct _EllipsizeState   EllipsizeState;
+typedef struct _RunInfo          RunInfo;
+typedef struct _LineIter         LineIter;
+typedef struct _EllipsizeCluster EllipsizeCluster;
+typedef struct _EllipsizeStep    EllipsizeStep;
+typedef struct _EllipsizePlan    EllipsizePlan;
 
 
 /* Overall, the way we ellipsize is we grow a "gap" out from an original
@@ -61,6 +65,12 @@ typedef struct _LineIter       LineIter;
  *
  * All computations are done using logical order; the ellipsization
  * process occurs before the runs are ordered into visual order.
+ *
+ * The way the gap grows does not depend on the goal width, only on
+ * the line. So we record the cluster positions of the line and every
+ * step of the growth in a plan, and then find the first step that
+ * fits with a binary search. The layout keeps the plans while only
+ * its width changes, so resizing doesn't redo the work for each line.
  */
 
 /* Keeps information about a single run */
@@ -78,6 +88,54 @@ struct _LineIter
   int run_index;
 };
 
+/* A cluster of the line, with the state of a PangoGlyphItemIter
+ * pointing to it
+ */
+struct _EllipsizeCluster
+{
+  int run_index;
+  int start_glyph;
+  int start_index;
+  int start_char;
+  int end_glyph;
+  int end_index;
+  int end_char;
+
+  int x;			/* x position of the cluster in the line, in Pango units */
+  int width;			/* Width of the cluster, in Pango units */
+
+  guint starts_boundary : 1;	/* Whether there is an ellipsization boundary before */
+  guint ends_boundary : 1;	/* Whether there is an ellipsization boundary after */
+};
+
+/* One step in growing the gap */
+struct _EllipsizeStep
+{
+  int gap_start;		/* First cluster in the gap */
+  int gap_end;			/* Last cluster in the gap */
+  int width;			/* Width of the ellipsized line */
+  int min_width;		/* Smallest width of the line at this or any earlier step */
+  int ellipsis;			/* Index of the shaped ellipsis in the plan */
+};
+
+/* All steps in ellipsizing a line, for any goal width */
+struct _EllipsizePlan
+{
+  /* The line the plan was made for */
+  int start_index;
+  int length;
+  int n_runs;
+  int total_width;
+  PangoShapeFlags shape_flags;
+  int n_positions;
+
+  EllipsizeCluster *clusters;
+  int n_clusters;
+
+  GArray *steps;		/* EllipsizeStep */
+  GPtrArray *ellipses;		/* PangoGlyphItem for each shaping of the ellipsis */
+};
+
 /* State of ellipsization process */
 struct _EllipsizeState
 {
@@ -107,7 +165,12 @@ struct _EllipsizeState
   LineIter gap_end_iter;	/* Iterator pointing to last cluster in gap */
   int gap_end_x;		/* x position of end of gap, in Pango units */
 
+  EllipsizePlan *plan;		/* Plan for the line */
+  int gap_start;		/* Index of first cluster in gap */
+  int gap_end;			/* Index of last cluster in gap */
+
   PangoShapeFlags shape_flags;
+  int n_positions;		/* Subpixel positions to quantize to, or 0 */
 };
 
 /* Compute global information needed for the itemization process
@@ -116,7 +179,8 @@ static void
 init_state (EllipsizeState  *state,
             PangoLayoutLine *line,
             PangoAttrList   *attrs,
-            PangoShapeFlags  shape_flags)
+            PangoShapeFlags  shape_flags,
+            int              n_positions)
 {
   GSList *l;
   int i;
@@ -129,6 +193,7 @@ init_state (EllipsizeState  *state,
     state->attrs = pango_attr_list_new ();
 
   state->shape_flags = shape_flags;
+  state->n_positions = n_positions;
 
   state->n_runs = g_slist_length (line->runs);
   state->run_info = g_new (RunInfo, state->n_runs);
@@ -153,6 +218,7 @@ init_state (EllipsizeState  *state,
   state->ellipsis_is_cjk = FALSE;
   state->line_start_attr = NULL;
   state->gap_start_attr = NULL;
+  state->plan = NULL;
 }
 
 /* Cleanup memory allocation
@@ -214,28 +280,6 @@ line_iter_next_cluster (EllipsizeState *state,
   return TRUE;
 }
 
-/* Move backward one cluster. Returns %FALSE if we were already at the end
- */
-static gboolean
-line_iter_prev_cluster (EllipsizeState *state,
-			LineIter       *iter)
-{
-  if (!pango_glyph_item_iter_prev_cluster (&iter->run_iter))
-    {
-      if (iter->run_index == 0)
-	return FALSE;
-      else
-	{
-	  iter->run_index--;
-	  pango_glyph_item_iter_init_end (&iter->run_iter,
-					  state->run_info[iter->run_index].run,
-					  state->layout->text);
-	}
-    }
-
-  return TRUE;
-}
-
 /*
  * An ellipsization boundary is defined by two things
  *
@@ -379,14 +423,17 @@ shape_ellipsis (EllipsizeState *state)
   glyphs = state->ellipsis_run->glyphs;
 
   len = strlen (ellipsis_text);
-  pango_shape_with_flags (ellipsis_text, len,
-                          ellipsis_text, len,
-	                  &item->analysis, glyphs,
-                          state->shape_flags);
+  pango_shape_internal (ellipsis_text, len,
+                        ellipsis_text, len,
+                        &item->analysis, NULL, 0,
+                        glyphs,
+                        state->shape_flags, state->n_positions);
 
   state->ellipsis_width = 0;
   for (i = 0; i < glyphs->num_glyphs; i++)
     state->ellipsis_width += glyphs->glyphs[i].geometry.width;
+
+  g_ptr_array_add (state->plan->ellipses, pango_glyph_item_copy (state->ellipsis_run));
 }
 
 /* Helper function to advance a PangoAttrIterator to a particular
@@ -477,17 +524,99 @@ update_ellipsis_shape (EllipsizeState *state)
     shape_ellipsis (state);
 }
 
+/* Points @iter to the cluster @index of the plan
+ */
+static void
+line_iter_init_at (EllipsizeState *state,
+                   LineIter       *iter,
+                   int             index)
+{
+  EllipsizeCluster *cluster = &state->plan->clusters[index];
+
+  iter->run_index = cluster->run_index;
+  iter->run_iter.glyph_item = state->run_info[cluster->run_index].run;
+  iter->run_iter.text = state->layout->text;
+  iter->run_iter.start_glyph = cluster->start_glyph;
+  iter->run_iter.start_index = cluster->start_index;
+  iter->run_iter.start_char = cluster->start_char;
+  iter->run_iter.end_glyph = cluster->end_glyph;
+  iter->run_iter.end_index = cluster->end_index;
+  iter->run_iter.end_char = cluster->end_char;
+}
+
+/* Records the position, width and boundaries of every cluster in the line
+ */
+static void
+init_clusters (EllipsizeState *state)
+{
+  EllipsizePlan *plan = state->plan;
+  GArray *clusters;
+  LineIter iter;
+  int x;
+
+  clusters = g_array_new (FALSE, FALSE, sizeof (EllipsizeCluster));
+
+  iter.run_index = 0;
+  pango_glyph_item_iter_init_start (&iter.run_iter, state->run_info[0].run, state->layout->text);
+
+  x = 0;
+  do
+    {
+      EllipsizeCluster cluster;
+
+      cluster.run_index = iter.run_index;
+      cluster.start_glyph = iter.run_iter.start_glyph;
+      cluster.start_index = iter.run_iter.start_index;
+      cluster.start_char = iter.run_iter.start_char;
+      cluster.end_glyph = iter.run_iter.end_glyph;
+      cluster.end_index = iter.run_iter.end_index;
+      cluster.end_char = iter.run_iter.end_char;
+      cluster.x = x;
+      cluster.width = get_cluster_width (&iter);
+      cluster.starts_boundary = starts_at_ellipsization_boundary (state, &iter);
+      cluster.ends_boundary = ends_at_ellipsization_boundary (state, &iter);
+
+      g_array_append_val (clusters, cluster);
+
+      x += cluster.width;
+    }
+  while (line_iter_next_cluster (state, &iter));
+
+  plan->n_clusters = clusters->len;
+  plan->clusters = (EllipsizeCluster *) g_array_free (clusters, FALSE);
+}
+
+/* Moves the gap start to the cluster @index of the plan
+ */
+static void
+set_gap_start (EllipsizeState *state,
+               int             index)
+{
+  state->gap_start = index;
+  state->gap_start_x = state->plan->clusters[index].x;
+  line_iter_init_at (state, &state->gap_start_iter, index);
+}
+
+/* Moves the gap end to the cluster @index of the plan
+ */
+static void
+set_gap_end (EllipsizeState *state,
+             int             index)
+{
+  EllipsizeCluster *cluster = &state->plan->clusters[index];
+
+  state->gap_end = index;
+  state->gap_end_x = cluster->x + cluster->width;
+}
+
 /* Computes the position of the gap center and finds the smallest span containing it
  */
 static void
 find_initial_span (EllipsizeState *state)
 {
-  PangoGlyphItem *glyph_item;
-  PangoGlyphItemIter *run_iter;
-  gboolean have_cluster;
-  int i;
-  int x;
-  int cluster_width;
+  EllipsizePlan *plan = state->plan;
+  int start, end;
+  int lo, hi;
 
   switch (state->layout->ellipsize)
     {
@@ -505,63 +634,33 @@ find_initial_span (EllipsizeState *state)
       break;
     }
 
-  /* Find the run containing the gap center
-   */
-  x = 0;
-  for (i = 0; i < state->n_runs; i++)
-    {
-      if (x + state->run_info[i].width > state->gap_center)
-	break;
-
-      x += state->run_info[i].width;
-    }
-
-  if (i == state->n_runs)	/* Last run is a closed interval, so back off one run */
-    {
-      i--;
-      x -= state->run_info[i].width;
-    }
-
-  /* Find the cluster containing the gap center
+  /* Find the first cluster that ends after the gap center
    */
-  state->gap_start_iter.run_index = i;
-  run_iter = &state->gap_start_iter.run_iter;
-  glyph_item = state->run_info[i].run;
-
-  cluster_width = 0;		/* Quiet GCC, the line must have at least one cluster */
-  for (have_cluster = pango_glyph_item_iter_init_start (run_iter, glyph_item, state->layout->text);
-       have_cluster;
-       have_cluster = pango_glyph_item_iter_next_cluster (run_iter))
+  lo = 0;
+  hi = plan->n_clusters;
+  while (lo < hi)
     {
-      cluster_width = get_cluster_width (&state->gap_start_iter);
-
-      if (x + cluster_width > state->gap_center)
-	break;
+      int mid = (lo + hi) / 2;
 
-      x += cluster_width;
+      if (plan->clusters[mid].x + plan->clusters[mid].width > state->gap_center)
+        hi = mid;
+      else
+        lo = mid + 1;
     }
 
-  if (!have_cluster)	/* Last cluster is a closed interval, so back off one cluster */
-    x -= cluster_width;
-
-  state->gap_end_iter = state->gap_start_iter;
-
-  state->gap_start_x = x;
-  state->gap_end_x = x + cluster_width;
+  if (lo == plan->n_clusters)	/* Last cluster is a closed interval, so back off one cluster */
+    lo--;
 
   /* Expand the gap to a full span
    */
-  while (!starts_at_ellipsization_boundary (state, &state->gap_start_iter))
-    {
-      line_iter_prev_cluster (state, &state->gap_start_iter);
-      state->gap_start_x -= get_cluster_width (&state->gap_start_iter);
-    }
+  start = end = lo;
+  while (!plan->clusters[start].starts_boundary)
+    start--;
+  while (!plan->clusters[end].ends_boundary)
+    end++;
 
-  while (!ends_at_ellipsization_boundary (state, &state->gap_end_iter))
-    {
-      line_iter_next_cluster (state, &state->gap_end_iter);
-      state->gap_end_x += get_cluster_width (&state->gap_end_iter);
-    }
+  set_gap_start (state, start);
+  set_gap_end (state, end);
 
   update_ellipsis_shape (state);
 }
@@ -572,37 +671,33 @@ find_initial_span (EllipsizeState *state)
 static gboolean
 remove_one_span (EllipsizeState *state)
 {
-  LineIter new_gap_start_iter;
-  LineIter new_gap_end_iter;
+  EllipsizeCluster *clusters = state->plan->clusters;
+  int new_gap_start;
+  int new_gap_end;
   int new_gap_start_x;
   int new_gap_end_x;
-  int width;
 
   /* Find one span backwards and forward from the gap
    */
-  new_gap_start_iter = state->gap_start_iter;
-  new_gap_start_x = state->gap_start_x;
-  do
+  new_gap_start = state->gap_start;
+  while (new_gap_start > 0)
     {
-      if (!line_iter_prev_cluster (state, &new_gap_start_iter))
-	break;
-      width = get_cluster_width (&new_gap_start_iter);
-      new_gap_start_x -= width;
+      new_gap_start--;
+      if (clusters[new_gap_start].starts_boundary &&
+          clusters[new_gap_start].width != 0)
+        break;
     }
-  while (!starts_at_ellipsization_boundary (state, &new_gap_start_iter) ||
-	 width == 0);
+  new_gap_start_x = clusters[new_gap_start].x;
 
-  new_gap_end_iter = state->gap_end_iter;
-  new_gap_end_x = state->gap_end_x;
-  do
+  new_gap_end = state->gap_end;
+  while (new_gap_end < state->plan->n_clusters - 1)
     {
-      if (!line_iter_next_cluster (state, &new_gap_end_iter))
-	break;
-      width = get_cluster_width (&new_gap_end_iter);
-      new_gap_end_x += width;
+      new_gap_end++;
+      if (clusters[new_gap_end].ends_boundary &&
+          clusters[new_gap_end].width != 0)
+        break;
     }
-  while (!ends_at_ellipsization_boundary (state, &new_gap_end_iter) ||
-	 width == 0);
+  new_gap_end_x = clusters[new_gap_end].x + clusters[new_gap_end].width;
 
   if (state->gap_end_x == new_gap_end_x && state->gap_start_x == new_gap_start_x)
     return FALSE;
@@ -615,15 +710,13 @@ remove_one_span (EllipsizeState *state)
       (state->gap_start_x != new_gap_start_x &&
        state->gap_center - new_gap_start_x < new_gap_end_x - state->gap_center))
     {
-      state->gap_start_iter = new_gap_start_iter;
-      state->gap_start_x = new_gap_start_x;
+      set_gap_start (state, new_gap_start);
 
       update_ellipsis_shape (state);
     }
   else
     {
-      state->gap_end_iter = new_gap_end_iter;
-      state->gap_end_x = new_gap_end_x;
+      set_gap_end (state, new_gap_end);
     }
 
   return TRUE;
@@ -732,11 +825,147 @@ current_width (EllipsizeState *state)
   return state->total_width - (state->gap_end_x - state->gap_start_x) + state->ellipsis_width;
 }
 
+static void
+ellipsize_plan_free (EllipsizePlan *plan)
+{
+  g_free (plan->clusters);
+  g_array_unref (plan->steps);
+  g_ptr_array_unref (plan->ellipses);
+  g_free (plan);
+}
+
+/* Records the current gap as the next step of the plan
+ */
+static void
+add_step (EllipsizeState *state)
+{
+  GArray *steps = state->plan->steps;
+  EllipsizeStep step;
+
+  step.gap_start = state->gap_start;
+  step.gap_end = state->gap_end;
+  step.width = current_width (state);
+  step.min_width = step.width;
+  if (steps->len > 0)
+    step.min_width = MIN (step.min_width, g_array_index (steps, EllipsizeStep, steps->len - 1).min_width);
+  step.ellipsis = state->plan->ellipses->len - 1;
+
+  g_array_append_val (steps, step);
+}
+
+/* Grows the gap until the whole line is removed, recording every step
+ */
+static EllipsizePlan *
+create_plan (EllipsizeState  *state,
+             PangoLayoutLine *line)
+{
+  EllipsizePlan *plan;
+
+  plan = g_new0 (EllipsizePlan, 1);
+  plan->start_index = line->start_index;
+  plan->length = line->length;
+  plan->n_runs = state->n_runs;
+  plan->total_width = state->total_width;
+  plan->shape_flags = state->shape_flags;
+  plan->n_positions = state->n_positions;
+  plan->steps = g_array_new (FALSE, FALSE, sizeof (EllipsizeStep));
+  plan->ellipses = g_ptr_array_new_with_free_func ((GDestroyNotify) pango_glyph_item_free);
+
+  state->plan = plan;
+
+  init_clusters (state);
+
+  find_initial_span (state);
+  add_step (state);
+
+  while (remove_one_span (state))
+    add_step (state);
+
+  /* A copy of each shaped ellipsis is kept in the plan */
+  pango_glyph_item_free (state->ellipsis_run);
+  state->ellipsis_run = NULL;
+
+  return plan;
+}
+
+/* Finds the plan for @line in the layout, or creates it. Plans stay
+ * valid until the layout changes in other ways than its width.
+ * Unless @keep_plan is set, a newly created plan isn't stored in
+ * the layout; @owned is set then, and the caller has to free it.
+ */
+static EllipsizePlan *
+get_plan (EllipsizeState  *state,
+          PangoLayoutLine *line,
+          gboolean         keep_plan,
+          gboolean        *owned)
+{
+  PangoLayout *layout = state->layout;
+  EllipsizePlan *plan = NULL;
+
+  if (layout->ellipsize_plans)
+    plan = g_hash_table_lookup (layout->ellipsize_plans, GINT_TO_POINTER (line->start_index));
+
+  if (plan &&
+      plan->length == line->length &&
+      plan->n_runs == state->n_runs &&
+      plan->total_width == state->total_width &&
+      plan->shape_flags == state->shape_flags &&
+      plan->n_positions == state->n_positions)
+    {
+      state->plan = plan;
+      return plan;
+    }
+
+  plan = create_plan (state, line);
+
+  *owned = !keep_plan;
+  if (!keep_plan)
+    return plan;
+
+  if (!layout->ellipsize_plans)
+    layout->ellipsize_plans = g_hash_table_new_full (NULL, NULL, NULL,
+                                                     (GDestroyNotify) ellipsize_plan_free);
+
+  g_hash_table_replace (layout->ellipsize_plans, GINT_TO_POINTER (line->start_index), plan);
+
+  return plan;
+}
+
+/* Finds the first step at which the line fits in @goal_width,
+ * or the last step if there is none
+ */
+static EllipsizeStep *
+find_step (EllipsizePlan *plan,
+           int            goal_width)
+{
+  EllipsizeStep *steps = (EllipsizeStep *) plan->steps->data;
+  int lo, hi;
+
+  lo = 0;
+  hi = plan->steps->len - 1;
+  while (lo < hi)
+    {
+      int mid = (lo + hi) / 2;
+
+      if (steps[mid].min_width <= goal_width)
+        hi = mid;
+      else
+        lo = mid + 1;
+    }
+
+  return &steps[lo];
+}
+
 /**
  * _pango_layout_line_ellipsize:
  * @line: a `PangoLayoutLine`
  * @attrs: Attributes being used for itemization/shaping
  * @shape_flags: Flags to use when shaping
+ * @n_positions: the number of subpixel positions to quantize glyph
+ *   positions to when shaping, or 0
+ * @goal_width: the width to fit the line in
+ * @keep_plan: whether to keep what was found out about the line in the
+ *   layout, for ellipsizing it again at a different width
  *
  * Given a `PangoLayoutLine` with the runs still in logical order, ellipsize
  * it according the layout's policy to fit within the set width of the layout.
@@ -747,33 +976,39 @@ gboolean
 _pango_layout_line_ellipsize (PangoLayoutLine *line,
 			      PangoAttrList   *attrs,
                               PangoShapeFlags  shape_flags,
-			      int              goal_width)
+                              int              n_positions,
+			      int              goal_width,
+                              gboolean         keep_plan)
 {
   EllipsizeState state;
+  EllipsizePlan *plan;
+  gboolean owned = FALSE;
+  EllipsizeStep *step;
   gboolean is_ellipsized = FALSE;
 
   g_return_val_if_fail (line->layout->ellipsize != PANGO_ELLIPSIZE_NONE && goal_width >= 0, is_ellipsized);
 
-  init_state (&state, line, attrs, shape_flags);
+  init_state (&state, line, attrs, shape_flags, n_positions);
 
   if (state.total_width <= goal_width)
     goto out;
 
-  find_initial_span (&state);
+  plan = get_plan (&state, line, keep_plan, &owned);
+  step = find_step (plan, goal_width);
 
-  while (current_width (&state) > goal_width)
-    {
-      if (!remove_one_span (&state))
-	break;
-    }
+  line_iter_init_at (&state, &state.gap_start_iter, step->gap_start);
+  line_iter_init_at (&state, &state.gap_end_iter, step->gap_end);
+  state.ellipsis_run = pango_glyph_item_copy (g_ptr_array_index (plan->ellipses, step->ellipsis));
 
-  fixup_ellipsis_run (&state, MAX (goal_width - current_width (&state), 0));
+  fixup_ellipsis_run (&state, MAX (goal_width - step->width, 0));
 
   g_slist_free (line->runs);
   line->runs = get_run_list (&state);
   is_ellipsized = TRUE;
 
  out:
+  if (owned)
+    ellipsize_plan_free (plan);
   free_state (&state);
 
   return is_ellipsized;
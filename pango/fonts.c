@@ -48,8 +48,11 @@ struct _PangoFontDescription
   guint static_family : 1;
   guint static_variations : 1;
   guint size_is_absolute : 1;
+  guint interned : 1;
 
   int size;
+
+  guint hash; /* only valid if interned */
 };
 
 G_DEFINE_BOXED_TYPE (PangoFontDescription, pango_font_description,
@@ -70,8 +73,11 @@ static const PangoFontDescription pfd_defaults = {
   0,                    /* static_family */
   0,                    /* static_variations*/
   0,                    /* size_is_absolute */
+  0,                    /* interned */
 
   0,                    /* size */
+
+  0,                    /* hash */
 };
 
 /**
@@ -828,6 +834,7 @@ pango_font_description_copy (const PangoFontDescription *desc)
   result = g_slice_new (PangoFontDescription);
 
   *result = *desc;
+  result->interned = FALSE;
 
   if (result->family_name)
     {
@@ -868,6 +875,8 @@ pango_font_description_copy_static (const PangoFontDescription *desc)
   result = g_slice_new (PangoFontDescription);
 
   *result = *desc;
+  result->interned = FALSE;
+
   if (result->family_name)
     result->static_family = TRUE;
 
@@ -900,6 +909,9 @@ pango_font_description_equal (const PangoFontDescription *desc1,
   g_return_val_if_fail (desc1 != NULL, FALSE);
   g_return_val_if_fail (desc2 != NULL, FALSE);
 
+  if (desc1 == desc2)
+    return TRUE;
+
   return desc1->style == desc2->style &&
          desc1->variant == desc2->variant &&
          desc1->weight == desc2->weight &&
@@ -948,6 +960,9 @@ pango_font_description_hash (const PangoFontDescription *desc)
 
   g_return_val_if_fail (desc != NULL, 0);
 
+  if (desc->interned)
+    return desc->hash;
+
   if (desc->family_name)
     hash = case_insensitive_hash (desc->family_name);
   if (desc->variations)
@@ -963,6 +978,83 @@ pango_font_description_hash (const PangoFontDescription *desc)
   return hash;
 }
 
+G_LOCK_DEFINE_STATIC (interned_descs);
+static GHashTable *interned_descs;
+
+static guint
+interned_desc_hash (gconstpointer key)
+{
+  const PangoFontDescription *desc = key;
+
+  return pango_font_description_hash (desc) ^ desc->mask;
+}
+
+static gboolean
+interned_desc_equal (gconstpointer a,
+                     gconstpointer b)
+{
+  const PangoFontDescription *desc1 = a;
+  const PangoFontDescription *desc2 = b;
+
+  return desc1->mask == desc2->mask &&
+         pango_font_description_equal (desc1, desc2);
+}
+
+/**
+ * pango_font_description_intern:
+ * @desc: a `PangoFontDescription`
+ *
+ * Returns the canonical copy of a font description.
+ *
+ * Font descriptions that are equal according to
+ * [method@Pango.FontDescription.equal] and have the same fields
+ * set share one canonical copy, so they can be compared by pointer.
+ * The canonical copy also caches its hash value, which helps callers
+ * that keep font descriptions as keys of their own hash tables. Font
+ * maps and fontsets don't intern the descriptions they look up, so
+ * this doesn't make font loading itself faster.
+ *
+ * Canonical copies are never freed, so the table of them grows with
+ * every distinct description. Only intern descriptions from a bounded
+ * set, such as the fonts of an application's styles, and not ones
+ * parsed from arbitrary input.
+ *
+ * Returns: (transfer none): the canonical `PangoFontDescription`.
+ *   It is owned by Pango and lives as long as the process; it must
+ *   not be modified or freed. Use [method@Pango.FontDescription.copy]
+ *   to get a modifiable copy.
+ *
+ * Since: 1.56
+ */
+const PangoFontDescription *
+pango_font_description_intern (const PangoFontDescription *desc)
+{
+  PangoFontDescription *result;
+
+  g_return_val_if_fail (desc != NULL, NULL);
+
+  if (desc->interned)
+    return desc;
+
+  G_LOCK (interned_descs);
+
+  if (G_UNLIKELY (!interned_descs))
+    interned_descs = g_hash_table_new (interned_desc_hash, interned_desc_equal);
+
+  result = g_hash_table_lookup (interned_descs, desc);
+  if (!result)
+    {
+      result = pango_font_description_copy (desc);
+      result->hash = pango_font_description_hash (result);
+      result->interned = TRUE;
+      g_hash_table_add (interned_descs, result);
+    }
+
+  G_UNLOCK (interned_descs);
+
+  return result;
+}
+
 /**
  * pango_font_description_free:
  * @desc: (nullable): a `PangoFontDescription`, may be %NULL
@@ -975,6 +1067,8 @@ pango_font_description_free (PangoFontDescription *desc)
   if (desc == NULL)
     return;
 
+  g_return_if_fail (!desc->interned);
+
   if (desc->family_name && !desc->static_family)
     g_free (desc->family_name);
 
@@ -1162,11 +1256,103 @@ find_field (const char *what,
   return FALSE;
 }
 
+typedef enum
+{
+  FONT_KEYWORD_NORMAL,
+  FONT_KEYWORD_STYLE,
+  FONT_KEYWORD_VARIANT,
+  FONT_KEYWORD_WEIGHT,
+  FONT_KEYWORD_STRETCH,
+  FONT_KEYWORD_GRAVITY,
+} FontKeywordField;
+
+typedef struct
+{
+  const char str[16];
+  guint8 field;
+  int value;
+} FontKeyword;
+
+#include "pango-font-keywords.h"
+
+/* Finds the style word @str among the keywords of all the
+ * maps above, with one lookup in a perfect hash table.
+ */
+static const FontKeyword *
+find_keyword (const char *str,
+              int         len)
+{
+  char key[FONT_KEYWORD_MAX_LENGTH];
+  const FontKeyword *keyword;
+  int i, n;
+  guint8 slot;
+
+  /* Dashes are optional, see field_matches() */
+  for (i = 0, n = 0; i < len; i++)
+    {
+      if (str[i] == '-')
+        continue;
+      if (n == FONT_KEYWORD_MAX_LENGTH)
+        return NULL;
+      key[n++] = TOLOWER (str[i]);
+    }
+
+  slot = font_keyword_slots[font_keyword_hash (key, n)];
+  if (slot == 0)
+    return NULL;
+
+  keyword = &font_keywords[slot - 1];
+  if (!field_matches (keyword->str, str, len))
+    return NULL;
+
+  return keyword;
+}
+
 static gboolean
 find_field_any (const char *str, int len, PangoFontDescription *desc)
 {
-  if (field_matches ("Normal", str, len))
-    return TRUE;
+  const FontKeyword *keyword;
+
+  keyword = find_keyword (str, len);
+  if (keyword)
+    {
+      if (!desc)
+        return TRUE;
+
+      switch ((FontKeywordField) keyword->field)
+        {
+        case FONT_KEYWORD_NORMAL:
+          break;
+        case FONT_KEYWORD_STYLE:
+          desc->style = keyword->value;
+          desc->mask |= PANGO_FONT_MASK_STYLE;
+          break;
+        case FONT_KEYWORD_VARIANT:
+          desc->variant = keyword->value;
+          desc->mask |= PANGO_FONT_MASK_VARIANT;
+          break;
+        case FONT_KEYWORD_WEIGHT:
+          desc->weight = keyword->value;
+          desc->mask |= PANGO_FONT_MASK_WEIGHT;
+          break;
+        case FONT_KEYWORD_STRETCH:
+          desc->stretch = keyword->value;
+          desc->mask |= PANGO_FONT_MASK_STRETCH;
+          break;
+        case FONT_KEYWORD_GRAVITY:
+          desc->gravity = keyword->value;
+          desc->mask |= PANGO_FONT_MASK_GRAVITY;
+          break;
+        default:
+          g_assert_not_reached ();
+        }
+
+      return TRUE;
+    }
+
+  /* Only the field=value forms are left */
+  if (!memchr (str, '=', len))
+    return FALSE;
 
 #define FIELD(NAME, MASK) \
   G_STMT_START { \
@@ -1250,66 +1436,13 @@ parse_variations (const char  *word,
   return TRUE;
 }
 
-/**
- * pango_font_description_from_string:
- * @str: string representation of a font description.
- *
- * Creates a new font description from a string representation.
- *
- * The string must have the form
- *
- *     "[FAMILY-LIST] [STYLE-OPTIONS] [SIZE] [VARIATIONS]",
- *
- * where FAMILY-LIST is a comma-separated list of families optionally
- * terminated by a comma, STYLE_OPTIONS is a whitespace-separated list
- * of words where each word describes one of style, variant, weight,
- * stretch, or gravity, and SIZE is a decimal number (size in points)
- * or optionally followed by the unit modifier "px" for absolute size.
- * VARIATIONS is a comma-separated list of font variation
- * specifications of the form @‍axis=value (the = sign is optional).
- *
- * The following words are understood as styles:
- * "Normal", "Roman", "Oblique", "Italic".
- *
- * The following words are understood as variants:
- * "Small-Caps", "All-Small-Caps", "Petite-Caps", "All-Petite-Caps",
- * "Unicase", "Title-Caps".
- *
- * The following words are understood as weights:
- * "Thin", "Ultra-Light", "Extra-Light", "Light", "Semi-Light",
- * "Demi-Light", "Book", "Regular", "Medium", "Semi-Bold", "Demi-Bold",
- * "Bold", "Ultra-Bold", "Extra-Bold", "Heavy", "Black", "Ultra-Black",
- * "Extra-Black".
- *
- * The following words are understood as stretch values:
- * "Ultra-Condensed", "Extra-Condensed", "Condensed", "Semi-Condensed",
- * "Semi-Expanded", "Expanded", "Extra-Expanded", "Ultra-Expanded".
- *
- * The following words are understood as gravity values:
- * "Not-Rotated", "South", "Upside-Down", "North", "Rotated-Left",
- * "East", "Rotated-Right", "West".
- *
- * Any one of the options may be absent. If FAMILY-LIST is absent, then
- * the family_name field of the resulting font description will be
- * initialized to %NULL. If STYLE-OPTIONS is missing, then all style
- * options will be set to the default values. If SIZE is missing, the
- * size in the resulting font description will be set to 0.
- *
- * A typical example:
- *
- *     "Cantarell Italic Light 15 @‍wght=200"
- *
- * Returns: (transfer full): a new `PangoFontDescription`.
- */
-PangoFontDescription *
-pango_font_description_from_string (const char *str)
+static PangoFontDescription *
+parse_font_description (const char *str)
 {
   PangoFontDescription *desc;
   const char *p, *last;
   size_t len, wordlen;
 
-  g_return_val_if_fail (str != NULL, NULL);
-
   desc = pango_font_description_new ();
 
   desc->mask = PANGO_FONT_MASK_STYLE |
@@ -1397,6 +1530,104 @@ pango_font_description_from_string (const char *str)
   return desc;
 }
 
+/* Markup tends to parse the same few strings over and over,
+ * so we cache the results. The cache is simply emptied when
+ * it fills up.
+ */
+#define FROM_STRING_CACHE_SIZE 256
+
+G_LOCK_DEFINE_STATIC (from_string_cache);
+static GHashTable *from_string_cache;
+
+/**
+ * pango_font_description_from_string:
+ * @str: string representation of a font description.
+ *
+ * Creates a new font description from a string representation.
+ *
+ * The string must have the form
+ *
+ *     "[FAMILY-LIST] [STYLE-OPTIONS] [SIZE] [VARIATIONS]",
+ *
+ * where FAMILY-LIST is a comma-separated list of families optionally
+ * terminated by a comma, STYLE_OPTIONS is a whitespace-separated list
+ * of words where each word describes one of style, variant, weight,
+ * stretch, or gravity, and SIZE is a decimal number (size in points)
+ * or optionally followed by the unit modifier "px" for absolute size.
+ * VARIATIONS is a comma-separated list of font variation
+ * specifications of the form @‍axis=value (the = sign is optional).
+ *
+ * The following words are understood as styles:
+ * "Normal", "Roman", "Oblique", "Italic".
+ *
+ * The following words are understood as variants:
+ * "Small-Caps", "All-Small-Caps", "Petite-Caps", "All-Petite-Caps",
+ * "Unicase", "Title-Caps".
+ *
+ * The following words are understood as weights:
+ * "Thin", "Ultra-Light", "Extra-Light", "Light", "Semi-Light",
+ * "Demi-Light", "Book", "Regular", "Medium", "Semi-Bold", "Demi-Bold",
+ * "Bold", "Ultra-Bold", "Extra-Bold", "Heavy", "Black", "Ultra-Black",
+ * "Extra-Black".
+ *
+ * The following words are understood as stretch values:
+ * "Ultra-Condensed", "Extra-Condensed", "Condensed", "Semi-Condensed",
+ * "Semi-Expanded", "Expanded", "Extra-Expanded", "Ultra-Expanded".
+ *
+ * The following words are understood as gravity values:
+ * "Not-Rotated", "South", "Upside-Down", "North", "Rotated-Left",
+ * "East", "Rotated-Right", "West".
+ *
+ * Any one of the options may be absent. If FAMILY-LIST is absent, then
+ * the family_name field of the resulting font description will be
+ * initialized to %NULL. If STYLE-OPTIONS is missing, then all style
+ * options will be set to the default values. If SIZE is missing, the
+ * size in the resulting font description will be set to 0.
+ *
+ * A typical example:
+ *
+ *     "Cantarell Italic Light 15 @‍wght=200"
+ *
+ * Returns: (transfer full): a new `PangoFontDescription`.
+ */
+PangoFontDescription *
+pango_font_description_from_string (const char *str)
+{
+  PangoFontDescription *desc;
+
+  g_return_val_if_fail (str != NULL, NULL);
+
+  G_LOCK (from_string_cache);
+
+  if (G_UNLIKELY (!from_string_cache))
+    from_string_cache = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                               g_free,
+                                               (GDestroyNotify) pango_font_description_free);
+
+  desc = g_hash_table_lookup (from_string_cache, str);
+  if (desc)
+    {
+      desc = pango_font_description_copy (desc);
+      G_UNLOCK (from_string_cache);
+      return desc;
+    }
+
+  G_UNLOCK (from_string_cache);
+
+  desc = parse_font_description (str);
+
+  G_LOCK (from_string_cache);
+
+  if (g_hash_table_size (from_string_cache) >= FROM_STRING_CACHE_SIZE)
+    g_hash_table_remove_all (from_string_cache);
+  g_hash_table_replace (from_string_cache, g_strdup (str),
+                        pango_font_description_copy (desc));
+
+  G_UNLOCK (from_string_cache);
+
+  return desc;
+}
+
 static void
 append_field (GString *str, const char *what, const FieldMap *map, int n_elements, int val)
 {
@@ -1825,6 +2056,29 @@ pango_font_default_get_absolute_size (PangoFont *font)
   return size;
 }
 
+static void
+pango_font_default_get_glyphs_extents (PangoFont            *font,
+                                       const PangoGlyphInfo *glyphs,
+                                       int                   n_glyphs,
+                                       PangoRectangle       *ink_rects,
+                                       PangoRectangle       *logical_rect)
+{
+  if (logical_rect && n_glyphs == 0)
+    logical_rect->y = logical_rect->height = 0;
+
+  for (int i = 0; i < n_glyphs; i++)
+    {
+      PangoRectangle glyph_logical;
+
+      pango_font_get_glyph_extents (font, glyphs[i].glyph,
+                                    ink_rects ? &ink_rects[i] : NULL,
+                                    logical_rect ? &glyph_logical : NULL);
+
+      if (logical_rect)
+        pango_font_add_logical_extents (logical_rect, &glyph_logical, i == 0);
+    }
+}
+
 static void
 pango_font_class_init (PangoFontClass *class G_GNUC_UNUSED)
 {
@@ -1842,6 +2096,7 @@ pango_font_class_init (PangoFontClass *class G_GNUC_UNUSED)
   pclass->get_face = pango_font_default_get_face;
   pclass->get_matrix = pango_font_default_get_matrix;
   pclass->get_absolute_size = pango_font_default_get_absolute_size;
+  pclass->get_glyphs_extents = pango_font_default_get_glyphs_extents;
 }
 
 static void
@@ -2925,6 +3180,38 @@ pango_font_get_languages (PangoFont *font)
   return pclass->get_languages (font);
 }
 
+/*< private >
+ * pango_font_get_glyphs_extents:
+ * @font: (nullable): a `PangoFont`
+ * @glyphs: the glyphs to get the extents of
+ * @n_glyphs: the number of glyphs
+ * @ink_rects: (out caller-allocates) (optional): array of @n_glyphs
+ *   rectangles to store the ink extents of each glyph in
+ * @logical_rect: (out caller-allocates) (optional): rectangle to store
+ *   the vertical logical extents of all the glyphs together in
+ *
+ * Gets the extents of many glyphs at once, like calling
+ * [method@Pango.Font.get_glyph_extents] for each of them.
+ *
+ * Only the y and height of @logical_rect are set; the logical
+ * widths are the advances found in the glyph geometry anyway.
+ */
+void
+pango_font_get_glyphs_extents (PangoFont            *font,
+                               const PangoGlyphInfo *glyphs,
+                               int                   n_glyphs,
+                               PangoRectangle       *ink_rects,
+                               PangoRectangle       *logical_rect)
+{
+  if (G_UNLIKELY (!font))
+    {
+      pango_font_default_get_glyphs_extents (NULL, glyphs, n_glyphs, ink_rects, logical_rect);
+      return;
+    }
+
+  PANGO_FONT_GET_CLASS_PRIVATE (font)->get_glyphs_extents (font, glyphs, n_glyphs, ink_rects, logical_rect);
+}
+
 /*< private >
  * pango_font_get_matrix:
  * @font: a `PangoFont`
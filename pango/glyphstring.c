@@ -23,6 +23,7 @@
 #include <glib.h>
 #include "pango-glyph.h"
 #include "pango-font.h"
+#include "pango-font-private.h"
 #include "pango-impl-utils.h"
 
 #include <hb-ot.h>
@@ -142,6 +143,9 @@ pango_glyph_string_free (PangoGlyphString *string)
   g_slice_free (PangoGlyphString, string);
 }
 
+/* How many glyphs we get the extents of at once */
+#define EXTENTS_CHUNK_SIZE 64
+
 /**
  * pango_glyph_string_extents_range:
  * @glyphs: a `PangoGlyphString`
@@ -169,7 +173,7 @@ pango_glyph_string_extents_range (PangoGlyphString *glyphs,
 				  PangoRectangle   *logical_rect)
 {
   int x_pos = 0;
-  int i;
+  int i, n;
 
   /* Note that the handling of empty rectangles for ink
    * and logical rectangles is different. A zero-height ink
@@ -200,62 +204,72 @@ pango_glyph_string_extents_range (PangoGlyphString *glyphs,
       logical_rect->height = 0;
     }
 
-  for (i = start; i < end; i++)
+  /* For the logical rect, the widths come from the glyph
+   * geometry, so we only need the vertical extents from the font
+   */
+  if (!ink_rect)
     {
-      PangoRectangle glyph_ink;
-      PangoRectangle glyph_logical;
+      for (i = start; i < end; i++)
+	logical_rect->width += glyphs->glyphs[i].geometry.width;
 
-      PangoGlyphGeometry *geometry = &glyphs->glyphs[i].geometry;
+      if (start < end)
+	pango_font_get_glyphs_extents (font, glyphs->glyphs + start, end - start,
+				       NULL, logical_rect);
 
-      pango_font_get_glyph_extents (font, glyphs->glyphs[i].glyph,
-				    ink_rect ? &glyph_ink : NULL,
-				    logical_rect ? &glyph_logical : NULL);
+      return;
+    }
 
-      if (ink_rect && glyph_ink.width != 0 && glyph_ink.height != 0)
-	{
-	  if (ink_rect->width == 0 || ink_rect->height == 0)
-	    {
-	      ink_rect->x = x_pos + glyph_ink.x + geometry->x_offset;
-	      ink_rect->width = glyph_ink.width;
-	      ink_rect->y = glyph_ink.y + geometry->y_offset;
-	      ink_rect->height = glyph_ink.height;
-	    }
-	  else
-	    {
-	      int new_x, new_y;
+  for (i = start; i < end; i += n)
+    {
+      PangoRectangle glyph_inks[EXTENTS_CHUNK_SIZE];
+      PangoRectangle chunk_logical;
+      int j;
 
-	      new_x = MIN (ink_rect->x, x_pos + glyph_ink.x + geometry->x_offset);
-	      ink_rect->width = MAX (ink_rect->x + ink_rect->width,
-				     x_pos + glyph_ink.x + glyph_ink.width + geometry->x_offset) - new_x;
-	      ink_rect->x = new_x;
+      n = MIN (end - i, EXTENTS_CHUNK_SIZE);
 
-	      new_y = MIN (ink_rect->y, glyph_ink.y + geometry->y_offset);
-	      ink_rect->height = MAX (ink_rect->y + ink_rect->height,
-				      glyph_ink.y + glyph_ink.height + geometry->y_offset) - new_y;
-	      ink_rect->y = new_y;
-	    }
-	}
+      pango_font_get_glyphs_extents (font, glyphs->glyphs + i, n,
+				     glyph_inks,
+				     logical_rect ? &chunk_logical : NULL);
 
-      if (logical_rect)
+      for (j = 0; j < n; j++)
 	{
-	  logical_rect->width += geometry->width;
+	  PangoRectangle *glyph_ink = &glyph_inks[j];
+	  PangoGlyphGeometry *geometry = &glyphs->glyphs[i + j].geometry;
 
-	  if (i == start)
+	  if (glyph_ink->width != 0 && glyph_ink->height != 0)
 	    {
-	      logical_rect->y = glyph_logical.y;
-	      logical_rect->height = glyph_logical.height;
-	    }
-	  else
-	    {
-	      int new_y = MIN (logical_rect->y, glyph_logical.y);
-	      logical_rect->height = MAX (logical_rect->y + logical_rect->height,
-					  glyph_logical.y + glyph_logical.height) - new_y;
-	      logical_rect->y = new_y;
+	      if (ink_rect->width == 0 || ink_rect->height == 0)
+		{
+		  ink_rect->x = x_pos + glyph_ink->x + geometry->x_offset;
+		  ink_rect->width = glyph_ink->width;
+		  ink_rect->y = glyph_ink->y + geometry->y_offset;
+		  ink_rect->height = glyph_ink->height;
+		}
+	      else
+		{
+		  int new_x, new_y;
+
+		  new_x = MIN (ink_rect->x, x_pos + glyph_ink->x + geometry->x_offset);
+		  ink_rect->width = MAX (ink_rect->x + ink_rect->width,
+					 x_pos + glyph_ink->x + glyph_ink->width + geometry->x_offset) - new_x;
+		  ink_rect->x = new_x;
+
+		  new_y = MIN (ink_rect->y, glyph_ink->y + geometry->y_offset);
+		  ink_rect->height = MAX (ink_rect->y + ink_rect->height,
+					  glyph_ink->y + glyph_ink->height + geometry->y_offset) - new_y;
+		  ink_rect->y = new_y;
+		}
 	    }
+
+	  x_pos += geometry->width;
 	}
 
-      x_pos += geometry->width;
+      if (logical_rect)
+	pango_font_add_logical_extents (logical_rect, &chunk_logical, i == start);
     }
+
+  if (logical_rect)
+    logical_rect->width = x_pos;
 }
 
 /**
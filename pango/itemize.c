@@ -31,6 +31,7 @@
 #include "pango-fontmap-private.h"
 #include "pango-script-private.h"
 #include "pango-emoji-private.h"
+#include "pango-vertical-orientation-table.h"
 #include "pango-attributes-private.h"
 #include "pango-item-private.h"
 #include "pango-utils-private.h"
@@ -139,63 +140,41 @@ struct _PangoWidthIter
         const gchar *start;
         const gchar *end;
         gboolean     upright;
+
+        const PangoCharProps *props;
+        const gchar *pos;
+        int          offset;
 };
 
-static gboolean
+static inline gboolean
 width_iter_is_upright (gunichar ch)
 {
   /* https://www.unicode.org/Public/11.0.0/ucd/VerticalOrientation.txt
-   * VO=U or Tu table generated by tools/gen-vertical-orientation-U-table.py.
+   * VO=U or Tu trie generated by tools/gen-vertical-orientation-U-table.py.
    *
    * FIXME: In the future, If GLib supports VerticalOrientation, please use it.
    */
-  static const gunichar upright[][2] = {
-    {0x00A7, 0x00A7}, {0x00A9, 0x00A9}, {0x00AE, 0x00AE}, {0x00B1, 0x00B1},
-    {0x00BC, 0x00BE}, {0x00D7, 0x00D7}, {0x00F7, 0x00F7}, {0x02EA, 0x02EB},
-    {0x1100, 0x11FF}, {0x1401, 0x167F}, {0x18B0, 0x18FF}, {0x2016, 0x2016},
-    {0x2020, 0x2021}, {0x2030, 0x2031}, {0x203B, 0x203C}, {0x2042, 0x2042},
-    {0x2047, 0x2049}, {0x2051, 0x2051}, {0x2065, 0x2065}, {0x20DD, 0x20E0},
-    {0x20E2, 0x20E4}, {0x2100, 0x2101}, {0x2103, 0x2109}, {0x210F, 0x210F},
-    {0x2113, 0x2114}, {0x2116, 0x2117}, {0x211E, 0x2123}, {0x2125, 0x2125},
-    {0x2127, 0x2127}, {0x2129, 0x2129}, {0x212E, 0x212E}, {0x2135, 0x213F},
-    {0x2145, 0x214A}, {0x214C, 0x214D}, {0x214F, 0x2189}, {0x218C, 0x218F},
-    {0x221E, 0x221E}, {0x2234, 0x2235}, {0x2300, 0x2307}, {0x230C, 0x231F},
-    {0x2324, 0x2328}, {0x232B, 0x232B}, {0x237D, 0x239A}, {0x23BE, 0x23CD},
-    {0x23CF, 0x23CF}, {0x23D1, 0x23DB}, {0x23E2, 0x2422}, {0x2424, 0x24FF},
-    {0x25A0, 0x2619}, {0x2620, 0x2767}, {0x2776, 0x2793}, {0x2B12, 0x2B2F},
-    {0x2B50, 0x2B59}, {0x2BB8, 0x2BD1}, {0x2BD3, 0x2BEB}, {0x2BF0, 0x2BFF},
-    {0x2E80, 0x3007}, {0x3012, 0x3013}, {0x3020, 0x302F}, {0x3031, 0x309F},
-    {0x30A1, 0x30FB}, {0x30FD, 0xA4CF}, {0xA960, 0xA97F}, {0xAC00, 0xD7FF},
-    {0xE000, 0xFAFF}, {0xFE10, 0xFE1F}, {0xFE30, 0xFE48}, {0xFE50, 0xFE57},
-    {0xFE5F, 0xFE62}, {0xFE67, 0xFE6F}, {0xFF01, 0xFF07}, {0xFF0A, 0xFF0C},
-    {0xFF0E, 0xFF19}, {0xFF1F, 0xFF3A}, {0xFF3C, 0xFF3C}, {0xFF3E, 0xFF3E},
-    {0xFF40, 0xFF5A}, {0xFFE0, 0xFFE2}, {0xFFE4, 0xFFE7}, {0xFFF0, 0xFFF8},
-    {0xFFFC, 0xFFFD}, {0x10980, 0x1099F}, {0x11580, 0x115FF}, {0x11A00, 0x11AAF},
-    {0x13000, 0x1342F}, {0x14400, 0x1467F}, {0x16FE0, 0x18AFF}, {0x1B000, 0x1B12F},
-    {0x1B170, 0x1B2FF}, {0x1D000, 0x1D1FF}, {0x1D2E0, 0x1D37F}, {0x1D800, 0x1DAAF},
-    {0x1F000, 0x1F7FF}, {0x1F900, 0x1FA6F}, {0x20000, 0x2FFFD}, {0x30000, 0x3FFFD},
-    {0xF0000, 0xFFFFD}, {0x100000, 0x10FFFD}
-  };
-  static const int max = sizeof(upright) / sizeof(upright[0]);
-  int st = 0;
-  int ed = max;
-
-  if (ch < upright[0][0])
-    return FALSE;
+  return _pango_upright_lookup (ch) != 0;
+}
 
-  while (st <= ed)
+static inline guint8
+width_iter_get_flags (PangoWidthIter *iter)
+{
+  /* The emoji iterator may have moved end forward, catch up */
+  if (G_UNLIKELY (iter->pos != iter->end))
     {
-      int mid = (st + ed) / 2;
-      if (upright[mid][0] <= ch && ch <= upright[mid][1])
-        return TRUE;
-      else
-        if (upright[mid][0] <= ch)
-          st = mid + 1;
-        else
-          ed = mid - 1;
+      iter->offset += g_utf8_pointer_to_offset (iter->pos, iter->end);
+      iter->pos = iter->end;
     }
 
-  return FALSE;
+  return iter->props[iter->offset].flags;
+}
+
+static inline void
+width_iter_advance (PangoWidthIter *iter)
+{
+  iter->end = iter->pos = g_utf8_next_char (iter->end);
+  iter->offset++;
 }
 
 static void
@@ -205,19 +184,16 @@ width_iter_next (PangoWidthIter *iter)
   iter->start = iter->end;
 
   if (iter->end < iter->text_end)
-    {
-      gunichar ch = g_utf8_get_char (iter->end);
-      iter->upright = width_iter_is_upright (ch);
-    }
+    iter->upright = (width_iter_get_flags (iter) & PANGO_CHAR_PROP_UPRIGHT) != 0;
 
   while (iter->end < iter->text_end)
     {
-      gunichar ch = g_utf8_get_char (iter->end);
+      guint8 flags = width_iter_get_flags (iter);
 
       /* for zero width joiner */
-      if (ch == 0x200D)
+      if (flags & PANGO_CHAR_PROP_ZWJ)
         {
-          iter->end = g_utf8_next_char (iter->end);
+          width_iter_advance (iter);
           met_joiner = TRUE;
           continue;
         }
@@ -225,37 +201,48 @@ width_iter_next (PangoWidthIter *iter)
       /* ignore the upright check if met joiner */
       if (met_joiner)
         {
-          iter->end = g_utf8_next_char (iter->end);
+          width_iter_advance (iter);
           met_joiner = FALSE;
           continue;
         }
 
       /* for variation selector, tag and emoji modifier. */
-      if (G_UNLIKELY (ch == 0xFE0EU || ch == 0xFE0FU ||
-                      (ch >= 0xE0020 && ch <= 0xE007F) ||
-                      (ch >= 0x1F3FB && ch <= 0x1F3FF)))
+      if (G_UNLIKELY (flags & PANGO_CHAR_PROP_WIDTH_EXTENDER))
         {
-          iter->end = g_utf8_next_char (iter->end);
+          width_iter_advance (iter);
           continue;
         }
 
-      if (width_iter_is_upright (ch) != iter->upright)
+      if (((flags & PANGO_CHAR_PROP_UPRIGHT) != 0) != iter->upright)
         break;
 
-      iter->end = g_utf8_next_char (iter->end);
+      width_iter_advance (iter);
     }
 }
 
+/* Width runs only matter for vertical text; for horizontal
+ * text the whole range is a single run.
+ */
 static void
-width_iter_init (PangoWidthIter *iter,
-                 const char     *text,
-                 int             length)
+width_iter_init (PangoWidthIter       *iter,
+                 const char           *text,
+                 int                   length,
+                 const PangoCharProps *props,
+                 gboolean              vertical)
 {
   iter->text_start = text;
   iter->text_end = text + length;
-  iter->start = iter->end = text;
+  iter->start = iter->end = iter->pos = text;
+  iter->props = props;
+  iter->offset = 0;
 
-  width_iter_next (iter);
+  if (vertical)
+    width_iter_next (iter);
+  else
+    {
+      iter->end = iter->text_end;
+      iter->upright = width_iter_is_upright (g_utf8_get_char (text));
+    }
 }
 
 static void
@@ -263,6 +250,60 @@ width_iter_fini (PangoWidthIter *iter)
 {
 }
 
+/* }}} */
+/* {{{ Character properties */
+
+static gboolean consider_as_space_type (gunichar     wc,
+                                        GUnicodeType type);
+
+/* Decode each character once, recording what the script, emoji
+ * and width iterators and itemize_state_process_run() need to
+ * know about it. @props and @emoji_types must have room for
+ * @length entries. Returns the number of characters.
+ */
+static unsigned int
+decode_char_props (const char     *text,
+                   int             length,
+                   gboolean        vertical,
+                   PangoCharProps *props,
+                   unsigned char  *emoji_types)
+{
+  const char *p;
+  const char *end = text + length;
+  unsigned int i;
+
+  for (p = text, i = 0; p < end; p = g_utf8_next_char (p), i++)
+    {
+      gunichar ch = g_utf8_get_char (p);
+      GUnicodeType type = g_unichar_type (ch);
+      GUnicodeScript script = g_unichar_get_script (ch);
+      guint8 flags = 0;
+
+      if (_pango_script_is_cluster_extender (ch, type))
+        flags |= PANGO_CHAR_PROP_CLUSTER_EXTENDER;
+      if (consider_as_space_type (ch, type))
+        flags |= PANGO_CHAR_PROP_SPACE;
+
+      if (vertical)
+        {
+          if (width_iter_is_upright (ch))
+            flags |= PANGO_CHAR_PROP_UPRIGHT;
+          if (ch == 0x200D)
+            flags |= PANGO_CHAR_PROP_ZWJ;
+          else if (G_UNLIKELY (ch == 0xFE0EU || ch == 0xFE0FU ||
+                               (ch >= 0xE0020 && ch <= 0xE007F) ||
+                               (ch >= 0x1F3FB && ch <= 0x1F3FF)))
+            flags |= PANGO_CHAR_PROP_WIDTH_EXTENDER;
+        }
+
+      props[i].script = G_LIKELY (script <= G_MAXUINT8) ? script : G_UNICODE_SCRIPT_UNKNOWN;
+      props[i].flags = flags;
+      emoji_types[i] = _pango_emoji_segmentation_category (ch);
+    }
+
+  return i;
+}
+
 /* }}} */
 /* {{{ Itemization */
 
@@ -288,6 +329,10 @@ struct _ItemizeState
 
   const char *run_start;
   const char *run_end;
+  int run_offset;
+
+  PangoCharProps *props;
+  PangoCharProps props_[64];
 
   GList *result;
   PangoItem *item;
@@ -436,8 +481,8 @@ itemize_state_init (ItemizeState               *state,
                     const PangoFontDescription *desc)
 {
   unsigned int n_chars;
-
-  n_chars = g_utf8_strlen (text + start_index, length);
+  gboolean vertical;
+  unsigned char *emoji_types;
 
   state->context = context;
   state->text = text;
@@ -447,24 +492,49 @@ itemize_state_init (ItemizeState               *state,
   state->item = NULL;
 
   state->run_start = text + start_index;
+  state->run_offset = 0;
   state->changed = EMBEDDING_CHANGED | SCRIPT_CHANGED | LANG_CHANGED |
                    FONT_CHANGED | WIDTH_CHANGED | EMOJI_CHANGED;
 
-  /* First, apply the bidirectional algorithm to break
+  /* Decode the text once for the script, emoji and width
+   * iterators. A character takes at least one byte, so
+   * @length entries are always enough.
+   */
+  vertical = PANGO_GRAVITY_IS_VERTICAL (state->context->resolved_gravity);
+  if (length < 64)
+    state->props = state->props_;
+  else
+    state->props = g_new (PangoCharProps, length);
+  emoji_types = _pango_emoji_iter_alloc_types (&state->emoji_iter, length);
+  n_chars = decode_char_props (text + start_index, length, vertical,
+                               state->props, emoji_types);
+
+  /* Now, apply the bidirectional algorithm to break
    * the text into directional runs.
    */
-  if (n_chars < 64)
-    state->embedding_levels = state->embedding_levels_;
+  if (pango_log2vis_text_is_ltr (text + start_index, length, base_dir))
+    {
+      /* A single LTR run, no need to store levels */
+      state->embedding_levels = state->embedding_levels_;
+      state->embedding_end_offset = n_chars;
+      state->embedding_end = state->end;
+      state->embedding = 0;
+    }
   else
-    state->embedding_levels = g_new (guint8, n_chars);
-  pango_log2vis_fill_embedding_levels (text + start_index, length, n_chars, state->embedding_levels, &base_dir);
+    {
+      if (n_chars < 64)
+        state->embedding_levels = state->embedding_levels_;
+      else
+        state->embedding_levels = g_new (guint8, n_chars);
+      pango_log2vis_fill_embedding_levels (text + start_index, length, n_chars, state->embedding_levels, &base_dir);
 
-  state->embedding_end_offset = 0;
-  state->embedding_end = text + start_index;
-  update_embedding_end (state);
+      state->embedding_end_offset = 0;
+      state->embedding_end = text + start_index;
+      update_embedding_end (state);
+    }
 
   state->gravity = PANGO_GRAVITY_AUTO;
-  state->centered_baseline = PANGO_GRAVITY_IS_VERTICAL (state->context->resolved_gravity);
+  state->centered_baseline = vertical;
   state->gravity_hint = state->context->gravity_hint;
   state->resolved_gravity = PANGO_GRAVITY_AUTO;
 
@@ -508,16 +578,14 @@ itemize_state_init (ItemizeState               *state,
 
   /* Initialize the script iterator
    */
-  _pango_script_iter_init (&state->script_iter, text + start_index, length);
+  _pango_script_iter_init_with_props (&state->script_iter, text + start_index, length, state->props);
   pango_script_iter_get_range (&state->script_iter, NULL,
                                &state->script_end, &state->script);
 
-  width_iter_init (&state->width_iter, text + start_index, length);
-  _pango_emoji_iter_init (&state->emoji_iter, text + start_index, length, n_chars);
+  width_iter_init (&state->width_iter, text + start_index, length, state->props, vertical);
+  _pango_emoji_iter_start (&state->emoji_iter, text + start_index, length, n_chars);
 
-  if (!PANGO_GRAVITY_IS_VERTICAL (state->context->resolved_gravity))
-    state->width_iter.end = state->end;
-  else if (state->emoji_iter.is_emoji)
+  if (vertical && state->emoji_iter.is_emoji)
     state->width_iter.end = MAX (state->width_iter.end, state->emoji_iter.end);
 
   update_end (state);
@@ -935,9 +1003,9 @@ itemize_state_update_for_new_run (ItemizeState *state)
  * in itemize_state_add_character().
  */
 static gboolean
-consider_as_space (gunichar wc)
+consider_as_space_type (gunichar     wc,
+                        GUnicodeType type)
 {
-  GUnicodeType type = g_unichar_type (wc);
   return type == G_UNICODE_CONTROL ||
          (type == G_UNICODE_FORMAT && !((wc >= 0x600 && wc <= 0x06ff) || wc == 0x70f || wc == 0x8e2)) ||
          type == G_UNICODE_SURROGATE ||
@@ -948,6 +1016,12 @@ consider_as_space (gunichar wc)
          (wc >= 0xe0100u && wc <= 0xe01efu);
 }
 
+static gboolean
+consider_as_space (gunichar wc)
+{
+  return consider_as_space_type (wc, g_unichar_type (wc));
+}
+
 static void
 itemize_state_process_run (ItemizeState *state)
 {
@@ -966,14 +1040,14 @@ itemize_state_process_run (ItemizeState *state)
 
   for (p = state->run_start;
        p < state->run_end;
-       p = g_utf8_next_char (p))
+       p = g_utf8_next_char (p), state->run_offset++)
     {
       gunichar wc = g_utf8_get_char (p);
       gboolean is_forced_break = (wc == '\t' || wc == LINE_SEPARATOR);
       PangoFont *font;
       int font_position;
 
-      if (consider_as_space (wc))
+      if (state->props[state->run_offset].flags & PANGO_CHAR_PROP_SPACE)
         {
           font = NULL;
           font_position = 0xffff;
@@ -1029,6 +1103,8 @@ itemize_state_finish (ItemizeState *state)
 {
   if (state->embedding_levels != state->embedding_levels_)
     g_free (state->embedding_levels);
+  if (state->props != state->props_)
+    g_free (state->props);
   if (state->free_attr_iter)
     pango_attr_iterator_destroy (state->attr_iter);
   _pango_script_iter_fini (&state->script_iter);
@@ -36,11 +36,17 @@ struct _PangoAttrList
 {
   guint ref_count;
   GPtrArray *attributes;
+  /* @attributes is immutable and may be shared with other
+   * lists; it gets copied before the first modification.
+   */
+  guint shared : 1;
 };
 
 void     _pango_attr_list_init         (PangoAttrList     *list);
 void     _pango_attr_list_destroy      (PangoAttrList     *list);
 gboolean _pango_attr_list_has_attributes (const PangoAttrList *list);
+void     _pango_attr_list_coalesce     (PangoAttrList     *list);
+void     _pango_attr_list_share        (PangoAttrList     *list);
 
 void     _pango_attr_list_get_iterator (PangoAttrList     *list,
                                         PangoAttrIterator *iterator);
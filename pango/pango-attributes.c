@@ -1833,6 +1833,7 @@ _pango_attr_list_init (PangoAttrList *list)
 {
   list->ref_count = 1;
   list->attributes = NULL;
+  list->shared = FALSE;
 }
 
 /**
@@ -1885,6 +1886,12 @@ _pango_attr_list_destroy (PangoAttrList *list)
   if (!list->attributes)
     return;
 
+  if (list->shared)
+    {
+      g_ptr_array_unref (list->attributes);
+      return;
+    }
+
   for (i = 0, p = list->attributes->len; i < p; i++)
     {
       PangoAttribute *attr = g_ptr_array_index (list->attributes, i);
@@ -1943,11 +1950,55 @@ pango_attr_list_copy (PangoAttrList *list)
   if (!list->attributes || list->attributes->len == 0)
     return new;
 
+  if (list->shared)
+    {
+      new->attributes = g_ptr_array_ref (list->attributes);
+      new->shared = TRUE;
+      return new;
+    }
+
   new->attributes = g_ptr_array_copy (list->attributes, (GCopyFunc)pango_attribute_copy, NULL);
 
   return new;
 }
 
+/*< private >
+ * _pango_attr_list_share:
+ * @list: a `PangoAttrList`
+ *
+ * Makes the attributes of @list immutable, so that copies
+ * of @list can share them instead of copying each attribute.
+ *
+ * Any list that shares the attributes, including @list itself,
+ * makes a private copy of them the first time it is modified.
+ */
+void
+_pango_attr_list_share (PangoAttrList *list)
+{
+  if (list->shared || !list->attributes)
+    return;
+
+  /* The last list to drop the array frees the attributes */
+  g_ptr_array_set_free_func (list->attributes, (GDestroyNotify)pango_attribute_destroy);
+  list->shared = TRUE;
+}
+
+static void
+pango_attr_list_unshare (PangoAttrList *list)
+{
+  GPtrArray *attributes;
+
+  if (G_LIKELY (!list->shared))
+    return;
+
+  attributes = list->attributes;
+  list->attributes = g_ptr_array_copy (attributes, (GCopyFunc)pango_attribute_copy, NULL);
+  g_ptr_array_set_free_func (list->attributes, NULL);
+  list->shared = FALSE;
+
+  g_ptr_array_unref (attributes);
+}
+
 static void
 pango_attr_list_insert_internal (PangoAttrList  *list,
                                  PangoAttribute *attr,
@@ -1956,6 +2007,8 @@ pango_attr_list_insert_internal (PangoAttrList  *list,
   const guint start_index = attr->start_index;
   PangoAttribute *last_attr;
 
+  pango_attr_list_unshare (list);
+
   if (G_UNLIKELY (!list->attributes))
     list->attributes = g_ptr_array_new ();
 
@@ -2067,6 +2120,8 @@ pango_attr_list_change (PangoAttrList  *list,
       return;
     }
 
+  pango_attr_list_unshare (list);
+
   if (!list->attributes || list->attributes->len == 0)
     {
       pango_attr_list_insert (list, attr);
@@ -2231,6 +2286,8 @@ pango_attr_list_update (PangoAttrList *list,
   g_return_if_fail (remove >= 0);
   g_return_if_fail (add >= 0);
 
+  pango_attr_list_unshare (list);
+
   if (list->attributes)
     for (i = 0, p = list->attributes->len; i < p; i++)
       {
@@ -2321,6 +2378,8 @@ pango_attr_list_splice (PangoAttrList *list,
   g_return_if_fail (pos >= 0);
   g_return_if_fail (len >= 0);
 
+  pango_attr_list_unshare (list);
+
   upos = (guint)pos;
   ulen = (guint)len;
 
@@ -2443,7 +2502,8 @@ pango_attr_list_equal (PangoAttrList *list,
   if (list == NULL || other_list == NULL)
     return FALSE;
 
-  if (list->attributes == NULL || other_list->attributes == NULL)
+  if (list->attributes == NULL || other_list->attributes == NULL ||
+      list->attributes == other_list->attributes)
     return list->attributes == other_list->attributes;
 
   attrs = list->attributes;
@@ -2521,6 +2581,8 @@ pango_attr_list_filter (PangoAttrList       *list,
   if (!list->attributes || list->attributes->len == 0)
     return NULL;
 
+  pango_attr_list_unshare (list);
+
   for (i = 0, p = list->attributes->len; i < p; i++)
     {
       PangoAttribute *tmp_attr = g_ptr_array_index (list->attributes, i);
@@ -2544,6 +2606,60 @@ pango_attr_list_filter (PangoAttrList       *list,
   return new;
 }
 
+/*< private >
+ * _pango_attr_list_coalesce:
+ * @list: a `PangoAttrList`
+ *
+ * Merges attributes into the previous attribute of the same
+ * type if they are equal and adjoin or overlap it.
+ *
+ * This does not change the attributes that apply at any
+ * position, but reduces the number of boundaries that an
+ * iterator over @list stops at.
+ */
+void
+_pango_attr_list_coalesce (PangoAttrList *list)
+{
+  GHashTable *last_of_type;
+  guint i, n;
+
+  if (!list->attributes || list->attributes->len < 2)
+    return;
+
+  pango_attr_list_unshare (list);
+
+  last_of_type = g_hash_table_new (NULL, NULL);
+
+  for (i = 0, n = 0; i < list->attributes->len; i++)
+    {
+      PangoAttribute *attr = g_ptr_array_index (list->attributes, i);
+      PangoAttribute *prev;
+
+      prev = g_hash_table_lookup (last_of_type, GINT_TO_POINTER (attr->klass->type));
+
+      /* Only merging into the most recent attribute of the same type
+       * is safe, since later attributes take precedence over earlier
+       * ones where they overlap.
+       */
+      if (prev &&
+          attr->start_index <= prev->end_index &&
+          pango_attribute_equal (prev, attr))
+        {
+          prev->end_index = MAX (prev->end_index, attr->end_index);
+          pango_attribute_destroy (attr);
+        }
+      else
+        {
+          g_hash_table_insert (last_of_type, GINT_TO_POINTER (attr->klass->type), attr);
+          g_ptr_array_index (list->attributes, n++) = attr;
+        }
+    }
+
+  g_ptr_array_set_size (list->attributes, n);
+
+  g_hash_table_unref (last_of_type);
+}
+
 /* {{{ PangoAttrList serialization */
 
 /* We serialize attribute lists to strings. The format
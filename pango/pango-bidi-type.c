@@ -127,6 +127,74 @@ pango_log2vis_get_embedding_levels (const gchar    *text,
   return embedding_levels;
 }
 
+/* Text that only contains characters below U+0590, the start of the
+ * Hebrew block, has no strong RTL characters, no Arabic numbers and no
+ * explicit embeddings or isolates. Unless the base direction has an RTL
+ * taste, all of it resolves to level 0, and we can skip classifying
+ * every character and calling FriBidi.
+ *
+ * The scan looks at 8 bytes at a time while the text is ASCII.
+ */
+gboolean
+pango_log2vis_text_is_ltr (const char     *text,
+                           int             length,
+                           PangoDirection  base_dir)
+{
+  const guchar *p = (const guchar *) text;
+  const guchar *end = p + length;
+
+  switch (base_dir)
+    {
+    case PANGO_DIRECTION_RTL:
+    case PANGO_DIRECTION_TTB_LTR:
+      return FALSE;
+
+    case PANGO_DIRECTION_WEAK_RTL:
+      /* Only resolves to LTR if there are letters. We only look
+       * for ASCII ones, and leave anything else to FriBidi.
+       */
+      for (p = (const guchar *) text; p < end; p++)
+        if (g_ascii_isalpha (*p))
+          break;
+      if (p == end)
+        return FALSE;
+      p = (const guchar *) text;
+      break;
+
+    case PANGO_DIRECTION_LTR:
+    case PANGO_DIRECTION_TTB_RTL:
+    case PANGO_DIRECTION_WEAK_LTR:
+    case PANGO_DIRECTION_NEUTRAL:
+    default:
+      break;
+    }
+
+  while (p < end)
+    {
+      while (end - p >= 8)
+        {
+          guint64 chunk;
+
+          memcpy (&chunk, p, 8);
+          if (chunk & G_GUINT64_CONSTANT (0x8080808080808080))
+            break;
+          p += 8;
+        }
+
+      if (p == end)
+        break;
+
+      if (*p < 0x80)
+        p++;
+      else if (*p < 0xd6) /* Two-byte sequences up to U+057F */
+        p += 2;
+      else
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
 void
 pango_log2vis_fill_embedding_levels (const gchar    *text,
                                     int             length,
@@ -148,6 +216,13 @@ pango_log2vis_fill_embedding_levels (const gchar    *text,
   G_STATIC_ASSERT (sizeof (FriBidiLevel) == sizeof (guint8));
   G_STATIC_ASSERT (sizeof (FriBidiChar) == sizeof (gunichar));
 
+  if (pango_log2vis_text_is_ltr (text, length, *pbase_dir))
+    {
+      memset (embedding_levels_list, 0, n_chars);
+      *pbase_dir = PANGO_DIRECTION_LTR;
+      return;
+    }
+
   switch (*pbase_dir)
     {
     case PANGO_DIRECTION_LTR:
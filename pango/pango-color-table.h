@@ -1,6 +1,6 @@
 /* pango-color-table.h: Generated by gen-color-table.pl from rgb.txt
  *
- *  Date: Thu May  5 15:35:35 2016
+ *  Date: Mon Oct 19 13:58:45 2026
  *
  * Do not edit.   
  */
@@ -1347,3 +1347,112 @@ static const ColorEntry color_entries[] = {
   { 6159, 139, 139, 0 },
   { 6167, 154, 205, 50 }
 };
+
+#define COLOR_NAME_MAX_LENGTH 20
+
+static inline guint32
+color_name_hash (const char *key,
+                 int         len)
+{
+  guint32 h = 0x811c9dc5u;
+
+  for (int i = 0; i < len; i++)
+    h = (h ^ (guchar) key[i]) * 0x01000193u;
+
+  return h;
+}
+
+static const guint16 color_displacements[256] = {
+  3, 3, 0, 2, 5, 3, 8, 1, 1, 2, 1, 0, 2, 0, 1, 8,
+  0, 1, 6, 2, 0, 1, 0, 1, 0, 4, 0, 0, 0, 0, 2, 0,
+  0, 0, 9, 3, 3, 2, 1, 0, 4, 2, 0, 0, 1, 3, 1, 0,
+  8, 0, 0, 7, 4, 1, 1, 7, 0, 0, 1, 0, 1, 3, 3, 0,
+  1, 0, 4, 3, 5, 0, 1, 1, 0, 2, 4, 0, 1, 9, 0, 0,
+  0, 4, 3, 1, 2, 3, 0, 0, 6, 2, 2, 0, 3, 5, 4, 0,
+  0, 3, 0, 13, 16, 0, 0, 2, 1, 3, 11, 1, 1, 4, 0, 5,
+  0, 1, 6, 1, 6, 0, 5, 0, 0, 29, 10, 0, 0, 0, 2, 8,
+  0, 26, 1, 6, 2, 1, 0, 8, 0, 1, 0, 6, 0, 0, 11, 2,
+  1, 0, 9, 6, 0, 0, 0, 11, 0, 3, 4, 1, 6, 1, 0, 4,
+  1, 6, 0, 0, 1, 7, 0, 3, 0, 0, 0, 0, 0, 1, 1, 1,
+  9, 9, 31, 5, 4, 1, 4, 0, 10, 5, 6, 0, 2, 0, 3, 0,
+  1, 2, 6, 4, 3, 2, 3, 8, 1, 0, 0, 2, 0, 0, 7, 0,
+  17, 4, 5, 1, 6, 3, 2, 0, 8, 8, 0, 3, 5, 21, 6, 14,
+  0, 0, 0, 2, 0, 1, 4, 0, 0, 0, 0, 2, 4, 1, 0, 1,
+  0, 0, 2, 0, 20, 4, 4, 1, 0, 0, 2, 0, 260, 0, 6, 6,
+};
+
+/* Index into color_entries + 1 for each slot, 0 if unused */
+static const guint16 color_slots[1024] = {
+  531, 597, 548, 0, 555, 0, 184, 479, 215, 0, 243, 98, 587, 3, 201, 0,
+  625, 0, 213, 633, 0, 0, 0, 5, 513, 430, 534, 219, 510, 383, 594, 498,
+  51, 69, 428, 0, 0, 0, 648, 254, 0, 500, 0, 0, 0, 256, 599, 533,
+  0, 189, 395, 454, 517, 265, 0, 536, 226, 0, 289, 0, 615, 0, 401, 656,
+  50, 632, 0, 492, 449, 0, 0, 64, 629, 0, 286, 0, 87, 0, 35, 135,
+  0, 0, 635, 0, 0, 0, 225, 372, 462, 1, 558, 552, 234, 43, 0, 237,
+  380, 299, 620, 0, 0, 569, 39, 185, 0, 63, 229, 38, 664, 391, 298, 337,
+  497, 0, 0, 108, 338, 0, 0, 0, 468, 339, 0, 0, 0, 310, 0, 0,
+  296, 0, 495, 0, 491, 408, 0, 425, 0, 559, 118, 355, 0, 0, 62, 647,
+  553, 568, 77, 637, 528, 278, 176, 91, 0, 54, 0, 0, 0, 521, 71, 302,
+  469, 488, 214, 365, 283, 585, 20, 191, 315, 429, 321, 432, 194, 437, 344, 480,
+  22, 276, 0, 65, 83, 137, 291, 485, 346, 143, 93, 0, 0, 11, 537, 584,
+  18, 79, 0, 42, 617, 0, 503, 613, 82, 574, 288, 0, 0, 261, 0, 325,
+  447, 303, 171, 440, 508, 526, 605, 0, 0, 33, 211, 2, 139, 0, 523, 0,
+  155, 0, 0, 0, 0, 575, 236, 0, 0, 581, 0, 543, 0, 222, 86, 0,
+  544, 41, 145, 204, 329, 0, 277, 290, 650, 549, 644, 154, 0, 248, 0, 336,
+  530, 0, 186, 658, 275, 190, 0, 271, 482, 0, 0, 294, 477, 0, 210, 638,
+  0, 0, 356, 0, 382, 470, 0, 661, 0, 0, 0, 0, 0, 0, 0, 130,
+  501, 0, 0, 252, 493, 318, 0, 0, 0, 512, 319, 413, 267, 0, 362, 209,
+  129, 640, 197, 363, 228, 106, 626, 418, 0, 122, 0, 0, 308, 0, 628, 354,
+  29, 285, 0, 0, 109, 335, 0, 0, 343, 414, 27, 0, 0, 371, 101, 73,
+  578, 111, 0, 358, 0, 567, 260, 17, 144, 59, 13, 133, 0, 196, 0, 611,
+  646, 349, 0, 368, 0, 152, 527, 0, 180, 519, 232, 68, 0, 0, 0, 0,
+  142, 0, 0, 0, 311, 0, 400, 0, 393, 0, 0, 0, 0, 0, 426, 0,
+  0, 340, 279, 652, 547, 580, 450, 616, 557, 0, 287, 36, 0, 320, 0, 55,
+  556, 174, 113, 387, 509, 0, 0, 292, 565, 0, 0, 195, 467, 0, 0, 281,
+  378, 610, 427, 465, 406, 0, 21, 0, 423, 0, 0, 0, 136, 653, 345, 0,
+  590, 94, 240, 451, 0, 504, 0, 0, 0, 0, 505, 0, 444, 110, 603, 0,
+  104, 529, 49, 522, 600, 631, 324, 0, 170, 366, 375, 445, 74, 0, 0, 0,
+  61, 0, 0, 0, 0, 452, 179, 0, 0, 0, 84, 0, 235, 119, 200, 177,
+  148, 641, 32, 199, 0, 404, 592, 124, 40, 175, 0, 396, 478, 627, 202, 163,
+  327, 502, 604, 0, 249, 608, 0, 282, 0, 140, 657, 511, 223, 0, 623, 0,
+  313, 0, 295, 563, 0, 0, 399, 274, 0, 434, 596, 560, 257, 0, 0, 188,
+  76, 30, 224, 0, 651, 0, 264, 245, 0, 253, 132, 341, 456, 241, 443, 0,
+  455, 262, 489, 272, 614, 206, 0, 218, 572, 192, 0, 0, 0, 388, 0, 183,
+  0, 385, 0, 0, 0, 473, 0, 0, 576, 486, 550, 360, 92, 369, 128, 364,
+  0, 0, 0, 100, 370, 0, 205, 0, 421, 123, 359, 0, 0, 269, 16, 173,
+  376, 606, 230, 15, 172, 158, 0, 23, 14, 46, 0, 417, 0, 212, 0, 181,
+  607, 233, 0, 481, 350, 446, 28, 0, 297, 0, 507, 0, 0, 419, 524, 666,
+  566, 422, 0, 115, 134, 403, 0, 238, 10, 221, 0, 165, 0, 227, 0, 487,
+  352, 0, 284, 514, 52, 622, 169, 47, 0, 0, 0, 4, 516, 0, 643, 220,
+  312, 0, 0, 386, 193, 436, 9, 259, 0, 353, 435, 499, 415, 0, 0, 0,
+  0, 0, 460, 573, 153, 166, 45, 458, 0, 24, 0, 56, 203, 466, 58, 586,
+  642, 208, 377, 545, 75, 316, 453, 0, 433, 306, 317, 159, 323, 280, 0, 0,
+  0, 322, 342, 0, 374, 411, 474, 624, 0, 0, 66, 373, 0, 168, 402, 126,
+  0, 618, 582, 120, 494, 361, 665, 217, 131, 0, 602, 0, 405, 593, 542, 0,
+  0, 0, 309, 207, 546, 0, 0, 0, 0, 0, 125, 246, 331, 0, 0, 348,
+  541, 6, 95, 0, 660, 0, 655, 438, 518, 441, 0, 394, 564, 0, 464, 0,
+  0, 384, 0, 0, 0, 0, 431, 0, 0, 0, 97, 164, 141, 463, 300, 0,
+  250, 0, 367, 532, 99, 0, 0, 0, 147, 273, 0, 520, 0, 107, 270, 48,
+  0, 0, 0, 0, 0, 589, 639, 0, 392, 105, 540, 409, 89, 0, 0, 0,
+  0, 81, 0, 85, 0, 484, 0, 0, 471, 390, 483, 0, 621, 595, 0, 0,
+  0, 397, 0, 242, 151, 304, 90, 0, 609, 389, 198, 0, 157, 57, 448, 398,
+  439, 630, 551, 332, 0, 182, 0, 0, 0, 0, 0, 31, 636, 334, 0, 0,
+  88, 0, 0, 116, 80, 472, 612, 25, 577, 591, 571, 619, 0, 0, 0, 570,
+  0, 251, 328, 12, 538, 19, 351, 539, 525, 301, 0, 598, 0, 53, 0, 0,
+  187, 0, 645, 515, 8, 102, 0, 0, 0, 0, 0, 0, 117, 561, 258, 0,
+  357, 424, 416, 0, 0, 0, 112, 255, 0, 138, 0, 167, 0, 70, 457, 0,
+  0, 654, 506, 554, 0, 476, 216, 72, 146, 244, 535, 588, 0, 0, 103, 150,
+  305, 314, 149, 0, 407, 0, 0, 381, 293, 67, 307, 410, 379, 114, 461, 0,
+  0, 127, 634, 0, 475, 263, 0, 490, 583, 0, 121, 78, 0, 60, 37, 268,
+  0, 663, 649, 562, 239, 0, 44, 160, 326, 0, 0, 0, 161, 0, 266, 231,
+  662, 247, 0, 162, 0, 442, 347, 459, 420, 156, 96, 0, 34, 333, 0, 7,
+  496, 26, 0, 0, 0, 0, 178, 0, 0, 601, 579, 0, 412, 330, 0, 659,
+};
+
+static inline guint
+color_name_slot (guint32 h)
+{
+  guint32 d = color_displacements[h & 255];
+
+  return ((h ^ d) * 0x9e3779b1u) >> 22;
+}
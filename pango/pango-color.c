@@ -151,37 +151,36 @@ pango_color_to_string (const PangoColor *color)
 #define ISUPPER(c)              ((c) >= 'A' && (c) <= 'Z')
 #define TOLOWER(c)              (ISUPPER (c) ? (c) - 'A' + 'a' : (c))
 
-static int
-compare_xcolor_entries (const void *a, const void *b)
+static gboolean
+find_color (const char *name,
+            PangoColor *color)
 {
-  const guchar *s1 = (const guchar *) a;
-  const guchar *s2 = (const guchar *) (color_names + ((const ColorEntry *) b)->name_offset);
-
-  while (*s1 && *s2)
+  char key[COLOR_NAME_MAX_LENGTH];
+  const ColorEntry *found;
+  const char *s;
+  int len;
+  guint slot;
+
+  /* Spaces in @name are ignored, except at the end */
+  for (s = name, len = 0; *s; s++)
     {
-      int c1, c2;
-      while (*s1 == ' ') s1++;
-      while (*s2 == ' ') s1++;
-      c1 = (gint)(guchar) TOLOWER (*s1);
-      c2 = (gint)(guchar) TOLOWER (*s2);
-      if (c1 != c2)
-        return (c1 - c2);
-      s1++; s2++;
+      if (*s == ' ')
+        continue;
+      if (len == COLOR_NAME_MAX_LENGTH)
+        return FALSE;
+      key[len++] = TOLOWER (*s);
     }
 
-  return ((gint) *s1) - ((gint) *s2);
-}
+  if (len == 0 || s[-1] == ' ')
+    return FALSE;
 
-static gboolean
-find_color(const char *name,
-	   PangoColor *color)
-{
-  ColorEntry *found;
+  slot = color_slots[color_name_slot (color_name_hash (key, len))];
+  if (slot == 0)
+    return FALSE;
 
-  found = bsearch (name, color_entries, G_N_ELEMENTS (color_entries),
-		   sizeof (ColorEntry),
-		   compare_xcolor_entries);
-  if (found == NULL)
+  found = &color_entries[slot - 1];
+  if (g_ascii_strncasecmp (color_names + found->name_offset, key, len) != 0 ||
+      color_names[found->name_offset + len] != '\0')
     return FALSE;
 
   if (color)
@@ -194,21 +193,64 @@ find_color(const char *name,
   return TRUE;
 }
 
+/* Value of each hex digit, or -1 */
+static const gint8 hex_digits[256] = {
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+   0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
+  -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+};
+
+/* Parses @n_components components of @len hex digits each, and
+ * scales them to 16 bits by repeating their digits. Invalid digits
+ * are detected once at the end, since any -1 makes @invalid negative.
+ */
 static gboolean
 hex (const char *spec,
-    int len,
-    unsigned int *c)
+     int         len,
+     int         n_components,
+     guint16    *values)
 {
-  const char *end;
-  *c = 0;
-  for (end = spec + len; spec != end; spec++)
-    if (g_ascii_isxdigit (*spec))
-      *c = (*c << 4) | g_ascii_xdigit_value (*spec);
-    else
-      return FALSE;
-  return TRUE;
-}
+  int invalid = 0;
+  int i, j;
+
+  for (i = 0; i < n_components; i++)
+    {
+      guint v = 0;
 
+      for (j = 0; j < len; j++)
+        {
+          int d = hex_digits[(guchar) *spec++];
+
+          invalid |= d;
+          v = (v << 4) | (d & 0xf);
+        }
+
+      switch (len)
+        {
+        case 1: v *= 0x1111; break;
+        case 2: v *= 0x101; break;
+        case 3: v = (v << 4) | (v >> 8); break;
+        default: break;
+        }
+
+      values[i] = v;
+    }
+
+  return invalid >= 0;
+}
 
 /**
  * pango_color_parse_with_alpha:
@@ -250,9 +292,9 @@ pango_color_parse_with_alpha (PangoColor *color,
 
   if (spec[0] == '#')
     {
+      guint16 values[4];
       size_t len;
-      unsigned int r, g, b, a;
-      gboolean has_alpha;
+      int n_components;
 
       spec++;
       len = strlen (spec);
@@ -262,56 +304,31 @@ pango_color_parse_with_alpha (PangoColor *color,
         case 6:
         case 9:
         case 12:
-          len /= 3;
-          has_alpha = FALSE;
+          n_components = 3;
           break;
         case 4:
         case 8:
         case 16:
           if (!alpha)
             return FALSE;
-          len /= 4;
-          has_alpha = TRUE;
+          n_components = 4;
           break;
         default:
           return FALSE;
         }
 
-      if (!hex (spec, len, &r) ||
-          !hex (spec + len, len, &g) ||
-          !hex (spec + len * 2, len, &b) ||
-          (has_alpha && !hex (spec + len * 3, len, &a)))
+      if (!hex (spec, len / n_components, n_components, values))
         return FALSE;
 
       if (color)
         {
-          int bits = len * 4;
-          r <<= 16 - bits;
-          g <<= 16 - bits;
-          b <<= 16 - bits;
-          while (bits < 16)
-            {
-              r |= (r >> bits);
-              g |= (g >> bits);
-              b |= (b >> bits);
-              bits *= 2;
-            }
-          color->red   = r;
-          color->green = g;
-          color->blue  = b;
+          color->red   = values[0];
+          color->green = values[1];
+          color->blue  = values[2];
         }
 
-      if (alpha && has_alpha)
-        {
-          int bits = len * 4;
-          a <<= 16 - bits;
-          while (bits < 16)
-            {
-              a |= (a >> bits);
-              bits *= 2;
-            }
-          *alpha = a;
-        }
+      if (alpha && n_components == 4)
+        *alpha = values[3];
     }
   else
     {
@@ -48,6 +48,8 @@ struct _PangoContext
   PangoFontMetrics *metrics;
 
   gboolean round_glyph_positions;
+  gboolean merge_shaping;
+  int subpixel_positions;
 };
 
 G_END_DECLS
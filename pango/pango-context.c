@@ -848,3 +848,119 @@ pango_context_get_round_glyph_positions (PangoContext *context)
 {
   return context->round_glyph_positions;
 }
+
+/**
+ * pango_context_set_merge_shaping:
+ * @context: a `PangoContext`
+ * @merge_shaping: whether to shape compatible items together
+ *
+ * Sets whether layouts using this context should shape runs of
+ * consecutive items together when they only differ in attributes
+ * that don't affect shaping.
+ *
+ * Such runs are passed to the shaper in a single call, and the
+ * resulting glyphs are split back per item afterwards. This can
+ * considerably reduce the shaping overhead for heavily attributed
+ * text, such as syntax-highlighted source code.
+ *
+ * Since shaping is no longer interrupted at item boundaries, kerning
+ * and other contextual positioning may be applied across them, so
+ * glyph positions can differ slightly from shaping each item on its own.
+ *
+ * The default value is %FALSE.
+ *
+ * Since: 1.56
+ */
+void
+pango_context_set_merge_shaping (PangoContext *context,
+                                 gboolean      merge_shaping)
+{
+  g_return_if_fail (PANGO_IS_CONTEXT (context));
+
+  merge_shaping = merge_shaping != FALSE;
+
+  if (context->merge_shaping != merge_shaping)
+    {
+      context->merge_shaping = merge_shaping;
+      context_changed (context);
+    }
+}
+
+/**
+ * pango_context_get_merge_shaping:
+ * @context: a `PangoContext`
+ *
+ * Returns whether layouts using this context shape runs of
+ * compatible items together.
+ *
+ * See [method@Pango.Context.set_merge_shaping].
+ *
+ * Returns: %TRUE if compatible items are shaped together
+ *
+ * Since: 1.56
+ */
+gboolean
+pango_context_get_merge_shaping (PangoContext *context)
+{
+  g_return_val_if_fail (PANGO_IS_CONTEXT (context), FALSE);
+
+  return context->merge_shaping;
+}
+
+/**
+ * pango_context_set_subpixel_positions:
+ * @context: a `PangoContext`
+ * @n_positions: the number of glyph positions per device unit,
+ *   or 0 to not quantize glyph positions
+ *
+ * Sets the number of distinct subpixel positions that glyph
+ * positions and widths are quantized to, per device unit.
+ *
+ * When glyph positions are not rounded to integral positions (see
+ * [method@Pango.Context.set_round_glyph_positions]), quantizing them
+ * to a small number of subpixel positions, such as 4, bounds the number
+ * of distinct glyph renderings a renderer needs to cache, while keeping
+ * most of the accuracy of unrounded positioning. Letter spacing and
+ * justification adjustments are quantized in the same way, in device
+ * units of the font of the text they apply to.
+ *
+ * This setting has no effect while glyph positions are rounded.
+ *
+ * The default value is 0.
+ *
+ * Since: 1.56
+ */
+void
+pango_context_set_subpixel_positions (PangoContext *context,
+                                      int           n_positions)
+{
+  g_return_if_fail (PANGO_IS_CONTEXT (context));
+  g_return_if_fail (n_positions >= 0 && n_positions <= 64);
+
+  if (context->subpixel_positions != n_positions)
+    {
+      context->subpixel_positions = n_positions;
+      context_changed (context);
+    }
+}
+
+/**
+ * pango_context_get_subpixel_positions:
+ * @context: a `PangoContext`
+ *
+ * Returns the number of subpixel positions per device unit that
+ * glyph positions are quantized to.
+ *
+ * See [method@Pango.Context.set_subpixel_positions].
+ *
+ * Returns: the number of subpixel positions, or 0
+ *
+ * Since: 1.56
+ */
+int
+pango_context_get_subpixel_positions (PangoContext *context)
+{
+  g_return_val_if_fail (PANGO_IS_CONTEXT (context), 0);
+
+  return context->subpixel_positions;
+}
@@ -111,6 +111,18 @@ void                    pango_context_set_round_glyph_positions (PangoContext
 PANGO_AVAILABLE_IN_1_44
 gboolean                pango_context_get_round_glyph_positions (PangoContext                 *context);
 
+PANGO_AVAILABLE_IN_1_56
+void                    pango_context_set_merge_shaping         (PangoContext                 *context,
+                                                                 gboolean                      merge_shaping);
+PANGO_AVAILABLE_IN_1_56
+gboolean                pango_context_get_merge_shaping         (PangoContext                 *context);
+
+PANGO_AVAILABLE_IN_1_56
+void                    pango_context_set_subpixel_positions    (PangoContext                 *context,
+                                                                 int                           n_positions);
+PANGO_AVAILABLE_IN_1_56
+int                     pango_context_get_subpixel_positions    (PangoContext                 *context);
+
 G_END_DECLS
 
 #endif /* __PANGO_CONTEXT_H__ */
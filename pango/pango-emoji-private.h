@@ -46,11 +46,18 @@ struct _PangoEmojiIter
   unsigned int cursor;
 };
 
+unsigned char
+_pango_emoji_segmentation_category (gunichar ch);
+
+unsigned char *
+_pango_emoji_iter_alloc_types (PangoEmojiIter *iter,
+                               unsigned int    size);
+
 PangoEmojiIter *
-_pango_emoji_iter_init (PangoEmojiIter *iter,
-                        const char     *text,
-                        int             length,
-                        unsigned int    n_chars);
+_pango_emoji_iter_start (PangoEmojiIter *iter,
+                         const char     *text,
+                         int             length,
+                         unsigned int    n_chars);
 
 gboolean
 _pango_emoji_iter_next (PangoEmojiIter *iter);
@@ -53,61 +53,16 @@
 #include "pango-emoji-private.h"
 #include "pango-emoji-table.h"
 
-static inline gboolean
-bsearch_interval (gunichar              c,
-                  const struct Interval table[],
-                  guint                 n)
-{
-  guint lower = 0;
-  guint upper = n - 1;
-
-  while (lower <= upper)
-    {
-      int mid = (lower + upper) / 2;
-
-      if (c < table[mid].start)
-        upper = mid - 1;
-      else if (c > table[mid].end)
-        lower = mid + 1;
-      else
-        return TRUE;
-    }
-
-  return FALSE;
-}
-
-#define DEFINE_pango_Is_(name) \
-static inline gboolean \
-_pango_Is_##name (gunichar ch) \
-{ \
-  return ch >= _pango_##name##_table[0].start && \
-         bsearch_interval (ch, \
-                           _pango_##name##_table, \
-                           G_N_ELEMENTS (_pango_##name##_table)); \
-}
-
-DEFINE_pango_Is_(Emoji)
-DEFINE_pango_Is_(Emoji_Presentation)
-DEFINE_pango_Is_(Emoji_Modifier)
-DEFINE_pango_Is_(Emoji_Modifier_Base)
-DEFINE_pango_Is_(Extended_Pictographic)
-
 gboolean
 _pango_Is_Emoji_Base_Character (gunichar ch)
 {
-	return _pango_Is_Emoji (ch);
+	return (_pango_emoji_props_lookup (ch) & PANGO_EMOJI_PROP_EMOJI) != 0;
 }
 
 gboolean
 _pango_Is_Emoji_Extended_Pictographic (gunichar ch)
 {
-	return _pango_Is_Extended_Pictographic (ch);
-}
-
-static inline gboolean
-_pango_Is_Emoji_Emoji_Default (gunichar ch)
-{
-  return _pango_Is_Emoji_Presentation (ch);
+	return (_pango_emoji_props_lookup (ch) & PANGO_EMOJI_PROP_EXTENDED_PICTOGRAPHIC) != 0;
 }
 
 static inline gboolean
@@ -152,6 +107,8 @@ enum PangoEmojiScannerCategory {
 static inline unsigned char
 _pango_EmojiSegmentationCategory (gunichar codepoint)
 {
+  guint8 props;
+
   /* Specific ones first. */
   if (('a' <= codepoint && codepoint <= 'z') ||
       ('A' <= codepoint && codepoint <= 'Z') ||
@@ -184,17 +141,19 @@ _pango_EmojiSegmentationCategory (gunichar codepoint)
       (0xE0061 <= codepoint && codepoint <= 0xE007A))
     return TAG_SEQUENCE;
 
-  if (_pango_Is_Emoji_Modifier_Base (codepoint))
+  props = _pango_emoji_props_lookup (codepoint);
+
+  if (props & PANGO_EMOJI_PROP_MODIFIER_BASE)
     return EMOJI_MODIFIER_BASE;
-  if (_pango_Is_Emoji_Modifier (codepoint))
+  if (props & PANGO_EMOJI_PROP_MODIFIER)
     return EMOJI_MODIFIER;
   if (_pango_Is_Regional_Indicator (codepoint))
     return REGIONAL_INDICATOR;
   if (_pango_Is_Emoji_Keycap_Base (codepoint))
     return KEYCAP_BASE;
-  if (_pango_Is_Emoji_Emoji_Default (codepoint))
+  if (props & PANGO_EMOJI_PROP_PRESENTATION)
     return EMOJI_EMOJI_PRESENTATION;
-  if (_pango_Is_Emoji (codepoint))
+  if (props & PANGO_EMOJI_PROP_EMOJI)
     return EMOJI_TEXT_PRESENTATION;
 
   /* Ragel state machine will interpret unknown category as "any". */
@@ -210,28 +169,34 @@ typedef unsigned char *emoji_text_iter_t;
 #pragma GCC diagnostic pop
 
 
-PangoEmojiIter *
-_pango_emoji_iter_init (PangoEmojiIter *iter,
-                        const char     *text,
-                        int             length,
-                        unsigned int    n_chars)
+unsigned char
+_pango_emoji_segmentation_category (gunichar ch)
 {
-  unsigned char *types;
-  unsigned int i;
-  const char *p;
+  return _pango_EmojiSegmentationCategory (ch);
+}
 
-  if (n_chars < 64)
-    types = iter->types_;
+/* Sets up storage for the segmentation categories of up to
+ * @size characters. The caller fills it in, then calls
+ * _pango_emoji_iter_start().
+ */
+unsigned char *
+_pango_emoji_iter_alloc_types (PangoEmojiIter *iter,
+                               unsigned int    size)
+{
+  if (size < 64)
+    iter->types = iter->types_;
   else
-    types = g_malloc (n_chars);
+    iter->types = g_malloc (size);
 
-  p = text;
-  for (i = 0; i < n_chars; i++)
-  {
-    types[i] = _pango_EmojiSegmentationCategory (g_utf8_get_char (p));
-    p = g_utf8_next_char (p);
-  }
+  return iter->types;
+}
 
+PangoEmojiIter *
+_pango_emoji_iter_start (PangoEmojiIter *iter,
+                         const char     *text,
+                         int             length,
+                         unsigned int    n_chars)
+{
   iter->text_start = iter->start = iter->end = text;
   if (length >= 0)
     iter->text_end = text + length;
@@ -239,7 +204,6 @@ _pango_emoji_iter_init (PangoEmojiIter *iter,
     iter->text_end = text + strlen (text);
   iter->is_emoji = FALSE;
 
-  iter->types = types;
   iter->n_chars = n_chars;
   iter->cursor = 0;
 
@@ -0,0 +1,96 @@
+/* == Start of generated table == */
+/*
+ * The following table is generated by running:
+ *
+ *   ./gen-font-keywords.py
+ */
+
+#ifndef PANGO_FONT_KEYWORDS_H
+#define PANGO_FONT_KEYWORDS_H
+
+#define FONT_KEYWORD_MAX_LENGTH 14
+
+static inline guint
+font_keyword_hash (const char *key,
+                   int         len)
+{
+  guint32 h = 0x811c9dc5u ^ 18u;
+
+  for (int i = 0; i < len; i++)
+    h = (h ^ (guchar) key[i]) * 0x01000193u;
+
+  return h & 255;
+}
+
+static const FontKeyword font_keywords[] = {
+  { "Normal", FONT_KEYWORD_NORMAL, 0 },
+  { "Roman", FONT_KEYWORD_STYLE, PANGO_STYLE_NORMAL },
+  { "Oblique", FONT_KEYWORD_STYLE, PANGO_STYLE_OBLIQUE },
+  { "Italic", FONT_KEYWORD_STYLE, PANGO_STYLE_ITALIC },
+  { "Small-Caps", FONT_KEYWORD_VARIANT, PANGO_VARIANT_SMALL_CAPS },
+  { "All-Small-Caps", FONT_KEYWORD_VARIANT, PANGO_VARIANT_ALL_SMALL_CAPS },
+  { "Petite-Caps", FONT_KEYWORD_VARIANT, PANGO_VARIANT_PETITE_CAPS },
+  { "All-Petite-Caps", FONT_KEYWORD_VARIANT, PANGO_VARIANT_ALL_PETITE_CAPS },
+  { "Unicase", FONT_KEYWORD_VARIANT, PANGO_VARIANT_UNICASE },
+  { "Title-Caps", FONT_KEYWORD_VARIANT, PANGO_VARIANT_TITLE_CAPS },
+  { "Thin", FONT_KEYWORD_WEIGHT, PANGO_WEIGHT_THIN },
+  { "Ultra-Light", FONT_KEYWORD_WEIGHT, PANGO_WEIGHT_ULTRALIGHT },
+  { "Extra-Light", FONT_KEYWORD_WEIGHT, PANGO_WEIGHT_ULTRALIGHT },
+  { "Light", FONT_KEYWORD_WEIGHT, PANGO_WEIGHT_LIGHT },
+  { "Semi-Light", FONT_KEYWORD_WEIGHT, PANGO_WEIGHT_SEMILIGHT },
+  { "Demi-Light", FONT_KEYWORD_WEIGHT, PANGO_WEIGHT_SEMILIGHT },
+  { "Book", FONT_KEYWORD_WEIGHT, PANGO_WEIGHT_BOOK },
+  { "Regular", FONT_KEYWORD_WEIGHT, PANGO_WEIGHT_NORMAL },
+  { "Medium", FONT_KEYWORD_WEIGHT, PANGO_WEIGHT_MEDIUM },
+  { "Semi-Bold", FONT_KEYWORD_WEIGHT, PANGO_WEIGHT_SEMIBOLD },
+  { "Demi-Bold", FONT_KEYWORD_WEIGHT, PANGO_WEIGHT_SEMIBOLD },
+  { "Bold", FONT_KEYWORD_WEIGHT, PANGO_WEIGHT_BOLD },
+  { "Ultra-Bold", FONT_KEYWORD_WEIGHT, PANGO_WEIGHT_ULTRABOLD },
+  { "Extra-Bold", FONT_KEYWORD_WEIGHT, PANGO_WEIGHT_ULTRABOLD },
+  { "Heavy", FONT_KEYWORD_WEIGHT, PANGO_WEIGHT_HEAVY },
+  { "Black", FONT_KEYWORD_WEIGHT, PANGO_WEIGHT_HEAVY },
+  { "Ultra-Heavy", FONT_KEYWORD_WEIGHT, PANGO_WEIGHT_ULTRAHEAVY },
+  { "Extra-Heavy", FONT_KEYWORD_WEIGHT, PANGO_WEIGHT_ULTRAHEAVY },
+  { "Ultra-Black", FONT_KEYWORD_WEIGHT, PANGO_WEIGHT_ULTRAHEAVY },
+  { "Extra-Black", FONT_KEYWORD_WEIGHT, PANGO_WEIGHT_ULTRAHEAVY },
+  { "Ultra-Condensed", FONT_KEYWORD_STRETCH, PANGO_STRETCH_ULTRA_CONDENSED },
+  { "Extra-Condensed", FONT_KEYWORD_STRETCH, PANGO_STRETCH_EXTRA_CONDENSED },
+  { "Condensed", FONT_KEYWORD_STRETCH, PANGO_STRETCH_CONDENSED },
+  { "Semi-Condensed", FONT_KEYWORD_STRETCH, PANGO_STRETCH_SEMI_CONDENSED },
+  { "Semi-Expanded", FONT_KEYWORD_STRETCH, PANGO_STRETCH_SEMI_EXPANDED },
+  { "Expanded", FONT_KEYWORD_STRETCH, PANGO_STRETCH_EXPANDED },
+  { "Extra-Expanded", FONT_KEYWORD_STRETCH, PANGO_STRETCH_EXTRA_EXPANDED },
+  { "Ultra-Expanded", FONT_KEYWORD_STRETCH, PANGO_STRETCH_ULTRA_EXPANDED },
+  { "Not-Rotated", FONT_KEYWORD_GRAVITY, PANGO_GRAVITY_SOUTH },
+  { "South", FONT_KEYWORD_GRAVITY, PANGO_GRAVITY_SOUTH },
+  { "Upside-Down", FONT_KEYWORD_GRAVITY, PANGO_GRAVITY_NORTH },
+  { "North", FONT_KEYWORD_GRAVITY, PANGO_GRAVITY_NORTH },
+  { "Rotated-Left", FONT_KEYWORD_GRAVITY, PANGO_GRAVITY_EAST },
+  { "East", FONT_KEYWORD_GRAVITY, PANGO_GRAVITY_EAST },
+  { "Rotated-Right", FONT_KEYWORD_GRAVITY, PANGO_GRAVITY_WEST },
+  { "West", FONT_KEYWORD_GRAVITY, PANGO_GRAVITY_WEST },
+};
+
+/* Index into font_keywords + 1 for each hash value, 0 if unused */
+static const guint8 font_keyword_slots[256] = {
+  0, 0, 0, 0, 0, 0, 29, 0, 40, 0, 16, 0, 0, 0, 34, 0,
+  0, 18, 0, 0, 0, 0, 28, 0, 0, 0, 10, 0, 0, 0, 38, 0,
+  0, 0, 3, 0, 0, 0, 0, 0, 23, 0, 0, 0, 0, 0, 0, 0,
+  8, 14, 0, 0, 0, 0, 36, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 20, 0, 0, 0, 0, 0,
+  0, 0, 45, 0, 2, 0, 0, 0, 0, 39, 0, 0, 33, 0, 0, 0,
+  0, 0, 17, 0, 31, 0, 0, 0, 0, 0, 0, 0, 0, 0, 26, 0,
+  11, 0, 0, 0, 0, 0, 42, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  46, 0, 30, 0, 0, 0, 0, 0, 19, 0, 0, 0, 0, 0, 0, 0,
+  22, 0, 27, 0, 0, 13, 0, 0, 0, 0, 0, 4, 0, 7, 0, 0,
+  32, 43, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 24, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 25, 0, 35, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 5, 0, 0, 0, 0, 0, 0, 0, 9,
+  1, 41, 37, 0, 0, 0, 0, 0, 0, 0, 0, 15, 0, 0, 0, 0,
+  0, 21, 44, 0, 6, 0, 0, 0, 0, 12, 0, 0, 0, 0, 0, 0,
+};
+
+#endif /* PANGO_FONT_KEYWORDS_H */
+
+/* == End of generated table == */
@@ -24,6 +24,7 @@
 
 #include <pango/pango-font.h>
 #include <pango/pango-coverage.h>
+#include <pango/pango-glyph.h>
 #include <pango/pango-types.h>
 
 #include <glib-object.h>
@@ -49,6 +50,11 @@ typedef struct {
                                    PangoMatrix *matrix);
   int              (* get_absolute_size) (PangoFont *font);
   PangoVariant     (* get_variant) (PangoFont *font);
+  void             (* get_glyphs_extents) (PangoFont            *font,
+                                           const PangoGlyphInfo *glyphs,
+                                           int                   n_glyphs,
+                                           PangoRectangle       *ink_rects,
+                                           PangoRectangle       *logical_rect);
 } PangoFontClassPrivate;
 
 gboolean pango_font_is_hinted         (PangoFont *font);
@@ -57,6 +63,33 @@ void     pango_font_get_scale_factors (PangoFont *font,
                                        double    *y_scale);
 void     pango_font_get_matrix        (PangoFont   *font,
                                        PangoMatrix *matrix);
+void     pango_font_get_glyphs_extents (PangoFont            *font,
+                                        const PangoGlyphInfo *glyphs,
+                                        int                   n_glyphs,
+                                        PangoRectangle       *ink_rects,
+                                        PangoRectangle       *logical_rect);
+
+/* Extends the vertical extents in @logical_rect by those of
+ * @glyph_logical, or starts them over if @first
+ */
+static inline void
+pango_font_add_logical_extents (PangoRectangle       *logical_rect,
+                                const PangoRectangle *glyph_logical,
+                                gboolean              first)
+{
+  if (first)
+    {
+      logical_rect->y = glyph_logical->y;
+      logical_rect->height = glyph_logical->height;
+    }
+  else
+    {
+      int new_y = MIN (logical_rect->y, glyph_logical->y);
+      logical_rect->height = MAX (logical_rect->y + logical_rect->height,
+                                  glyph_logical->y + glyph_logical->height) - new_y;
+      logical_rect->y = new_y;
+    }
+}
 
 static inline int pango_font_get_absolute_size (PangoFont *font)
 {
@@ -257,6 +257,9 @@ guint                 pango_font_description_hash        (const PangoFontDescrip
 PANGO_AVAILABLE_IN_ALL
 gboolean              pango_font_description_equal       (const PangoFontDescription  *desc1,
                                                           const PangoFontDescription  *desc2) G_GNUC_PURE;
+PANGO_AVAILABLE_IN_1_56
+const PangoFontDescription *
+                      pango_font_description_intern      (const PangoFontDescription  *desc);
 PANGO_AVAILABLE_IN_ALL
 void                  pango_font_description_free        (PangoFontDescription        *desc);
 PANGO_AVAILABLE_IN_ALL
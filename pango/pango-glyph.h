@@ -264,6 +264,19 @@ void                    pango_shape_item                        (PangoItem
                                                                  PangoGlyphString    *glyphs,
                                                                  PangoShapeFlags      flags);
 
+PANGO_AVAILABLE_IN_1_56
+int                     pango_shape_item_to_buffers             (PangoItem           *item,
+                                                                 const char          *paragraph_text,
+                                                                 int                  paragraph_length,
+                                                                 PangoLogAttr        *log_attrs,
+                                                                 PangoShapeFlags      flags,
+                                                                 int                  n_glyphs,
+                                                                 PangoGlyph          *glyphs,
+                                                                 int                 *advances,
+                                                                 int                 *x_offsets,
+                                                                 int                 *y_offsets,
+                                                                 int                 *log_clusters);
+
 
 G_END_DECLS
 
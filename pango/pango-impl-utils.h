@@ -49,6 +49,19 @@ void _pango_shape_get_extents (gint              n_chars,
 			       PangoRectangle   *logical_rect);
 
 
+/* Default breaking without UAX#29 sentence boundaries, see break.c */
+void _pango_default_break_without_sentences (const char   *text,
+                                             int           length,
+                                             PangoLogAttr *attrs,
+                                             int           attrs_len);
+
+/* Tailoring of a paragraph's items, batched by script and language */
+void _pango_tailor_break_items (const char   *text,
+                                GList        *items,
+                                PangoLogAttr *attrs,
+                                int           attrs_len);
+
+
 /* We define these functions static here because we don't want to add public API
  * for them (if anything, it belongs to glib, but glib found it trivial enough
  * not to add API for).  At some point metrics calculations will be
@@ -23,6 +23,7 @@
 
 #include <pango/pango-item.h>
 #include <pango/pango-break.h>
+#include <pango/pango-glyph.h>
 
 G_BEGIN_DECLS
 
@@ -114,6 +115,21 @@ void               pango_item_unsplit                 (PangoItem *orig,
                                                        int        split_index,
                                                        int        split_offset);
 
+void               pango_shape_internal               (const char                 *item_text,
+                                                       int                         item_length,
+                                                       const char                 *paragraph_text,
+                                                       int                         paragraph_length,
+                                                       const PangoAnalysis        *analysis,
+                                                       PangoLogAttr               *log_attrs,
+                                                       int                         num_chars,
+                                                       PangoGlyphString           *glyphs,
+                                                       PangoShapeFlags             flags,
+                                                       int                         n_positions);
+
+int                pango_analysis_quantize_width      (const PangoAnalysis        *analysis,
+                                                       int                         width,
+                                                       int                         n_positions);
+
 
 G_END_DECLS
 
@@ -81,8 +81,23 @@ struct _PangoLayout
   /* Not copied during _copy() */
 
   PangoLogAttr *log_attrs;	/* Logical attributes for layout's text */
+  guint have_sentence_attrs : 1; /* Whether sentence boundaries in log_attrs are filled in */
   GSList *lines;
   guint line_count;		/* Number of lines in @lines. 0 if lines is %NULL */
+
+  /* Results that don't depend on the width, kept across width changes */
+  GPtrArray *paragraph_items;	/* Items of each paragraph, NULL where not itemized yet */
+  GHashTable *shaped_items;	/* Item offset => ShapedItem for each whole item */
+  GHashTable *ellipsize_plans;	/* Line start index => how to ellipsize it, see ellipsize.c */
+
+  int *log_widths;		/* Scratch space for line breaking, reused across relayouts */
+  int n_log_widths;
+
+  struct _Extents *line_extents;	/* Extents of each line for iterators, a g_rc_box; NULL if not computed */
+  int line_extents_width;	/* Width that iterators align lines in */
+  guint ink_overhang_cached : 1;
+  int ink_overhang_above;	/* How far the ink of any line sticks out above its logical extents */
+  int ink_overhang_below;	/* ... and below them */
 };
 
 typedef struct _Extents Extents;
@@ -109,7 +124,9 @@ struct _PangoLayoutIter
   PangoLayoutRun *run; /* FIXME nuke this, just keep the link */
   int index;
 
-  /* list of Extents for each line in layout coordinates */
+  /* list of Extents for each line in layout coordinates,
+   * a reference to layout->line_extents
+   */
   Extents *line_extents;
   int line_index;
 
@@ -148,13 +165,21 @@ struct _PangoLayoutIter
 gboolean _pango_layout_line_ellipsize (PangoLayoutLine *line,
 				       PangoAttrList   *attrs,
                                        PangoShapeFlags  shape_flags,
-				       int              goal_width);
+                                       int              n_positions,
+				       int              goal_width,
+                                       gboolean         keep_plan);
 
 void     _pango_layout_get_iter (PangoLayout     *layout,
                                  PangoLayoutIter *iter);
 
 void     _pango_layout_iter_destroy (PangoLayoutIter *iter);
 
+void     _pango_layout_get_ink_overhang (PangoLayout *layout,
+                                         int         *above,
+                                         int         *below);
+void     _pango_layout_iter_skip_to_y   (PangoLayoutIter *iter,
+                                         int              y);
+
 G_END_DECLS
 
 #endif /* __PANGO_LAYOUT_PRIVATE_H__ */
@@ -93,6 +93,7 @@
 
 typedef struct _ItemProperties ItemProperties;
 typedef struct _ParaBreakState ParaBreakState;
+typedef struct _LayoutMeasure LayoutMeasure;
 typedef struct _LastTabState LastTabState;
 
 /* Note that letter_spacing and shape are constant across items,
@@ -120,6 +121,51 @@ struct _ItemProperties
   int    absolute_line_height;
 };
 
+/* What pango_layout_measure() adds up while lines
+ * are made and thrown away
+ */
+struct _LayoutMeasure
+{
+  int line_count;
+  int baseline;                 /* Baseline of the last line */
+  int first_baseline;
+  int y_offset;                 /* Top of the next line */
+  PangoRectangle logical_rect;
+};
+
+typedef struct _LineCluster LineCluster;
+typedef struct _LineHitIndex LineHitIndex;
+
+/* A cluster of glyphs in a line, for hit testing */
+struct _LineCluster
+{
+  int x;                        /* Left edge, from the left edge of the line */
+  int width;
+  int start_index;              /* Byte range of the cluster in layout->text */
+  int end_index;
+  int start_offset;             /* Character offset of start_index */
+  PangoLayoutRun *run;
+  int glyph;                    /* First glyph of the cluster in run->glyphs */
+  int n_glyphs;
+};
+
+/* Everything x <=> index conversions need to know about a
+ * line, so that they can binary search instead of walking
+ * the glyphs and text of the line on every call
+ */
+struct _LineHitIndex
+{
+  int width;
+  int start_offset;             /* Character offsets of the line */
+  int end_offset;
+  gboolean suppress_last_trailing;
+
+  int n_clusters;
+  LineCluster *clusters;        /* In visual order */
+  int *logical;                 /* Indices into clusters, in logical order */
+  int *zeros;                   /* log_clusters for a single cluster */
+};
+
 typedef struct _PangoLayoutLinePrivate PangoLayoutLinePrivate;
 
 struct _PangoLayoutLinePrivate
@@ -128,6 +174,11 @@ struct _PangoLayoutLinePrivate
   guint ref_count;
 
   /* Extents cache status:
+   *
+   * LOGICAL_CACHED means that only the logical rect and height are
+   * cached, since nobody asked for the ink rect yet. Computing ink
+   * rects means looking at the glyph outlines, so we avoid it as
+   * long as we can.
    *
    * LEAKED means that the user has access to this line structure or a
    * run included in this line, and so can change the glyphs/glyph-widths.
@@ -135,12 +186,16 @@ struct _PangoLayoutLinePrivate
    */
   enum {
     NOT_CACHED,
+    LOGICAL_CACHED,
     CACHED,
     LEAKED
   } cache_status;
   PangoRectangle ink_rect;
   PangoRectangle logical_rect;
   int height;
+
+  /* Built on the first hit test, unless LEAKED */
+  LineHitIndex *hit_index;
 };
 
 struct _PangoLayoutClass
@@ -173,10 +228,16 @@ check_invalid (PangoLayoutIter *iter,
 #endif
 
 static void check_context_changed  (PangoLayout *layout);
+static void layout_lines_changed   (PangoLayout *layout);
 static void layout_changed  (PangoLayout *layout);
 
 static void pango_layout_clear_lines (PangoLayout *layout);
+static void pango_layout_clear_reusable (PangoLayout *layout);
 static void pango_layout_check_lines (PangoLayout *layout);
+static Extents *pango_layout_get_line_extents (PangoLayout *layout,
+                                               int         *layout_width);
+static void pango_layout_fill_lines (PangoLayout   *layout,
+                                     LayoutMeasure *measure);
 
 static PangoAttrList *pango_layout_get_effective_attributes (PangoLayout *layout);
 
@@ -254,7 +315,9 @@ pango_layout_finalize (GObject *object)
   layout = PANGO_LAYOUT (object);
 
   pango_layout_clear_lines (layout);
+  pango_layout_clear_reusable (layout);
   g_free (layout->log_attrs);
+  g_free (layout->log_widths);
 
   if (layout->context)
     g_object_unref (layout->context);
@@ -375,7 +438,9 @@ pango_layout_set_width (PangoLayout *layout,
   if (width != layout->width)
     {
       layout->width = width;
-      layout_changed (layout);
+
+      /* Only line breaking depends on the width */
+      layout_lines_changed (layout);
     }
 }
 
@@ -1480,7 +1545,7 @@ check_context_changed (PangoLayout *layout)
 }
 
 static void
-layout_changed (PangoLayout *layout)
+layout_lines_changed (PangoLayout *layout)
 {
   layout->serial++;
   if (layout->serial == 0)
@@ -1489,6 +1554,13 @@ layout_changed (PangoLayout *layout)
   pango_layout_clear_lines (layout);
 }
 
+static void
+layout_changed (PangoLayout *layout)
+{
+  layout_lines_changed (layout);
+  pango_layout_clear_reusable (layout);
+}
+
 /**
  * pango_layout_context_changed:
  * @layout: a `PangoLayout`
@@ -1536,6 +1608,79 @@ pango_layout_get_serial (PangoLayout *layout)
   return layout->serial;
 }
 
+/* Line breaking does not need sentence boundaries, so we only
+ * compute them when somebody asks for the log attrs, unless sentence
+ * attributes need them for tailoring. This has to
+ * replicate the per-paragraph pango_default_break() calls done by
+ * get_items_log_attrs(), and stop at the same paragraph as
+ * pango_layout_check_lines() did.
+ */
+static void
+pango_layout_ensure_sentence_attrs (PangoLayout *layout)
+{
+  PangoLogAttr *attrs;
+  PangoLayoutLine *last_line;
+  const char *start;
+  int start_offset;
+  int n_attrs;
+  gboolean done = FALSE;
+
+  if (layout->have_sentence_attrs || !layout->log_attrs)
+    return;
+
+  last_line = g_slist_last (layout->lines)->data;
+
+  attrs = g_new0 (PangoLogAttr, layout->n_chars + 1);
+  n_attrs = 0;
+  start_offset = 0;
+  start = layout->text;
+
+  do
+    {
+      int delimiter_index, next_para_index;
+      int n_chars;
+
+      if (layout->single_paragraph)
+        {
+          delimiter_index = layout->length;
+          next_para_index = layout->length;
+        }
+      else
+        pango_find_paragraph_boundary (start,
+                                       (layout->text + layout->length) - start,
+                                       &delimiter_index,
+                                       &next_para_index);
+
+      pango_default_break (start, next_para_index, NULL,
+                           attrs + start_offset,
+                           layout->n_chars + 1 - start_offset);
+
+      n_chars = pango_utf8_strlen (start, next_para_index);
+      n_attrs = start_offset + n_chars + 1;
+
+      if (start + delimiter_index == layout->text + layout->length)
+        done = TRUE;
+
+      start_offset += n_chars;
+      start += next_para_index;
+
+      if (start - layout->text > last_line->start_index)
+        done = TRUE;
+    }
+  while (!done);
+
+  for (int i = 0; i < n_attrs; i++)
+    {
+      layout->log_attrs[i].is_sentence_boundary = attrs[i].is_sentence_boundary;
+      layout->log_attrs[i].is_sentence_start = attrs[i].is_sentence_start;
+      layout->log_attrs[i].is_sentence_end = attrs[i].is_sentence_end;
+    }
+
+  g_free (attrs);
+
+  layout->have_sentence_attrs = TRUE;
+}
+
 /**
  * pango_layout_get_log_attrs:
  * @layout: a `PangoLayout`
@@ -1559,6 +1704,7 @@ pango_layout_get_log_attrs (PangoLayout   *layout,
   g_return_if_fail (layout != NULL);
 
   pango_layout_check_lines (layout);
+  pango_layout_ensure_sentence_attrs (layout);
 
   if (attrs)
     {
@@ -1601,6 +1747,7 @@ pango_layout_get_log_attrs_readonly (PangoLayout *layout,
   g_return_val_if_fail (layout != NULL, NULL);
 
   pango_layout_check_lines (layout);
+  pango_layout_ensure_sentence_attrs (layout);
 
   if (n_attrs)
     *n_attrs = layout->n_chars + 1;
@@ -1769,6 +1916,223 @@ pango_layout_get_line_readonly (PangoLayout *layout,
   return NULL;
 }
 
+static void
+line_hit_index_free (LineHitIndex *hit)
+{
+  if (!hit)
+    return;
+
+  g_free (hit->clusters);
+  g_free (hit->logical);
+  g_free (hit->zeros);
+  g_free (hit);
+}
+
+static int
+compare_cluster_index (gconstpointer a,
+                       gconstpointer b,
+                       gpointer      user_data)
+{
+  LineCluster *clusters = user_data;
+
+  return clusters[*(const int *)a].start_index - clusters[*(const int *)b].start_index;
+}
+
+static LineHitIndex *
+line_hit_index_new (PangoLayoutLine *line)
+{
+  PangoLayout *layout = line->layout;
+  LineHitIndex *hit;
+  GArray *clusters;
+  GSList *l;
+  const char *p;
+  int offset;
+  int max_glyphs = 1;
+
+  hit = g_new0 (LineHitIndex, 1);
+  clusters = g_array_new (FALSE, FALSE, sizeof (LineCluster));
+
+  for (l = line->runs; l; l = l->next)
+    {
+      PangoLayoutRun *run = l->data;
+      PangoGlyphString *glyphs = run->glyphs;
+      guint first = clusters->len;
+      int i;
+
+      for (i = 0; i < glyphs->num_glyphs; i++)
+        {
+          if (i == 0 || glyphs->log_clusters[i] != glyphs->log_clusters[i - 1])
+            {
+              LineCluster cluster;
+
+              cluster.x = hit->width;
+              cluster.width = 0;
+              cluster.start_index = run->item->offset + glyphs->log_clusters[i];
+              cluster.run = run;
+              cluster.glyph = i;
+              cluster.n_glyphs = 0;
+              g_array_append_val (clusters, cluster);
+            }
+
+          g_array_index (clusters, LineCluster, clusters->len - 1).width += glyphs->glyphs[i].geometry.width;
+          g_array_index (clusters, LineCluster, clusters->len - 1).n_glyphs++;
+          hit->width += glyphs->glyphs[i].geometry.width;
+        }
+
+      /* A cluster ends where the logically next one starts */
+      for (i = first; i < clusters->len; i++)
+        {
+          LineCluster *cluster = &g_array_index (clusters, LineCluster, i);
+          int next = run->item->analysis.level % 2 ? i - 1 : i + 1;
+
+          if (next >= (int) first && next < (int) clusters->len)
+            cluster->end_index = g_array_index (clusters, LineCluster, next).start_index;
+          else
+            cluster->end_index = run->item->offset + run->item->length;
+
+          max_glyphs = MAX (max_glyphs, cluster->n_glyphs);
+        }
+    }
+
+  hit->n_clusters = clusters->len;
+  hit->clusters = (LineCluster *) g_array_free (clusters, FALSE);
+
+  hit->logical = g_new (int, hit->n_clusters);
+  for (int i = 0; i < hit->n_clusters; i++)
+    hit->logical[i] = i;
+  g_qsort_with_data (hit->logical, hit->n_clusters, sizeof (int), compare_cluster_index, hit->clusters);
+
+  hit->zeros = g_new0 (int, max_glyphs);
+
+  /* Character offsets, walking the line once in logical order */
+  p = layout->text + line->start_index;
+  offset = hit->start_offset = g_utf8_pointer_to_offset (layout->text, p);
+  for (int i = 0; i < hit->n_clusters; i++)
+    {
+      LineCluster *cluster = &hit->clusters[hit->logical[i]];
+
+      offset += pango_utf8_strlen (p, layout->text + cluster->start_index - p);
+      p = layout->text + cluster->start_index;
+      cluster->start_offset = offset;
+    }
+  hit->end_offset = offset + pango_utf8_strlen (p, layout->text + line->start_index + line->length - p);
+
+  /* See pango_layout_line_x_to_index() */
+  hit->suppress_last_trailing = FALSE;
+  for (l = layout->lines; l; l = l->next)
+    {
+      if (l->data == line)
+        {
+          hit->suppress_last_trailing =
+            l->next &&
+            line->start_index + line->length == ((PangoLayoutLine *)l->next->data)->start_index;
+          break;
+        }
+    }
+
+  return hit;
+}
+
+/* Returns the hit index of @line. If @line has been leaked,
+ * the index is only good for one call, and is stored in @tmp
+ * to be freed by the caller.
+ */
+static LineHitIndex *
+line_get_hit_index (PangoLayoutLine  *line,
+                    LineHitIndex    **tmp)
+{
+  PangoLayoutLinePrivate *private = (PangoLayoutLinePrivate *)line;
+
+  *tmp = NULL;
+
+  if (private->cache_status == LEAKED)
+    return *tmp = line_hit_index_new (line);
+
+  if (!private->hit_index)
+    private->hit_index = line_hit_index_new (line);
+
+  return private->hit_index;
+}
+
+/* Returns the cluster containing the byte @index, or %NULL */
+static LineCluster *
+line_hit_index_find_index (LineHitIndex *hit,
+                           int           index)
+{
+  int lo = 0, hi = hit->n_clusters;
+
+  /* Find the last cluster starting at or before @index */
+  while (lo < hi)
+    {
+      int mid = (lo + hi) / 2;
+
+      if (hit->clusters[hit->logical[mid]].start_index <= index)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  for (int i = lo - 1; i >= 0; i--)
+    {
+      LineCluster *cluster = &hit->clusters[hit->logical[i]];
+
+      if (index < cluster->end_index)
+        return cluster;
+
+      /* Skip empty clusters sharing a start */
+      if (cluster->start_index < cluster->end_index)
+        break;
+    }
+
+  return NULL;
+}
+
+/* Returns the cluster containing @x_pos, which must be
+ * inside the line
+ */
+static LineCluster *
+line_hit_index_find_x (LineHitIndex *hit,
+                       int           x_pos)
+{
+  int lo = 0, hi = hit->n_clusters;
+
+  while (lo < hi)
+    {
+      int mid = (lo + hi) / 2;
+
+      if (hit->clusters[mid].x <= x_pos)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  return &hit->clusters[MAX (lo - 1, 0)];
+}
+
+/* Returns the character offset of @index, inside @cluster */
+static inline int
+line_cluster_offset (PangoLayout *layout,
+                     LineCluster *cluster,
+                     int          index)
+{
+  return cluster->start_offset +
+         pango_utf8_strlen (layout->text + cluster->start_index, index - cluster->start_index);
+}
+
+/* Makes a glyph string for the glyphs of @cluster alone, with
+ * log_clusters relative to the start of the cluster
+ */
+static inline void
+line_cluster_glyphs (LineHitIndex     *hit,
+                     LineCluster      *cluster,
+                     PangoGlyphString *glyphs)
+{
+  glyphs->num_glyphs = cluster->n_glyphs;
+  glyphs->glyphs = cluster->run->glyphs->glyphs + cluster->glyph;
+  glyphs->log_clusters = hit->zeros;
+  glyphs->space = cluster->n_glyphs;
+}
+
 /**
  * pango_layout_line_index_to_x:
  * @line: a `PangoLayoutLine`
@@ -1787,63 +2151,89 @@ pango_layout_line_index_to_x (PangoLayoutLine *line,
                               int             *x_pos)
 {
   PangoLayout *layout = line->layout;
-  GSList *run_list = line->runs;
-  int width = 0;
+  LineHitIndex *hit, *tmp;
+  LineCluster *cluster;
+  PangoGlyphString glyphs;
+  int offset;
+  int attr_offset;
+  int x;
 
-  while (run_list)
+  hit = line_get_hit_index (line, &tmp);
+
+  cluster = line_hit_index_find_index (hit, index);
+  if (!cluster)
     {
-      PangoLayoutRun *run = run_list->data;
+      if (x_pos)
+        *x_pos = hit->width;
+      goto out;
+    }
 
-      if (run->item->offset <= index && run->item->offset + run->item->length > index)
-        {
-          int offset = g_utf8_pointer_to_offset (layout->text, layout->text + index);
-          int attr_offset;
+  offset = line_cluster_offset (layout, cluster, index);
 
-          if (trailing)
-            {
-              while (index < line->start_index + line->length &&
-                     offset + 1 < layout->n_chars &&
-                     !layout->log_attrs[offset + 1].is_cursor_position)
-                {
-                  offset++;
-                  index = g_utf8_next_char (layout->text + index) - layout->text;
-                }
-            }
-          else
-            {
-              while (index > line->start_index &&
-                     !layout->log_attrs[offset].is_cursor_position)
-                {
-                  offset--;
-                  index = g_utf8_prev_char (layout->text + index) - layout->text;
-                }
-            }
+  if (trailing)
+    {
+      while (index < line->start_index + line->length &&
+             offset + 1 < layout->n_chars &&
+             !layout->log_attrs[offset + 1].is_cursor_position)
+        {
+          offset++;
+          index = g_utf8_next_char (layout->text + index) - layout->text;
+        }
+    }
+  else
+    {
+      while (index > line->start_index &&
+             !layout->log_attrs[offset].is_cursor_position)
+        {
+          offset--;
+          index = g_utf8_prev_char (layout->text + index) - layout->text;
+        }
+    }
 
-          /* Note: we simply assert here, since our items are all internally
-           * created. If that ever changes, we need to add a fallback here.
-           */
-          g_assert (run->item->analysis.flags & PANGO_ANALYSIS_FLAG_HAS_CHAR_OFFSET);
-          attr_offset = ((PangoItemPrivate *)run->item)->char_offset;
+  /* Note: we simply assert here, since our items are all internally
+   * created. If that ever changes, we need to add a fallback here.
+   */
+  g_assert (cluster->run->item->analysis.flags & PANGO_ANALYSIS_FLAG_HAS_CHAR_OFFSET);
 
-          pango_glyph_string_index_to_x_full (run->glyphs,
-                                              layout->text + run->item->offset,
-                                              run->item->length,
-                                              &run->item->analysis,
-                                              layout->log_attrs + attr_offset,
-                                              index - run->item->offset, trailing, x_pos);
-          if (x_pos)
-            *x_pos += width;
+  if (index >= cluster->start_index && index < cluster->end_index)
+    {
+      /* The common case: only look at the glyphs of the cluster */
+      line_cluster_glyphs (hit, cluster, &glyphs);
+      pango_glyph_string_index_to_x_full (&glyphs,
+                                          layout->text + cluster->start_index,
+                                          cluster->end_index - cluster->start_index,
+                                          &cluster->run->item->analysis,
+                                          layout->log_attrs + cluster->start_offset,
+                                          index - cluster->start_index, trailing, &x);
+      x += cluster->x;
+    }
+  else
+    {
+      /* The grapheme extends past the cluster, so
+       * we need to look at the whole run
+       */
+      PangoLayoutRun *run = cluster->run;
+      LineCluster *first = cluster;
 
-          return;
-        }
+      while (first > hit->clusters && (first - 1)->run == run)
+        first--;
 
-      width += pango_glyph_string_get_width (run->glyphs);
+      attr_offset = ((PangoItemPrivate *)run->item)->char_offset;
 
-      run_list = run_list->next;
+      pango_glyph_string_index_to_x_full (run->glyphs,
+                                          layout->text + run->item->offset,
+                                          run->item->length,
+                                          &run->item->analysis,
+                                          layout->log_attrs + attr_offset,
+                                          index - run->item->offset, trailing, &x);
+      x += first->x;
     }
 
   if (x_pos)
-    *x_pos = width;
+    *x_pos = x;
+
+out:
+  line_hit_index_free (tmp);
 }
 
 static PangoLayoutLine *
@@ -2905,7 +3295,7 @@ get_line_extents_layout_coords (PangoLayout     *layout,
 }
 
 /* if non-NULL line_extents returns a list of line extents
- * in layout coordinates
+ * in layout coordinates, allocated with g_rc_box_alloc()
  */
 static void
 pango_layout_get_extents_internal (PangoLayout    *layout,
@@ -2982,7 +3372,7 @@ pango_layout_get_extents_internal (PangoLayout    *layout,
 
   if (line_extents && layout->line_count > 0)
     {
-      *line_extents = g_malloc (sizeof (Extents) * layout->line_count);
+      *line_extents = g_rc_box_alloc (sizeof (Extents) * layout->line_count);
     }
 
   baseline = 0;
@@ -3213,72 +3603,284 @@ pango_layout_get_pixel_size (PangoLayout *layout,
 int
 pango_layout_get_baseline (PangoLayout *layout)
 {
-  int baseline;
-  Extents *extents = NULL;
+  Extents *extents;
 
-  /* XXX this is kinda inefficient */
-  pango_layout_get_extents_internal (layout, NULL, NULL, &extents);
-  baseline = extents ? extents[0].baseline : 0;
+  extents = pango_layout_get_line_extents (layout, NULL);
 
-  g_free (extents);
-
-  return baseline;
+  return extents ? extents[0].baseline : 0;
 }
 
-static void
-pango_layout_clear_lines (PangoLayout *layout)
+/* Returns the extents of all lines, as used by iterators.
+ * They are computed once and kept until the lines change.
+ * Take a reference with g_rc_box_acquire() to keep them.
+ */
+static Extents *
+pango_layout_get_line_extents (PangoLayout *layout,
+                               int         *layout_width)
 {
-  if (layout->lines)
+  pango_layout_check_lines (layout);
+
+  if (!layout->line_extents)
     {
-      GSList *tmp_list = layout->lines;
-      while (tmp_list)
+      if (layout->width == -1)
         {
-          PangoLayoutLine *line = tmp_list->data;
-          tmp_list = tmp_list->next;
+          PangoRectangle logical_rect;
 
-          line->layout = NULL;
-          pango_layout_line_unref (line);
+          pango_layout_get_extents_internal (layout, NULL, &logical_rect, &layout->line_extents);
+          layout->line_extents_width = logical_rect.width;
+        }
+      else
+        {
+          pango_layout_get_extents_internal (layout, NULL, NULL, &layout->line_extents);
+          layout->line_extents_width = layout->width;
         }
-
-      g_slist_free (layout->lines);
-      layout->lines = NULL;
-      layout->line_count = 0;
     }
 
-  layout->unknown_glyphs_count = -1;
-  layout->logical_rect_cached = FALSE;
-  layout->ink_rect_cached = FALSE;
-  layout->is_ellipsized = FALSE;
-  layout->is_wrapped = FALSE;
+  if (layout_width)
+    *layout_width = layout->line_extents_width;
+
+  return layout->line_extents;
 }
 
-static void
-pango_layout_line_leaked (PangoLayoutLine *line)
+/* Returns how far the ink or background of any line reaches
+ * beyond the top and bottom of its logical extents. This bounds how
+ * far a line can draw outside its own extents, so lines that
+ * are far enough from a clip area can be skipped without
+ * looking at their ink.
+ */
+void
+_pango_layout_get_ink_overhang (PangoLayout *layout,
+                                int         *above,
+                                int         *below)
 {
-  PangoLayoutLinePrivate *private = (PangoLayoutLinePrivate *)line;
+  if (!layout->ink_overhang_cached)
+    {
+      Extents *extents;
+      GSList *l;
+      int i;
 
-  private->cache_status = LEAKED;
+      extents = pango_layout_get_line_extents (layout, NULL);
 
-  if (line->layout)
-    {
-      line->layout->logical_rect_cached = FALSE;
-      line->layout->ink_rect_cached = FALSE;
-    }
-}
+      layout->ink_overhang_above = 0;
+      layout->ink_overhang_below = 0;
 
-
-/*****************
- * Line Breaking *
- *****************/
+      for (l = layout->lines, i = 0; l; l = l->next, i++)
+        {
+          const Extents *ext = &extents[i];
+          PangoRectangle ink, logical;
+          int top, bottom;
 
-static void shape_tab (PangoLayoutLine  *line,
-                       LastTabState     *tab_state,
-                       ItemProperties   *properties,
-                       int               current_width,
-                       PangoItem        *item,
-                       PangoGlyphString *glyphs);
+          /* Backgrounds are drawn over the logical extents of the line
+           * itself, which can differ from the ones in the layout
+           */
+          pango_layout_line_get_extents (l->data, &ink, &logical);
 
-static void
+          top = logical.y;
+          bottom = logical.y + logical.height;
+          if (ink.width != 0 && ink.height != 0)
+            {
+              top = MIN (top, ink.y);
+              bottom = MAX (bottom, ink.y + ink.height);
+            }
+
+          layout->ink_overhang_above = MAX (layout->ink_overhang_above,
+                                            ext->logical_rect.y - (ext->baseline + top));
+          layout->ink_overhang_below = MAX (layout->ink_overhang_below,
+                                            (ext->baseline + bottom) -
+                                            (ext->logical_rect.y + ext->logical_rect.height));
+        }
+
+      layout->ink_overhang_cached = TRUE;
+    }
+
+  *above = layout->ink_overhang_above;
+  *below = layout->ink_overhang_below;
+}
+
+/**
+ * pango_layout_measure:
+ * @layout: a `PangoLayout`
+ * @width: (out) (optional): location to store the logical width
+ * @height: (out) (optional): location to store the logical height
+ * @line_count: (out) (optional): location to store the number of lines
+ * @baseline: (out) (optional): location to store the baseline of
+ *   the first line, from the top of @layout
+ *
+ * Measures @layout without keeping its lines.
+ *
+ * This gives the same results as [method@Pango.Layout.get_size],
+ * [method@Pango.Layout.get_line_count] and [method@Pango.Layout.get_baseline],
+ * taking the width, wrap and ellipsize settings of @layout into
+ * account. But each line is thrown away as soon as it has been
+ * measured, and lines are not reordered or justified. This makes
+ * it a cheaper way to find the size of many texts, such as when
+ * sizing table columns by setting the text of a single layout to
+ * each cell in turn.
+ *
+ * Justification is not applied, so a justified layout can measure
+ * narrower than [method@Pango.Layout.get_size] reports.
+ *
+ * Apart from the logical attributes of the text, nothing is kept
+ * on @layout to speed up later layouts of the same text.
+ *
+ * If @layout already has its lines, they are used instead.
+ *
+ * All values except @line_count are in Pango units.
+ *
+ * Since: 1.56
+ */
+void
+pango_layout_measure (PangoLayout *layout,
+                      int         *width,
+                      int         *height,
+                      int         *line_count,
+                      int         *baseline)
+{
+  LayoutMeasure measure = { 0, };
+
+  g_return_if_fail (PANGO_IS_LAYOUT (layout));
+
+  check_context_changed (layout);
+
+  if (layout->lines)
+    {
+      PangoRectangle logical;
+
+      pango_layout_get_extents_internal (layout, NULL, &logical, NULL);
+
+      if (width)
+        *width = logical.width;
+      if (height)
+        *height = logical.height;
+      if (line_count)
+        *line_count = layout->line_count;
+      if (baseline)
+        *baseline = pango_layout_get_baseline (layout);
+
+      return;
+    }
+
+  pango_layout_fill_lines (layout, &measure);
+
+  if (width)
+    *width = measure.logical_rect.width;
+  if (height)
+    *height = measure.logical_rect.height;
+  if (line_count)
+    *line_count = measure.line_count;
+  if (baseline)
+    *baseline = measure.first_baseline;
+}
+
+static void
+pango_layout_clear_lines (PangoLayout *layout)
+{
+  if (layout->lines)
+    {
+      GSList *tmp_list = layout->lines;
+      while (tmp_list)
+        {
+          PangoLayoutLine *line = tmp_list->data;
+          tmp_list = tmp_list->next;
+
+          line->layout = NULL;
+          pango_layout_line_unref (line);
+        }
+
+      g_slist_free (layout->lines);
+      layout->lines = NULL;
+      layout->line_count = 0;
+    }
+
+  layout->unknown_glyphs_count = -1;
+  layout->logical_rect_cached = FALSE;
+  layout->ink_rect_cached = FALSE;
+  layout->is_ellipsized = FALSE;
+  layout->is_wrapped = FALSE;
+  layout->ink_overhang_cached = FALSE;
+  g_clear_pointer (&layout->line_extents, g_rc_box_release);
+}
+
+/* Drops the itemization and shaping results that
+ * are kept across width changes
+ */
+static void
+pango_layout_clear_reusable (PangoLayout *layout)
+{
+  g_clear_pointer (&layout->paragraph_items, g_ptr_array_unref);
+  g_clear_pointer (&layout->shaped_items, g_hash_table_unref);
+  g_clear_pointer (&layout->ellipsize_plans, g_hash_table_unref);
+}
+
+static void
+pango_layout_line_leaked (PangoLayoutLine *line)
+{
+  PangoLayoutLinePrivate *private = (PangoLayoutLinePrivate *)line;
+
+  private->cache_status = LEAKED;
+  g_clear_pointer (&private->hit_index, line_hit_index_free);
+
+  if (line->layout)
+    {
+      line->layout->logical_rect_cached = FALSE;
+      line->layout->ink_rect_cached = FALSE;
+      line->layout->ink_overhang_cached = FALSE;
+      g_clear_pointer (&line->layout->line_extents, g_rc_box_release);
+    }
+}
+
+
+/*****************
+ * Line Breaking *
+ *****************/
+
+static void shape_tab (PangoLayoutLine  *line,
+                       LastTabState     *tab_state,
+                       ItemProperties   *properties,
+                       int               current_width,
+                       PangoItem        *item,
+                       PangoGlyphString *glyphs);
+
+/* The number of subpixel positions that glyph positions are
+ * quantized to, 0 if they are rounded or left alone
+ */
+static int
+get_subpixel_positions (PangoLayout *layout)
+{
+  if (pango_context_get_round_glyph_positions (layout->context))
+    return 0;
+
+  return pango_context_get_subpixel_positions (layout->context);
+}
+
+static PangoShapeFlags
+get_shape_flags (PangoLayout *layout)
+{
+  if (pango_context_get_round_glyph_positions (layout->context))
+    return PANGO_SHAPE_ROUND_POSITIONS;
+
+  return PANGO_SHAPE_NONE;
+}
+
+/* Letter spacing is split in halves around each cluster, so
+ * quantize the halves to keep glyph positions on the grid.
+ * The grid is in device units of the font of @item, like the
+ * one the glyph positions were quantized to when shaping
+ */
+static int
+quantize_letter_spacing (PangoLayout *layout,
+                         PangoItem   *item,
+                         int          letter_spacing)
+{
+  int n_positions = get_subpixel_positions (layout);
+
+  if (n_positions == 0)
+    return letter_spacing;
+
+  return 2 * pango_analysis_quantize_width (&item->analysis, letter_spacing / 2, n_positions);
+}
+
+static void
 free_run (PangoLayoutRun *run, gpointer data)
 {
   gboolean free_item = data != NULL;
@@ -3325,10 +3927,7 @@ ensure_tab_width (PangoLayout *layout)
       PangoAttrList tmp_attrs;
       PangoFontDescription *font_desc = pango_font_description_copy_static (pango_context_get_font_description (layout->context));
       PangoLanguage *language = NULL;
-      PangoShapeFlags shape_flags = PANGO_SHAPE_NONE;
-
-      if (pango_context_get_round_glyph_positions (layout->context))
-        shape_flags |= PANGO_SHAPE_ROUND_POSITIONS;
+      PangoShapeFlags shape_flags = get_shape_flags (layout);
 
       layout_attrs = pango_layout_get_effective_attributes (layout);
       if (layout_attrs)
@@ -3362,7 +3961,8 @@ ensure_tab_width (PangoLayout *layout)
       _pango_attr_list_destroy (&tmp_attrs);
 
       item = items->data;
-      pango_shape_with_flags ("        ", 8, "        ", 8, &item->analysis, glyphs, shape_flags);
+      pango_shape_internal ("        ", 8, "        ", 8, &item->analysis, NULL, 0,
+                            glyphs, shape_flags, get_subpixel_positions (layout));
 
       pango_item_free (item);
       g_list_free (items);
@@ -3598,11 +4198,21 @@ typedef enum
   BREAK_LINE_SEPARATOR
 } BreakResult;
 
+typedef struct
+{
+  PangoItem *item;
+  int offset;
+  int length;
+  guint8 flags;
+  PangoGlyphString *glyphs;
+} PreshapedItem;
+
 struct _ParaBreakState
 {
   /* maintained per layout */
   int line_height;              /* Estimate of height of current line; < 0 is no estimate */
   int remaining_height;         /* Remaining height of the layout;  only defined if layout->height >= 0 */
+  LayoutMeasure *measure;       /* Where to add up the lines if we are only measuring */
 
   /* maintained per paragraph */
   PangoAttrList *attrs;         /* Attributes being used for itemization */
@@ -3617,6 +4227,8 @@ struct _ParaBreakState
   int num_log_widths;           /* Length of log_widths */
   int log_widths_offset;        /* Offset into log_widths to the point corresponding
                                  * to the remaining portion of the first item */
+  GList *preshaped;             /* PreshapedItem for upcoming items in state->items,
+                                 * when shaping compatible items together */
 
   int line_start_index;         /* Start index (byte offset) of line in layout->text */
   int line_start_offset;        /* Character offset of line in layout->text */
@@ -3649,51 +4261,472 @@ get_decimal_prefix_width (PangoItem        *item,
   int i;
   const char *p;
 
-  log_widths = g_new (int, item->num_chars);
+  log_widths = g_new (int, item->num_chars);
+
+  pango_glyph_item_get_logical_widths (&glyph_item, text, log_widths);
+
+  *width = 0;
+  *found = FALSE;
+
+  for (i = 0, p = text + item->offset; i < item->num_chars; i++, p = g_utf8_next_char (p))
+    {
+      if (g_utf8_get_char (p) == decimal)
+        {
+          *width += log_widths[i] / 2;
+          *found = TRUE;
+          break;
+        }
+
+      *width += log_widths[i];
+    }
+
+  g_free (log_widths);
+}
+
+static int
+line_width (ParaBreakState  *state,
+            PangoLayoutLine *line)
+{
+  GSList *l;
+  int i;
+  int width = 0;
+
+  if (state->remaining_width > -1)
+    return state->line_width - state->remaining_width;
+
+  /* Compute the width of the line currently - inefficient, but easier
+   * than keeping the current width of the line up to date everywhere
+   */
+  for (l = line->runs; l; l = l->next)
+    {
+      PangoLayoutRun *run = l->data;
+
+      for (i = 0; i < run->glyphs->num_glyphs; i++)
+        width += run->glyphs->glyphs[i].geometry.width;
+    }
+
+  return width;
+}
+
+/* When merge-shaping is enabled on the context, runs of consecutive
+ * items that only differ in attributes that don't matter for shaping
+ * are shaped with a single call, and the result is sliced back into
+ * per-item glyph strings that are kept in state->preshaped until
+ * shape_run() asks for them.
+ */
+
+static void
+preshaped_item_free (gpointer data)
+{
+  PreshapedItem *preshaped = data;
+
+  pango_glyph_string_free (preshaped->glyphs);
+  g_free (preshaped);
+}
+
+static void
+clear_preshaped (ParaBreakState *state)
+{
+  g_list_free_full (state->preshaped, preshaped_item_free);
+  state->preshaped = NULL;
+}
+
+static gboolean
+preshaped_item_matches (PreshapedItem *preshaped,
+                        PangoItem     *item)
+{
+  return preshaped->item == item &&
+         preshaped->offset == item->offset &&
+         preshaped->length == item->length &&
+         preshaped->flags == item->analysis.flags;
+}
+
+static gboolean
+affects_shaping (PangoAttribute *attr)
+{
+  switch ((int)attr->klass->type)
+    {
+    case PANGO_ATTR_FONT_FEATURES:
+    case PANGO_ATTR_SHOW:
+    case PANGO_ATTR_TEXT_TRANSFORM:
+    case PANGO_ATTR_LETTER_SPACING:
+    case PANGO_ATTR_SHAPE:
+      return TRUE;
+    default:
+      return FALSE;
+    }
+}
+
+static gboolean
+attr_slist_contains_shaping_attr (GSList         *list,
+                                  PangoAttribute *attr)
+{
+  GSList *l;
+
+  for (l = list; l; l = l->next)
+    {
+      PangoAttribute *other = l->data;
+
+      if (other->klass->type == attr->klass->type &&
+          pango_attribute_equal (other, attr))
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static gboolean
+shaping_attrs_equal (GSList *list1,
+                     GSList *list2)
+{
+  GSList *l;
+
+  for (l = list1; l; l = l->next)
+    {
+      PangoAttribute *attr = l->data;
+
+      if (affects_shaping (attr) &&
+          !attr_slist_contains_shaping_attr (list2, attr))
+        return FALSE;
+    }
+
+  for (l = list2; l; l = l->next)
+    {
+      PangoAttribute *attr = l->data;
+
+      if (affects_shaping (attr) &&
+          !attr_slist_contains_shaping_attr (list1, attr))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static gboolean
+can_shape_separately_only (PangoLayout *layout,
+                           PangoItem   *item)
+{
+  gunichar wc;
+  GSList *l;
+
+  if (item->analysis.flags & PANGO_ANALYSIS_FLAG_NEED_HYPHEN)
+    return TRUE;
+
+  /* Tabs and line separators are handled specially */
+  wc = g_utf8_get_char (layout->text + item->offset);
+  if (wc == '\t' || wc == 0x2028)
+    return TRUE;
+
+  for (l = item->analysis.extra_attrs; l; l = l->next)
+    {
+      PangoAttribute *attr = l->data;
+
+      if (attr->klass->type == PANGO_ATTR_SHAPE)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static gboolean
+items_can_shape_together (PangoLayout *layout,
+                          PangoItem   *item1,
+                          PangoItem   *item2)
+{
+  if (item1->offset + item1->length != item2->offset)
+    return FALSE;
+
+  if (can_shape_separately_only (layout, item2))
+    return FALSE;
+
+  if (item1->analysis.font != item2->analysis.font ||
+      item1->analysis.level != item2->analysis.level ||
+      item1->analysis.gravity != item2->analysis.gravity ||
+      item1->analysis.flags != item2->analysis.flags ||
+      item1->analysis.script != item2->analysis.script ||
+      item1->analysis.language != item2->analysis.language)
+    return FALSE;
+
+  return shaping_attrs_equal (item1->analysis.extra_attrs,
+                              item2->analysis.extra_attrs);
+}
+
+/* Slice @glyphs, which were obtained by shaping @n_items items
+ * starting at byte offset @offset together, back into per-item
+ * glyph strings. Returns FALSE if a cluster straddles an item
+ * boundary, in which case the items need to be shaped separately.
+ */
+static gboolean
+split_preshaped_glyphs (PangoGlyphString  *glyphs,
+                        gboolean           rtl,
+                        PangoItem        **items,
+                        int                n_items,
+                        int                offset,
+                        PangoGlyphString **item_glyphs)
+{
+  int *first;
+  int *count;
+  int i, k;
+  int start, end;
+  gboolean ok = TRUE;
+
+  first = g_new (int, n_items);
+  count = g_new0 (int, n_items);
+
+  k = 0;
+  start = items[0]->offset - offset;
+  end = start + items[0]->length;
+
+  /* Walk the glyphs in logical order. Clusters are monotonic, so
+   * the glyphs for each item are contiguous.
+   */
+  for (i = 0; i < glyphs->num_glyphs && ok; i++)
+    {
+      int j = rtl ? glyphs->num_glyphs - 1 - i : i;
+      int cluster = glyphs->log_clusters[j];
+
+      while (cluster >= end)
+        {
+          if (count[k] == 0 || k + 1 == n_items)
+            {
+              ok = FALSE;
+              break;
+            }
+
+          k++;
+          start = items[k]->offset - offset;
+          end = start + items[k]->length;
+        }
+
+      if (!ok)
+        break;
+
+      if (count[k] == 0)
+        {
+          if (cluster != start)
+            {
+              ok = FALSE;
+              break;
+            }
+          first[k] = j;
+        }
+      else if (rtl)
+        first[k] = j;
+
+      count[k]++;
+    }
+
+  if (ok && (k + 1 != n_items || count[k] == 0))
+    ok = FALSE;
+
+  if (ok)
+    {
+      for (k = 0; k < n_items; k++)
+        {
+          start = items[k]->offset - offset;
+
+          item_glyphs[k] = pango_glyph_string_new ();
+          pango_glyph_string_set_size (item_glyphs[k], count[k]);
+
+          memcpy (item_glyphs[k]->glyphs, glyphs->glyphs + first[k], count[k] * sizeof (PangoGlyphInfo));
+          for (i = 0; i < count[k]; i++)
+            item_glyphs[k]->log_clusters[i] = glyphs->log_clusters[first[k] + i] - start;
+        }
+    }
+
+  g_free (first);
+  g_free (count);
+
+  return ok;
+}
+
+/* Shape the run of compatible items at the start of state->items
+ * together, and keep the results in state->preshaped.
+ */
+static void
+preshape_items (PangoLayout    *layout,
+                ParaBreakState *state)
+{
+  PangoItem *first_item = state->items->data;
+  PangoItem merged;
+  PangoItem **items;
+  PangoGlyphString **item_glyphs;
+  PangoGlyphString *glyphs;
+  PangoShapeFlags shape_flags;
+  GList *l;
+  int n_items;
+  int k;
+
+  if (can_shape_separately_only (layout, first_item))
+    return;
+
+  merged = *first_item;
+
+  n_items = 1;
+  for (l = state->items; l->next; l = l->next)
+    {
+      PangoItem *next = l->next->data;
+
+      if (!items_can_shape_together (layout, l->data, next))
+        break;
+
+      merged.length += next->length;
+      merged.num_chars += next->num_chars;
+      n_items++;
+    }
+
+  if (n_items == 1)
+    return;
+
+  items = g_new (PangoItem *, n_items);
+  for (l = state->items, k = 0; k < n_items; l = l->next, k++)
+    items[k] = l->data;
+
+  shape_flags = get_shape_flags (layout);
+
+  glyphs = pango_glyph_string_new ();
+  pango_shape_internal (layout->text + merged.offset, merged.length,
+                        layout->text, layout->length,
+                        &merged.analysis,
+                        layout->log_attrs + state->start_offset, merged.num_chars,
+                        glyphs,
+                        shape_flags, get_subpixel_positions (layout));
+
+  item_glyphs = g_new (PangoGlyphString *, n_items);
+
+  if (split_preshaped_glyphs (glyphs, merged.analysis.level % 2,
+                              items, n_items, merged.offset,
+                              item_glyphs))
+    {
+      for (k = n_items - 1; k >= 0; k--)
+        {
+          PreshapedItem *preshaped = g_new (PreshapedItem, 1);
+
+          preshaped->item = items[k];
+          preshaped->offset = items[k]->offset;
+          preshaped->length = items[k]->length;
+          preshaped->flags = items[k]->analysis.flags;
+          preshaped->glyphs = item_glyphs[k];
+
+          state->preshaped = g_list_prepend (state->preshaped, preshaped);
+        }
+    }
+
+  pango_glyph_string_free (glyphs);
+  g_free (item_glyphs);
+  g_free (items);
+}
+
+/* Called when we start processing a new item. Drops results for
+ * items we've moved past, and shapes the next run of compatible
+ * items if needed.
+ */
+static void
+update_preshaped (PangoLayout    *layout,
+                  ParaBreakState *state)
+{
+  PangoItem *item = state->items->data;
+
+  while (state->preshaped &&
+         !preshaped_item_matches (state->preshaped->data, item))
+    {
+      preshaped_item_free (state->preshaped->data);
+      state->preshaped = g_list_delete_link (state->preshaped, state->preshaped);
+    }
+
+  if (!state->preshaped && pango_context_get_merge_shaping (layout->context))
+    preshape_items (layout, state);
+}
+
+static gboolean
+get_preshaped_glyphs (ParaBreakState   *state,
+                      PangoItem        *item,
+                      PangoGlyphString *glyphs)
+{
+  PreshapedItem *preshaped;
+
+  if (!state->preshaped)
+    return FALSE;
+
+  preshaped = state->preshaped->data;
+  if (!preshaped_item_matches (preshaped, item))
+    return FALSE;
+
+  pango_glyph_string_set_size (glyphs, preshaped->glyphs->num_glyphs);
+  memcpy (glyphs->glyphs, preshaped->glyphs->glyphs,
+          preshaped->glyphs->num_glyphs * sizeof (PangoGlyphInfo));
+  memcpy (glyphs->log_clusters, preshaped->glyphs->log_clusters,
+          preshaped->glyphs->num_glyphs * sizeof (int));
+
+  return TRUE;
+}
+
+/* Shaping a whole item gives the same glyphs at any width,
+ * so we keep them in layout->shaped_items. Only the pieces
+ * of items that get broken across lines are shaped again.
+ */
+typedef struct _ShapedItem ShapedItem;
+
+struct _ShapedItem
+{
+  int length;
+  guint8 flags;
+  PangoGlyphString *glyphs;	/* NULL until shaped */
+};
+
+static void
+shaped_item_free (gpointer data)
+{
+  ShapedItem *shaped = data;
 
-  pango_glyph_item_get_logical_widths (&glyph_item, text, log_widths);
+  if (shaped->glyphs)
+    pango_glyph_string_free (shaped->glyphs);
+  g_free (shaped);
+}
 
-  *width = 0;
-  *found = FALSE;
+static void
+register_shaped_items (PangoLayout *layout,
+                       GList       *items)
+{
+  GList *l;
 
-  for (i = 0, p = text + item->offset; i < item->num_chars; i++, p = g_utf8_next_char (p))
+  if (!layout->shaped_items)
+    layout->shaped_items = g_hash_table_new_full (NULL, NULL, NULL, shaped_item_free);
+
+  for (l = items; l; l = l->next)
     {
-      if (g_utf8_get_char (p) == decimal)
-        {
-          *width += log_widths[i] / 2;
-          *found = TRUE;
-          break;
-        }
+      PangoItem *item = l->data;
+      ShapedItem *shaped;
 
-      *width += log_widths[i];
-    }
+      if (layout->text[item->offset] == '\t')
+        continue;
 
-  g_free (log_widths);
+      shaped = g_new (ShapedItem, 1);
+      shaped->length = item->length;
+      shaped->flags = item->analysis.flags;
+      shaped->glyphs = NULL;
+
+      g_hash_table_replace (layout->shaped_items, GINT_TO_POINTER (item->offset), shaped);
+    }
 }
 
-static int
-line_width (ParaBreakState  *state,
-            PangoLayoutLine *line)
+/* Returns the ShapedItem for @item if it is a whole item */
+static ShapedItem *
+find_shaped_item (PangoLayout *layout,
+                  PangoItem   *item)
 {
-  GSList *l;
-  int i;
-  int width = 0;
+  ShapedItem *shaped;
 
-  if (state->remaining_width > -1)
-    return state->line_width - state->remaining_width;
-
-  /* Compute the width of the line currently - inefficient, but easier
-   * than keeping the current width of the line up to date everywhere
-   */
-  for (l = line->runs; l; l = l->next)
-    {
-      PangoLayoutRun *run = l->data;
+  if (!layout->shaped_items)
+    return NULL;
 
-      for (i = 0; i < run->glyphs->num_glyphs; i++)
-        width += run->glyphs->glyphs[i].geometry.width;
-    }
+  shaped = g_hash_table_lookup (layout->shaped_items, GINT_TO_POINTER (item->offset));
+  if (!shaped ||
+      shaped->length != item->length ||
+      shaped->flags != item->analysis.flags)
+    return NULL;
 
-  return width;
+  return shaped;
 }
 
 static PangoGlyphString *
@@ -3708,40 +4741,56 @@ shape_run (PangoLayoutLine *line,
     shape_tab (line, &state->last_tab, &state->properties, line_width (state, line), item, glyphs);
   else
     {
-      PangoShapeFlags shape_flags = PANGO_SHAPE_NONE;
-
-      if (pango_context_get_round_glyph_positions (layout->context))
-        shape_flags |= PANGO_SHAPE_ROUND_POSITIONS;
+      PangoShapeFlags shape_flags = get_shape_flags (layout);
+      ShapedItem *shaped = find_shaped_item (layout, item);
 
-      if (state->properties.shape_set)
-        _pango_shape_shape (layout->text + item->offset, item->num_chars,
-                            state->properties.shape_ink_rect, state->properties.shape_logical_rect,
-                            glyphs);
+      if (shaped && shaped->glyphs)
+        {
+          pango_glyph_string_set_size (glyphs, shaped->glyphs->num_glyphs);
+          memcpy (glyphs->glyphs, shaped->glyphs->glyphs,
+                  shaped->glyphs->num_glyphs * sizeof (PangoGlyphInfo));
+          memcpy (glyphs->log_clusters, shaped->glyphs->log_clusters,
+                  shaped->glyphs->num_glyphs * sizeof (int));
+        }
       else
-        pango_shape_item (item,
-                          layout->text, layout->length,
-                          layout->log_attrs + state->start_offset,
-                          glyphs,
-                          shape_flags);
-
-      if (state->properties.letter_spacing)
         {
-          PangoGlyphItem glyph_item;
-          int space_left, space_right;
+          if (state->properties.shape_set)
+            _pango_shape_shape (layout->text + item->offset, item->num_chars,
+                                state->properties.shape_ink_rect, state->properties.shape_logical_rect,
+                                glyphs);
+          else if (!get_preshaped_glyphs (state, item, glyphs))
+            pango_shape_internal (layout->text + item->offset, item->length,
+                                  layout->text, layout->length,
+                                  &item->analysis,
+                                  layout->log_attrs + state->start_offset, item->num_chars,
+                                  glyphs,
+                                  shape_flags, get_subpixel_positions (layout));
+
+          if (state->properties.letter_spacing)
+            {
+              PangoGlyphItem glyph_item;
+              int letter_spacing;
+              int space_left, space_right;
+
+              letter_spacing = quantize_letter_spacing (layout, item, state->properties.letter_spacing);
 
-          glyph_item.item = item;
-          glyph_item.glyphs = glyphs;
+              glyph_item.item = item;
+              glyph_item.glyphs = glyphs;
+
+              pango_glyph_item_letter_space (&glyph_item,
+                                             layout->text,
+                                             layout->log_attrs + state->start_offset,
+                                             letter_spacing);
 
-          pango_glyph_item_letter_space (&glyph_item,
-                                         layout->text,
-                                         layout->log_attrs + state->start_offset,
-                                         state->properties.letter_spacing);
+              distribute_letter_spacing (letter_spacing, &space_left, &space_right);
 
-          distribute_letter_spacing (state->properties.letter_spacing, &space_left, &space_right);
+              glyphs->glyphs[0].geometry.width += space_left;
+              glyphs->glyphs[0].geometry.x_offset += space_left;
+              glyphs->glyphs[glyphs->num_glyphs - 1].geometry.width += space_right;
+            }
 
-          glyphs->glyphs[0].geometry.width += space_left;
-          glyphs->glyphs[0].geometry.x_offset += space_left;
-          glyphs->glyphs[glyphs->num_glyphs - 1].geometry.width += space_right;
+          if (shaped)
+            shaped->glyphs = pango_glyph_string_copy (glyphs);
         }
 
       if (state->last_tab.glyphs != NULL)
@@ -4046,7 +5095,11 @@ process_item (PangoLayout     *layout,
    */
   if (!state->glyphs)
     {
+      ShapedItem *shaped = find_shaped_item (layout, item);
+
       pango_layout_get_item_properties (item, &state->properties);
+      if (!shaped || !shaped->glyphs)
+        update_preshaped (layout, state);
       state->glyphs = shape_run (line, state, item);
       state->log_widths_offset = 0;
       processing_new_item = TRUE;
@@ -4438,12 +5491,90 @@ should_ellipsize_current_line (PangoLayout    *layout,
     }
 }
 
+/* Adds the extents of @line to @measure, the same way
+ * as pango_layout_get_extents_internal() does
+ */
+static void
+measure_line (PangoLayout     *layout,
+              PangoLayoutLine *line,
+              LayoutMeasure   *measure,
+              int             *line_height)
+{
+  PangoRectangle logical;
+  int height;
+  int x_offset = 0;
+  int baseline;
+
+  pango_layout_line_get_extents_and_height (line, NULL, &logical, &height);
+
+  if (measure->line_count == 0 || layout->line_spacing == 0.0)
+    baseline = measure->y_offset - logical.y;
+  else
+    baseline = measure->baseline + layout->line_spacing * height;
+
+  if (layout->width == -1)
+    {
+      measure->logical_rect.width = MAX (measure->logical_rect.width, logical.width);
+    }
+  else
+    {
+      get_x_offset (layout, line, layout->width, logical.width, &x_offset);
+      logical.x += x_offset;
+
+      if (measure->line_count == 0)
+        {
+          measure->logical_rect.x = logical.x;
+          measure->logical_rect.width = logical.width;
+        }
+      else
+        {
+          int new_pos = MIN (measure->logical_rect.x, logical.x);
+          measure->logical_rect.width =
+            MAX (measure->logical_rect.x + measure->logical_rect.width,
+                 logical.x + logical.width) - new_pos;
+          measure->logical_rect.x = new_pos;
+        }
+    }
+
+  logical.y += baseline;
+  measure->logical_rect.height = logical.y + logical.height;
+
+  if (measure->line_count == 0)
+    measure->first_baseline = baseline;
+
+  measure->baseline = baseline;
+  measure->y_offset = logical.y + logical.height + layout->spacing;
+  measure->line_count++;
+
+  *line_height = logical.height;
+}
+
+/* Adds @line to the layout, which takes over the reference to it.
+ * When measuring, the line is only measured, and the caller still
+ * has to free it.
+ */
 static void
 add_line (PangoLayoutLine *line,
           ParaBreakState  *state)
 {
   PangoLayout *layout = line->layout;
 
+  if (state->measure)
+    {
+      int height;
+
+      measure_line (layout, line, state->measure, &height);
+
+      if (layout->height >= 0)
+        {
+          state->remaining_height -= height;
+          state->remaining_height -= layout->spacing;
+          state->line_height = height;
+        }
+
+      return;
+    }
+
   /* we prepend, then reverse the list later */
   layout->lines = g_slist_prepend (layout->lines, line);
   layout->line_count++;
@@ -4595,6 +5726,29 @@ process_line (PangoLayout    *layout,
   state->line_of_par++;
   state->line_start_index += line->length;
   state->line_start_offset = state->start_offset;
+
+  if (state->measure)
+    pango_layout_line_unref (line);
+}
+
+/* Sentence attributes tailor the default sentence boundaries,
+ * so those can't be filled in later for layouts that have them
+ */
+static gboolean
+has_sentence_attributes (PangoAttrList *attrs)
+{
+  if (!attrs || !attrs->attributes)
+    return FALSE;
+
+  for (guint i = 0; i < attrs->attributes->len; i++)
+    {
+      PangoAttribute *attr = g_ptr_array_index (attrs->attributes, i);
+
+      if (attr->klass->type == PANGO_ATTR_SENTENCE)
+        return TRUE;
+    }
+
+  return FALSE;
 }
 
 static void
@@ -4603,30 +5757,29 @@ get_items_log_attrs (const char    *text,
                      int            length,
                      GList         *items,
                      PangoAttrList *attrs,
+                     gboolean       with_sentences,
                      PangoLogAttr  *log_attrs,
                      int            log_attrs_len)
 {
-  int offset = 0;
   GList *l;
 
-  pango_default_break (text + start, length, NULL, log_attrs, log_attrs_len);
+  /* Sentence boundaries are not needed for line breaking,
+   * see pango_layout_ensure_sentence_attrs()
+   */
+  if (with_sentences)
+    pango_default_break (text + start, length, NULL, log_attrs, log_attrs_len);
+  else
+    _pango_default_break_without_sentences (text + start, length, log_attrs, log_attrs_len);
 
   for (l = items; l; l = l->next)
     {
       PangoItem *item = l->data;
       g_assert (item->offset <= start + length);
       g_assert (item->length <= (start + length) - item->offset);
-
-      pango_tailor_break (text + item->offset,
-                          item->length,
-                          &item->analysis,
-                          -1,
-                          log_attrs + offset,
-                          item->num_chars + 1);
-
-      offset += item->num_chars;
     }
 
+  _pango_tailor_break_items (text, items, log_attrs, log_attrs_len);
+
   if (attrs && items)
     {
       PangoItem *item = items->data;
@@ -4778,8 +5931,29 @@ apply_attributes_to_runs (PangoLayout   *layout,
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wdeprecated-declarations"
 
+static void
+free_items (gpointer data)
+{
+  g_list_free_full (data, (GDestroyNotify) pango_item_free);
+}
+
 static void
 pango_layout_check_lines (PangoLayout *layout)
+{
+  check_context_changed (layout);
+
+  if (G_LIKELY (layout->lines))
+    return;
+
+  pango_layout_fill_lines (layout, NULL);
+}
+
+/* Breaks the text into lines. If @measure is not %NULL, the
+ * lines are only added up in it, instead of being kept
+ */
+static void
+pango_layout_fill_lines (PangoLayout   *layout,
+                         LayoutMeasure *measure)
 {
   const char *start;
   gboolean done = FALSE;
@@ -4792,11 +5966,7 @@ pango_layout_check_lines (PangoLayout *layout)
   PangoDirection base_dir = PANGO_DIRECTION_NEUTRAL;
   ParaBreakState state;
   gboolean need_log_attrs;
-
-  check_context_changed (layout);
-
-  if (G_LIKELY (layout->lines))
-    return;
+  guint paragraph;
 
   /* For simplicity, we make sure at this point that layout->text
    * is non-NULL even if it is zero length
@@ -4811,7 +5981,13 @@ pango_layout_check_lines (PangoLayout *layout)
       itemize_attrs = pango_attr_list_filter (attrs, affects_itemization, NULL);
 
       if (itemize_attrs)
-        _pango_attr_list_get_iterator (itemize_attrs, &iter);
+        {
+          /* Adjacent spans with the same value would otherwise
+           * split items for no reason.
+           */
+          _pango_attr_list_coalesce (itemize_attrs);
+          _pango_attr_list_get_iterator (itemize_attrs, &iter);
+        }
     }
   else
     {
@@ -4822,6 +5998,7 @@ pango_layout_check_lines (PangoLayout *layout)
   if (!layout->log_attrs)
     {
       layout->log_attrs = g_new0 (PangoLogAttr, layout->n_chars + 1);
+      layout->have_sentence_attrs = has_sentence_attributes (shape_attrs);
       need_log_attrs = TRUE;
     }
   else
@@ -4842,6 +6019,8 @@ pango_layout_check_lines (PangoLayout *layout)
   else
     base_dir = pango_context_get_base_dir (layout->context);
 
+  state.measure = measure;
+
   /* these are only used if layout->height >= 0 */
   state.remaining_height = layout->height;
   state.line_height = -1;
@@ -4853,10 +6032,14 @@ pango_layout_check_lines (PangoLayout *layout)
       state.line_height = layout->line_spacing == 0.0 ? logical.height : layout->line_spacing * height;
     }
 
-  state.log_widths = NULL;
-  state.num_log_widths = 0;
+  state.log_widths = layout->log_widths;
+  state.num_log_widths = layout->n_log_widths;
   state.baseline_shifts = NULL;
 
+  if (!layout->paragraph_items)
+    layout->paragraph_items = g_ptr_array_new_with_free_func (free_items);
+  paragraph = 0;
+
   DEBUG1 ("START layout");
   do
     {
@@ -4903,30 +6086,56 @@ pango_layout_check_lines (PangoLayout *layout)
       g_assert (delim_len >= 0);
 
       state.attrs = itemize_attrs;
-      state.items = pango_itemize_with_font (layout->context,
-                                             base_dir,
-                                             layout->text,
-                                             start - layout->text,
-                                             end - start,
-                                             itemize_attrs,
-                                             itemize_attrs ? &iter : NULL,
-                                             NULL);
-
-      apply_attributes_to_items (state.items, shape_attrs);
-
-      if (need_log_attrs)
-        get_items_log_attrs (layout->text,
-                             start - layout->text,
-                             delimiter_index + delim_len,
-                             state.items,
-                             shape_attrs,
-                             layout->log_attrs + start_offset,
-                             layout->n_chars + 1 - start_offset);
-
-      state.items = pango_itemize_post_process_items (layout->context,
-                                                      layout->text,
-                                                      layout->log_attrs,
-                                                      state.items);
+
+      if (!need_log_attrs &&
+          paragraph < layout->paragraph_items->len &&
+          g_ptr_array_index (layout->paragraph_items, paragraph) != NULL)
+        {
+          /* Only the width changed since we itemized this paragraph */
+          state.items = g_list_copy_deep (g_ptr_array_index (layout->paragraph_items, paragraph),
+                                          (GCopyFunc) pango_item_copy, NULL);
+        }
+      else
+        {
+          state.items = pango_itemize_with_font (layout->context,
+                                                 base_dir,
+                                                 layout->text,
+                                                 start - layout->text,
+                                                 end - start,
+                                                 itemize_attrs,
+                                                 itemize_attrs ? &iter : NULL,
+                                                 NULL);
+
+          apply_attributes_to_items (state.items, shape_attrs);
+
+          if (need_log_attrs)
+            get_items_log_attrs (layout->text,
+                                 start - layout->text,
+                                 delimiter_index + delim_len,
+                                 state.items,
+                                 shape_attrs,
+                                 layout->have_sentence_attrs,
+                                 layout->log_attrs + start_offset,
+                                 layout->n_chars + 1 - start_offset);
+
+          state.items = pango_itemize_post_process_items (layout->context,
+                                                          layout->text,
+                                                          layout->log_attrs,
+                                                          state.items);
+
+          /* Measuring usually comes with a new text each time,
+           * so there's no point in keeping the items then
+           */
+          if (!measure)
+            {
+              if (paragraph >= layout->paragraph_items->len)
+                g_ptr_array_set_size (layout->paragraph_items, paragraph + 1);
+              g_ptr_array_index (layout->paragraph_items, paragraph) =
+                  g_list_copy_deep (state.items, (GCopyFunc) pango_item_copy, NULL);
+
+              register_shaped_items (layout, state.items);
+            }
+        }
 
       state.base_dir = base_dir;
       state.line_of_par = 1;
@@ -4942,11 +6151,14 @@ pango_layout_check_lines (PangoLayout *layout)
       state.log_widths_offset = 0;
 
       state.hyphen_width = -1;
+      state.preshaped = NULL;
 
       if (state.items)
         {
           while (state.items)
             process_line (layout, &state);
+
+          clear_preshaped (&state);
         }
       else
         {
@@ -4958,6 +6170,9 @@ pango_layout_check_lines (PangoLayout *layout)
           line_set_resolved_dir (empty_line, base_dir);
 
           add_line (empty_line, &state);
+
+          if (state.measure)
+            pango_layout_line_unref (empty_line);
         }
 
       if (layout->height >= 0 && state.remaining_height < state.line_height)
@@ -4967,14 +6182,19 @@ pango_layout_check_lines (PangoLayout *layout)
         start_offset += pango_utf8_strlen (start, (end - start) + delim_len);
 
       start = end + delim_len;
+      paragraph++;
     }
   while (!done);
 
-  g_free (state.log_widths);
+  layout->log_widths = state.log_widths;
+  layout->n_log_widths = state.num_log_widths;
   g_list_free_full (state.baseline_shifts, g_free);
 
-  apply_attributes_to_runs (layout, attrs);
-  layout->lines = g_slist_reverse (layout->lines);
+  if (!measure)
+    {
+      apply_attributes_to_runs (layout, attrs);
+      layout->lines = g_slist_reverse (layout->lines);
+    }
 
   if (itemize_attrs)
     {
@@ -4985,9 +6205,12 @@ pango_layout_check_lines (PangoLayout *layout)
   pango_attr_list_unref (shape_attrs);
   pango_attr_list_unref (attrs);
 
-  int w, h;
-  pango_layout_get_size (layout, &w, &h);
-  DEBUG1 ("DONE %d %d", w, h);
+  if (!measure)
+    {
+      int w, h;
+      pango_layout_get_size (layout, &w, &h);
+      DEBUG1 ("DONE %d %d", w, h);
+    }
 }
 
 #pragma GCC diagnostic pop
@@ -5038,6 +6261,7 @@ pango_layout_line_unref (PangoLayoutLine *line)
     {
       g_slist_foreach (line->runs, (GFunc)free_run, GINT_TO_POINTER (1));
       g_slist_free (line->runs);
+      line_hit_index_free (private->hit_index);
       g_slice_free (PangoLayoutLinePrivate, private);
     }
 }
@@ -5141,8 +6365,6 @@ pango_layout_line_x_to_index (PangoLayoutLine *line,
                               int             *index,
                               int             *trailing)
 {
-  GSList *tmp_list;
-  gint start_pos = 0;
   gint first_index = 0; /* line->start_index */
   gint first_offset;
   gint last_index;      /* start of last grapheme in line */
@@ -5152,6 +6374,8 @@ pango_layout_line_x_to_index (PangoLayoutLine *line,
   PangoLayout *layout;
   gint last_trailing;
   gboolean suppress_last_trailing;
+  LineHitIndex *hit, *tmp;
+  gboolean inside = FALSE;
 
   g_return_val_if_fail (LINE_IS_VALID (line), FALSE);
 
@@ -5173,10 +6397,12 @@ pango_layout_line_x_to_index (PangoLayoutLine *line,
 
   g_assert (line->length > 0);
 
-  first_offset = g_utf8_pointer_to_offset (layout->text, layout->text + line->start_index);
+  hit = line_get_hit_index (line, &tmp);
+
+  first_offset = hit->start_offset;
 
   end_index = first_index + line->length;
-  end_offset = first_offset + g_utf8_pointer_to_offset (layout->text + first_index, layout->text + end_index);
+  end_offset = hit->end_offset;
 
   last_index = end_index;
   last_offset = end_offset;
@@ -5213,15 +6439,7 @@ pango_layout_line_x_to_index (PangoLayoutLine *line,
    * positions with wrapped lines should distinguish leading and
    * trailing cursors.
    */
-  tmp_list = layout->lines;
-  while (tmp_list->data != line)
-    tmp_list = tmp_list->next;
-
-  if (tmp_list->next &&
-      line->start_index + line->length == ((PangoLayoutLine *)tmp_list->next->data)->start_index)
-    suppress_last_trailing = TRUE;
-  else
-    suppress_last_trailing = FALSE;
+  suppress_last_trailing = hit->suppress_last_trailing;
 
   if (x_pos < 0)
     {
@@ -5231,85 +6449,80 @@ pango_layout_line_x_to_index (PangoLayoutLine *line,
       /* and its leftmost edge */
       if (trailing)
         *trailing = (line->resolved_dir == PANGO_DIRECTION_LTR || suppress_last_trailing) ? 0 : last_trailing;
-
-      return FALSE;
     }
-
-  tmp_list = line->runs;
-  while (tmp_list)
+  else if (x_pos < hit->width)
     {
-      PangoLayoutRun *run = tmp_list->data;
-      int logical_width;
+      LineCluster *cluster;
+      PangoGlyphString glyphs;
+      int offset;
+      gboolean char_trailing;
+      int grapheme_start_index;
+      int grapheme_start_offset;
+      int grapheme_end_offset;
+      int pos;
+      int char_index;
 
-      logical_width = pango_glyph_string_get_width (run->glyphs);
+      cluster = line_hit_index_find_x (hit, x_pos);
 
-      if (x_pos >= start_pos && x_pos < start_pos + logical_width)
-        {
-          int offset;
-          gboolean char_trailing;
-          int grapheme_start_index;
-          int grapheme_start_offset;
-          int grapheme_end_offset;
-          int pos;
-          int char_index;
-
-          pango_glyph_string_x_to_index (run->glyphs,
-                                         layout->text + run->item->offset, run->item->length,
-                                         &run->item->analysis,
-                                         x_pos - start_pos,
-                                         &pos, &char_trailing);
-
-          char_index = run->item->offset + pos;
+      line_cluster_glyphs (hit, cluster, &glyphs);
+      pango_glyph_string_x_to_index (&glyphs,
+                                     layout->text + cluster->start_index,
+                                     cluster->end_index - cluster->start_index,
+                                     &cluster->run->item->analysis,
+                                     x_pos - cluster->x,
+                                     &pos, &char_trailing);
 
-          /* Convert from characters to graphemes */
+      char_index = cluster->start_index + pos;
 
-          offset = g_utf8_pointer_to_offset (layout->text, layout->text + char_index);
+      /* Convert from characters to graphemes */
 
-          grapheme_start_offset = offset;
-          grapheme_start_index = char_index;
-          while (grapheme_start_offset > first_offset &&
-                 !layout->log_attrs[grapheme_start_offset].is_cursor_position)
-            {
-              grapheme_start_index = g_utf8_prev_char (layout->text + grapheme_start_index) - layout->text;
-              grapheme_start_offset--;
-            }
+      offset = line_cluster_offset (layout, cluster, char_index);
 
-          grapheme_end_offset = offset;
-          do
-            {
-              grapheme_end_offset++;
-            }
-          while (grapheme_end_offset < end_offset &&
-                 !layout->log_attrs[grapheme_end_offset].is_cursor_position);
+      grapheme_start_offset = offset;
+      grapheme_start_index = char_index;
+      while (grapheme_start_offset > first_offset &&
+             !layout->log_attrs[grapheme_start_offset].is_cursor_position)
+        {
+          grapheme_start_index = g_utf8_prev_char (layout->text + grapheme_start_index) - layout->text;
+          grapheme_start_offset--;
+        }
 
-          if (index)
-            *index = grapheme_start_index;
+      grapheme_end_offset = offset;
+      do
+        {
+          grapheme_end_offset++;
+        }
+      while (grapheme_end_offset < end_offset &&
+             !layout->log_attrs[grapheme_end_offset].is_cursor_position);
 
-          if (trailing)
-            {
-              if ((grapheme_end_offset == end_offset && suppress_last_trailing) ||
-                  offset + char_trailing <= (grapheme_start_offset + grapheme_end_offset) / 2)
-                *trailing = 0;
-              else
-                *trailing = grapheme_end_offset - grapheme_start_offset;
-            }
+      if (index)
+        *index = grapheme_start_index;
 
-          return TRUE;
+      if (trailing)
+        {
+          if ((grapheme_end_offset == end_offset && suppress_last_trailing) ||
+              offset + char_trailing <= (grapheme_start_offset + grapheme_end_offset) / 2)
+            *trailing = 0;
+          else
+            *trailing = grapheme_end_offset - grapheme_start_offset;
         }
 
-      start_pos += logical_width;
-      tmp_list = tmp_list->next;
+      inside = TRUE;
     }
+  else
+    {
+      /* pick the rightmost char */
+      if (index)
+        *index = (line->resolved_dir == PANGO_DIRECTION_LTR) ? last_index : first_index;
 
-  /* pick the rightmost char */
-  if (index)
-    *index = (line->resolved_dir == PANGO_DIRECTION_LTR) ? last_index : first_index;
+      /* and its rightmost edge */
+      if (trailing)
+        *trailing = (line->resolved_dir == PANGO_DIRECTION_LTR && !suppress_last_trailing) ? last_trailing : 0;
+    }
 
-  /* and its rightmost edge */
-  if (trailing)
-    *trailing = (line->resolved_dir == PANGO_DIRECTION_LTR && !suppress_last_trailing) ? last_trailing : 0;
+  line_hit_index_free (tmp);
 
-  return FALSE;
+  return inside;
 }
 
 static int
@@ -5796,10 +7009,19 @@ pango_layout_line_get_extents_and_height (PangoLayoutLine *line,
         *height = private->height;
       return;
 
+    case LOGICAL_CACHED:
+      if (!ink_rect)
+        {
+          if (logical_rect)
+            *logical_rect = private->logical_rect;
+          if (height)
+            *height = private->height;
+          return;
+        }
+      G_GNUC_FALLTHROUGH;
+
     case NOT_CACHED:
       caching = TRUE;
-      if (!ink_rect)
-        ink_rect = &private->ink_rect;
       if (!logical_rect)
         logical_rect = &private->logical_rect;
       if (!height)
@@ -5896,13 +7118,18 @@ pango_layout_line_get_extents_and_height (PangoLayoutLine *line,
 
   if (caching)
     {
-      if (&private->ink_rect != ink_rect)
-        private->ink_rect = *ink_rect;
       if (&private->logical_rect != logical_rect)
         private->logical_rect = *logical_rect;
       if (&private->height != height)
         private->height = *height;
-      private->cache_status = CACHED;
+
+      if (ink_rect)
+        {
+          private->ink_rect = *ink_rect;
+          private->cache_status = CACHED;
+        }
+      else
+        private->cache_status = LOGICAL_CACHED;
     }
 }
 
@@ -5959,6 +7186,7 @@ pango_layout_line_new (PangoLayout *layout)
   private->line.runs = NULL;
   private->line.length = 0;
   private->cache_status = NOT_CACHED;
+  private->hit_index = NULL;
 
   /* Note that we leave start_index, resolved_dir, and is_paragraph_start
    *  uninitialized */
@@ -6333,7 +7561,7 @@ adjust_line_letter_spacing (PangoLayoutLine *line,
         {
           PangoLayoutRun *visual_next_run = reversed ? last_run : next_run;
           PangoLayoutRun *visual_last_run = reversed ? next_run : last_run;
-          int run_spacing = get_item_letter_spacing (run->item);
+          int run_spacing = quantize_letter_spacing (layout, run->item, get_item_letter_spacing (run->item));
           int space_left, space_right;
 
           distribute_letter_spacing (run_spacing, &space_left, &space_right);
@@ -6380,6 +7608,7 @@ justify_clusters (PangoLayoutLine *line,
   int total_remaining_width, total_gaps = 0;
   int added_so_far, gaps_so_far;
   gboolean is_hinted;
+  int n_positions;
   GSList *run_iter;
   enum {
     MEASURE,
@@ -6392,6 +7621,7 @@ justify_clusters (PangoLayoutLine *line,
 
   /* hint to full pixel if total remaining width was so */
   is_hinted = (total_remaining_width & (PANGO_SCALE - 1)) == 0;
+  n_positions = get_subpixel_positions (line->layout);
 
   for (mode = MEASURE; mode <= ADJUST; mode++)
     {
@@ -6456,6 +7686,12 @@ justify_clusters (PangoLayoutLine *line,
                     adjustment = PANGO_UNITS_ROUND (adjustment);
                     residual = old_adjustment - adjustment;
                   }
+                  else if (n_positions)
+                  {
+                    int old_adjustment = adjustment;
+                    adjustment = quantize_letter_spacing (line->layout, run->item, adjustment);
+                    residual = old_adjustment - adjustment;
+                  }
                   /* distribute to before/after */
                   distribute_letter_spacing (adjustment, &space_left, &space_right);
 
@@ -6526,6 +7762,7 @@ justify_words (PangoLayoutLine *line,
   int total_remaining_width, total_space_width = 0;
   int added_so_far, spaces_so_far;
   gboolean is_hinted;
+  int n_positions;
   GSList *run_iter;
   enum {
     MEASURE,
@@ -6538,6 +7775,7 @@ justify_words (PangoLayoutLine *line,
 
   /* hint to full pixel if total remaining width was so */
   is_hinted = (total_remaining_width & (PANGO_SCALE - 1)) == 0;
+  n_positions = get_subpixel_positions (line->layout);
 
   for (mode = MEASURE; mode <= ADJUST; mode++)
     {
@@ -6585,6 +7823,8 @@ justify_words (PangoLayoutLine *line,
                       adjustment = ((guint64) spaces_so_far * total_remaining_width) / total_space_width - added_so_far;
                       if (is_hinted)
                         adjustment = PANGO_UNITS_ROUND (adjustment);
+                      else if (n_positions)
+                        adjustment = pango_analysis_quantize_width (&run->item->analysis, adjustment, n_positions);
 
                       glyphs->glyphs[i].geometry.width += adjustment;
                       added_so_far += adjustment;
@@ -6850,16 +8090,20 @@ pango_layout_line_postprocess (PangoLayoutLine *line,
   if (G_UNLIKELY (state->line_width >= 0 &&
                   should_ellipsize_current_line (line->layout, state)))
     {
-      PangoShapeFlags shape_flags = PANGO_SHAPE_NONE;
-
-      if (pango_context_get_round_glyph_positions (line->layout->context))
-        shape_flags |= PANGO_SHAPE_ROUND_POSITIONS;
-
-      ellipsized = _pango_layout_line_ellipsize (line, state->attrs, shape_flags, state->line_width);
+      /* Measuring doesn't keep anything for later relayouts */
+      ellipsized = _pango_layout_line_ellipsize (line, state->attrs,
+                                                 get_shape_flags (line->layout),
+                                                 get_subpixel_positions (line->layout),
+                                                 state->line_width,
+                                                 !state->measure);
     }
 
-  /* Now convert logical to visual order */
-  pango_layout_line_reorder (line);
+  /* Now convert logical to visual order. The order of the runs
+   * doesn't change the size of the line, so skip this if we are
+   * only measuring.
+   */
+  if (!state->measure)
+    pango_layout_line_reorder (line);
 
   DEBUG ("after reordering", line, state);
 
@@ -6868,6 +8112,9 @@ pango_layout_line_postprocess (PangoLayoutLine *line,
 
   DEBUG ("after letter spacing", line, state);
 
+  if (state->measure)
+    return;
+
   /* Distribute extra space between words if justifying and line was wrapped */
   if (line->layout->justify && (wrapped || ellipsized || line->layout->justify_last_line))
     {
@@ -7161,13 +8408,7 @@ pango_layout_iter_copy (PangoLayoutIter *iter)
   new->run = iter->run;
   new->index = iter->index;
 
-  new->line_extents = NULL;
-  if (iter->line_extents != NULL)
-    {
-      new->line_extents = g_memdup2 (iter->line_extents,
-                                     iter->layout->line_count * sizeof (Extents));
-
-    }
+  new->line_extents = g_rc_box_acquire (iter->line_extents);
   new->line_index = iter->line_index;
 
   new->run_x = iter->run_x;
@@ -7241,29 +8482,61 @@ _pango_layout_get_iter (PangoLayout    *layout,
   else
     iter->run = NULL;
 
-  iter->line_extents = NULL;
+  iter->line_extents = g_rc_box_acquire (pango_layout_get_line_extents (layout, &iter->layout_width));
+  iter->line_index = 0;
 
-  if (layout->width == -1)
+  update_run (iter, run_start_index);
+}
+
+/* Moves @iter forward to the first line whose ink may reach
+ * below @y, in layout coordinates, or to the last line if there
+ * is none. The logical extents of the lines are sorted, so this
+ * is a binary search rather than a walk over the runs.
+ */
+void
+_pango_layout_iter_skip_to_y (PangoLayoutIter *iter,
+                              int              y)
+{
+  int above, below;
+  int lo, hi;
+
+  if (ITER_IS_INVALID (iter))
+    return;
+
+  _pango_layout_get_ink_overhang (iter->layout, &above, &below);
+
+  lo = iter->line_index;
+  hi = iter->layout->line_count - 1;
+  while (lo < hi)
     {
-      PangoRectangle logical_rect;
+      int mid = lo + (hi - lo) / 2;
+      const PangoRectangle *logical = &iter->line_extents[mid].logical_rect;
 
-      pango_layout_get_extents_internal (layout,
-                                         NULL,
-                                         &logical_rect,
-                                         &iter->line_extents);
-      iter->layout_width = logical_rect.width;
+      if (logical->y + logical->height + below > y)
+        hi = mid;
+      else
+        lo = mid + 1;
     }
+
+  if (lo == iter->line_index)
+    return;
+
+  iter->line_list_link = g_slist_nth (iter->line_list_link, lo - iter->line_index);
+
+  pango_layout_line_unref (iter->line);
+  iter->line = iter->line_list_link->data;
+  pango_layout_line_ref (iter->line);
+
+  iter->run_list_link = iter->line->runs;
+
+  if (iter->run_list_link)
+    iter->run = iter->run_list_link->data;
   else
-    {
-      pango_layout_get_extents_internal (layout,
-                                         NULL,
-                                         NULL,
-                                         &iter->line_extents);
-      iter->layout_width = layout->width;
-    }
-  iter->line_index = 0;
+    iter->run = NULL;
 
-  update_run (iter, run_start_index);
+  iter->line_index = lo;
+
+  update_run (iter, iter->line->start_index);
 }
 
 void
@@ -7272,7 +8545,7 @@ _pango_layout_iter_destroy (PangoLayoutIter *iter)
   if (iter == NULL)
     return;
 
-  g_free (iter->line_extents);
+  g_rc_box_release (iter->line_extents);
   pango_layout_line_unref (iter->line);
   g_object_unref (iter->layout);
 }
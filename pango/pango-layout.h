@@ -337,6 +337,12 @@ void     pango_layout_get_pixel_size       (PangoLayout    *layout,
 					    int            *height);
 PANGO_AVAILABLE_IN_1_22
 int      pango_layout_get_baseline         (PangoLayout    *layout);
+PANGO_AVAILABLE_IN_1_56
+void     pango_layout_measure              (PangoLayout    *layout,
+					    int            *width,
+					    int            *height,
+					    int            *line_count,
+					    int            *baseline);
 
 PANGO_AVAILABLE_IN_ALL
 int              pango_layout_get_line_count       (PangoLayout    *layout);
@@ -27,6 +27,7 @@
 #include "pango-markup.h"
 
 #include "pango-attributes.h"
+#include "pango-attributes-private.h"
 #include "pango-font.h"
 #include "pango-enum-types.h"
 #include "pango-impl-utils.h"
@@ -599,6 +600,281 @@ pango_markup_parser_new_internal (char       accel_marker,
   return context;
 }
 
+static gboolean
+parse_markup (const char     *markup_text,
+              int             length,
+              gunichar        accel_marker,
+              PangoAttrList **attr_list,
+              char          **text,
+              gunichar       *accel_char,
+              GError        **error)
+{
+  GMarkupParseContext *context = NULL;
+  gboolean ret = FALSE;
+  const char *p;
+  const char *end;
+
+  p = markup_text;
+  end = markup_text + length;
+  while (p != end && xml_isspace (*p))
+    ++p;
+
+  context = pango_markup_parser_new_internal (accel_marker,
+                                              error,
+                                              (attr_list != NULL));
+
+  if (!g_markup_parse_context_parse (context,
+                                     markup_text,
+                                     length,
+                                     error))
+    goto out;
+
+  if (!pango_markup_parser_finish (context,
+                                   attr_list,
+                                   text,
+                                   accel_char,
+                                   error))
+    goto out;
+
+  ret = TRUE;
+
+ out:
+  if (context != NULL)
+    g_markup_parse_context_free (context);
+  return ret;
+}
+
+/* Markup cache
+ *
+ * Parsing markup is expensive, and applications tend to set
+ * the same few markup strings over and over. If enabled, we
+ * keep the most recently used results. The attribute lists
+ * are shared with the callers and only copied when modified.
+ */
+
+typedef struct _MarkupCacheEntry MarkupCacheEntry;
+
+struct _MarkupCacheEntry
+{
+  GList link;
+  guint hash;
+
+  char *markup;
+  gsize length;
+  gunichar accel_marker;
+
+  PangoAttrList *attr_list;
+  char *text;
+  gunichar accel_char;
+};
+
+G_LOCK_DEFINE_STATIC (markup_cache);
+static GHashTable *markup_cache;
+static GQueue markup_cache_lru = G_QUEUE_INIT;
+static guint markup_cache_max_entries;
+static guint markup_cache_hits;
+static guint markup_cache_misses;
+
+static guint
+markup_cache_entry_hash (gconstpointer data)
+{
+  const MarkupCacheEntry *entry = data;
+
+  return entry->hash;
+}
+
+static gboolean
+markup_cache_entry_equal (gconstpointer a,
+                          gconstpointer b)
+{
+  const MarkupCacheEntry *entry1 = a;
+  const MarkupCacheEntry *entry2 = b;
+
+  return entry1->length == entry2->length &&
+         entry1->accel_marker == entry2->accel_marker &&
+         memcmp (entry1->markup, entry2->markup, entry1->length) == 0;
+}
+
+static void
+markup_cache_entry_free (gpointer data)
+{
+  MarkupCacheEntry *entry = data;
+
+  g_free (entry->markup);
+  g_free (entry->text);
+  pango_attr_list_unref (entry->attr_list);
+  g_free (entry);
+}
+
+static guint
+markup_hash (const char *markup,
+             gsize       length,
+             gunichar    accel_marker)
+{
+  guint h = 5381 ^ accel_marker;
+  gsize i;
+
+  for (i = 0; i < length; i++)
+    h = (h << 5) + h + (guchar) markup[i];
+
+  return h;
+}
+
+static gboolean
+markup_cache_lookup (const char     *markup_text,
+                     gsize           length,
+                     gunichar        accel_marker,
+                     PangoAttrList **attr_list,
+                     char          **text,
+                     gunichar       *accel_char)
+{
+  MarkupCacheEntry key;
+  MarkupCacheEntry *entry;
+
+  key.hash = markup_hash (markup_text, length, accel_marker);
+  key.markup = (char *) markup_text;
+  key.length = length;
+  key.accel_marker = accel_marker;
+
+  G_LOCK (markup_cache);
+
+  entry = markup_cache ? g_hash_table_lookup (markup_cache, &key) : NULL;
+  if (!entry)
+    {
+      markup_cache_misses++;
+      G_UNLOCK (markup_cache);
+      return FALSE;
+    }
+
+  markup_cache_hits++;
+
+  g_queue_unlink (&markup_cache_lru, &entry->link);
+  g_queue_push_head_link (&markup_cache_lru, &entry->link);
+
+  if (attr_list)
+    *attr_list = pango_attr_list_copy (entry->attr_list);
+  if (text)
+    *text = g_strdup (entry->text);
+  if (accel_char)
+    *accel_char = entry->accel_char;
+
+  G_UNLOCK (markup_cache);
+
+  return TRUE;
+}
+
+static void
+markup_cache_trim (guint max_entries)
+{
+  while (markup_cache_lru.length > max_entries)
+    {
+      MarkupCacheEntry *entry = g_queue_peek_tail (&markup_cache_lru);
+
+      g_queue_unlink (&markup_cache_lru, &entry->link);
+      g_hash_table_remove (markup_cache, entry);
+    }
+}
+
+static void
+markup_cache_insert (const char    *markup_text,
+                     gsize          length,
+                     gunichar       accel_marker,
+                     PangoAttrList *attr_list,
+                     const char    *text,
+                     gunichar       accel_char)
+{
+  MarkupCacheEntry *entry;
+
+  entry = g_new (MarkupCacheEntry, 1);
+  entry->link.data = entry;
+  entry->link.prev = entry->link.next = NULL;
+  entry->hash = markup_hash (markup_text, length, accel_marker);
+  entry->markup = g_memdup2 (markup_text, length);
+  entry->length = length;
+  entry->accel_marker = accel_marker;
+  entry->attr_list = pango_attr_list_ref (attr_list);
+  entry->text = g_strdup (text);
+  entry->accel_char = accel_char;
+
+  G_LOCK (markup_cache);
+
+  if (markup_cache_max_entries == 0 ||
+      g_hash_table_contains (markup_cache, entry))
+    {
+      /* Disabled meanwhile, or another thread was faster */
+      G_UNLOCK (markup_cache);
+      markup_cache_entry_free (entry);
+      return;
+    }
+
+  g_hash_table_add (markup_cache, entry);
+  g_queue_push_head_link (&markup_cache_lru, &entry->link);
+  markup_cache_trim (markup_cache_max_entries);
+
+  G_UNLOCK (markup_cache);
+}
+
+/**
+ * pango_markup_cache_set_max_entries:
+ * @max_entries: the number of parse results to keep, or 0
+ *
+ * Enables caching the results of [func@Pango.parse_markup].
+ *
+ * When the cache is enabled, parsing a markup string that was
+ * parsed recently only costs a hash lookup. This also speeds up
+ * [method@Pango.Layout.set_markup]. The returned attribute lists
+ * share their attributes until they are modified.
+ *
+ * Up to @max_entries results are kept, and the least recently
+ * used ones are dropped first. Passing 0, which is the default,
+ * disables the cache and frees the cached results.
+ *
+ * Since: 1.56
+ */
+void
+pango_markup_cache_set_max_entries (guint max_entries)
+{
+  G_LOCK (markup_cache);
+
+  if (!markup_cache)
+    markup_cache = g_hash_table_new_full (markup_cache_entry_hash,
+                                          markup_cache_entry_equal,
+                                          markup_cache_entry_free,
+                                          NULL);
+
+  markup_cache_trim (max_entries);
+  g_atomic_int_set (&markup_cache_max_entries, max_entries);
+
+  G_UNLOCK (markup_cache);
+}
+
+/**
+ * pango_markup_cache_get_stats:
+ * @hits: (out) (optional): return location for the number of cache hits
+ * @misses: (out) (optional): return location for the number of cache misses
+ *
+ * Gets the number of times that [func@Pango.parse_markup] found
+ * its result in the markup cache, or had to parse the markup
+ * while the cache was enabled.
+ *
+ * See [func@Pango.markup_cache_set_max_entries].
+ *
+ * Since: 1.56
+ */
+void
+pango_markup_cache_get_stats (guint *hits,
+                              guint *misses)
+{
+  G_LOCK (markup_cache);
+
+  if (hits)
+    *hits = markup_cache_hits;
+  if (misses)
+    *misses = markup_cache_misses;
+
+  G_UNLOCK (markup_cache);
+}
+
 /**
  * pango_parse_markup:
  * @markup_text: markup to parse (see the [Pango Markup](pango_markup.html) docs)
@@ -638,44 +914,46 @@ pango_parse_markup (const char                 *markup_text,
 		    gunichar                   *accel_char,
 		    GError                    **error)
 {
-  GMarkupParseContext *context = NULL;
-  gboolean ret = FALSE;
-  const char *p;
-  const char *end;
+  PangoAttrList *list;
+  char *stripped;
+  gunichar accel;
 
   g_return_val_if_fail (markup_text != NULL, FALSE);
 
   if (length < 0)
     length = strlen (markup_text);
 
-  p = markup_text;
-  end = markup_text + length;
-  while (p != end && xml_isspace (*p))
-    ++p;
+  if (g_atomic_int_get (&markup_cache_max_entries) == 0)
+    return parse_markup (markup_text, length, accel_marker,
+                         attr_list, text, accel_char,
+                         error);
 
-  context = pango_markup_parser_new_internal (accel_marker,
-                                              error,
-                                              (attr_list != NULL));
+  if (markup_cache_lookup (markup_text, length, accel_marker,
+                           attr_list, text, accel_char))
+    return TRUE;
 
-  if (!g_markup_parse_context_parse (context,
-                                     markup_text,
-                                     length,
-                                     error))
-    goto out;
+  if (!parse_markup (markup_text, length, accel_marker,
+                     &list, &stripped, &accel,
+                     error))
+    return FALSE;
 
-  if (!pango_markup_parser_finish (context,
-                                   attr_list,
-                                   text,
-                                   accel_char,
-                                   error))
-    goto out;
+  _pango_attr_list_share (list);
+  markup_cache_insert (markup_text, length, accel_marker, list, stripped, accel);
 
-  ret = TRUE;
+  /* The cache keeps @list itself, so hand out a copy */
+  if (attr_list)
+    *attr_list = pango_attr_list_copy (list);
+  pango_attr_list_unref (list);
 
- out:
-  if (context != NULL)
-    g_markup_parse_context_free (context);
-  return ret;
+  if (text)
+    *text = stripped;
+  else
+    g_free (stripped);
+
+  if (accel_char)
+    *accel_char = accel;
+
+  return TRUE;
 }
 
 /**
@@ -46,6 +46,13 @@ gboolean               pango_parse_markup        (const char            *markup_
                                                   gunichar              *accel_char,
                                                   GError               **error);
 
+PANGO_AVAILABLE_IN_1_56
+void                   pango_markup_cache_set_max_entries (guint          max_entries);
+
+PANGO_AVAILABLE_IN_1_56
+void                   pango_markup_cache_get_stats       (guint         *hits,
+                                                           guint         *misses);
+
 
 G_END_DECLS
 
@@ -63,6 +63,12 @@ struct _PangoRendererPrivate
   PangoLayoutLine *line;
   LineState *line_state;
   PangoOverline overline;
+
+  /* The layout of @line, while replaying a render list */
+  PangoLayout *layout;
+
+  /* Area outside of which nothing needs to be drawn, or NULL */
+  const PangoRectangle *clip;
 };
 
 static void pango_renderer_finalize                     (GObject          *gobject);
@@ -167,12 +173,82 @@ pango_renderer_draw_layout (PangoRenderer *renderer,
                             PangoLayout   *layout,
                             int            x,
                             int            y)
+{
+  pango_renderer_draw_layout_clipped (renderer, layout, x, y, NULL);
+}
+
+static inline gboolean
+rectangles_intersect (const PangoRectangle *a,
+                      const PangoRectangle *b)
+{
+  return a->x < b->x + b->width && b->x < a->x + a->width &&
+         a->y < b->y + b->height && b->y < a->y + a->height;
+}
+
+/* The area that drawing @line may touch, relative to
+ * the left end of its baseline: glyphs cover the ink
+ * extents, backgrounds the logical extents.
+ */
+static void
+get_line_draw_extents (PangoLayoutLine *line,
+                       PangoRectangle  *extents)
+{
+  PangoRectangle ink, logical;
+  int x0, y0, x1, y1;
+
+  pango_layout_line_get_extents (line, &ink, &logical);
+
+  x0 = MIN (ink.x, logical.x);
+  y0 = MIN (ink.y, logical.y);
+  x1 = MAX (ink.x + ink.width, logical.x + logical.width);
+  y1 = MAX (ink.y + ink.height, logical.y + logical.height);
+
+  extents->x = x0;
+  extents->y = y0;
+  extents->width = x1 - x0;
+  extents->height = y1 - y0;
+}
+
+/**
+ * pango_renderer_draw_layout_clipped:
+ * @renderer: a `PangoRenderer`
+ * @layout: a `PangoLayout`
+ * @x: X position of left edge of baseline, in user space coordinates
+ *   in Pango units.
+ * @y: Y position of left edge of baseline, in user space coordinates
+ *   in Pango units.
+ * @clip: (nullable): the area that needs to be drawn, in user space
+ *   coordinates in Pango units, or %NULL to draw everything
+ *
+ * Draws the part of @layout that is visible in @clip with the
+ * specified `PangoRenderer`.
+ *
+ * Lines and runs whose extents lie entirely outside @clip are
+ * skipped, so that redrawing a small part of a long layout, such
+ * as the visible part of a scrolled text view, only costs as much
+ * as the lines that are actually in view. Anything that is drawn
+ * may still reach outside @clip; it is up to the renderer to clip
+ * its output.
+ *
+ * Since: 1.56
+ */
+void
+pango_renderer_draw_layout_clipped (PangoRenderer        *renderer,
+                                    PangoLayout          *layout,
+                                    int                   x,
+                                    int                   y,
+                                    const PangoRectangle *clip)
 {
   PangoLayoutIter iter;
+  PangoRectangle layout_clip;
+  int above = 0, below = 0;
 
   g_return_if_fail (PANGO_IS_RENDERER (renderer));
   g_return_if_fail (PANGO_IS_LAYOUT (layout));
 
+  if (clip && (clip->width <= 0 || clip->height <= 0))
+    return;
+
   /* We only change the matrix if the renderer isn't already
    * active.
    */
@@ -187,6 +263,17 @@ pango_renderer_draw_layout (PangoRenderer *renderer,
 
   _pango_layout_get_iter (layout, &iter);
 
+  if (clip)
+    {
+      /* The clip in layout coordinates */
+      layout_clip = *clip;
+      layout_clip.x -= x;
+      layout_clip.y -= y;
+
+      _pango_layout_get_ink_overhang (layout, &above, &below);
+      _pango_layout_iter_skip_to_y (&iter, layout_clip.y);
+    }
+
   do
     {
       PangoRectangle   logical_rect;
@@ -198,10 +285,30 @@ pango_renderer_draw_layout (PangoRenderer *renderer,
       pango_layout_iter_get_line_extents (&iter, NULL, &logical_rect);
       baseline = pango_layout_iter_get_baseline (&iter);
 
+      if (clip)
+        {
+          PangoRectangle extents;
+
+          /* Lines are sorted, nothing below this one is visible either */
+          if (logical_rect.y - above >= layout_clip.y + layout_clip.height)
+            break;
+
+          get_line_draw_extents (line, &extents);
+          extents.x += logical_rect.x;
+          extents.y += baseline;
+
+          if (!rectangles_intersect (&extents, &layout_clip))
+            continue;
+        }
+
+      renderer->priv->clip = clip;
+
       pango_renderer_draw_layout_line (renderer,
                                        line,
                                        x + logical_rect.x,
                                        y + baseline);
+
+      renderer->priv->clip = NULL;
     }
   while (pango_layout_iter_next_line (&iter));
 
@@ -550,6 +657,39 @@ draw_shaped_glyphs (PangoRenderer    *renderer,
 }
 
 
+/* Whether the glyphs of @run, drawn at @x, @y, may show
+ * up in the clip of @renderer. @ink is the ink extents
+ * of the glyphs if they are known already.
+ */
+static gboolean
+run_is_visible (PangoRenderer        *renderer,
+                PangoLayoutRun       *run,
+                const PangoRectangle *ink,
+                int                   x,
+                int                   y,
+                int                   width)
+{
+  const PangoRectangle *clip = renderer->priv->clip;
+  PangoRectangle ink_rect;
+
+  /* Lines outside the clip are skipped already, so runs that
+   * overlap it horizontally are drawn without looking at their ink
+   */
+  if (x < clip->x + clip->width && clip->x < x + width)
+    return TRUE;
+
+  if (ink)
+    ink_rect = *ink;
+  else
+    pango_glyph_string_extents (run->glyphs, run->item->analysis.font,
+                                &ink_rect, NULL);
+
+  ink_rect.x += x;
+  ink_rect.y += y;
+
+  return rectangles_intersect (&ink_rect, clip);
+}
+
 /**
  * pango_renderer_draw_layout_line:
  * @renderer: a `PangoRenderer`
@@ -682,7 +822,15 @@ pango_renderer_draw_layout_line (PangoRenderer   *renderer,
                                          overall_rect.height);
         }
 
-      if (shape_attr)
+      if (G_UNLIKELY (renderer->priv->clip) &&
+          !run_is_visible (renderer, run, ink,
+                           x + x_off, y - y_off, glyph_string_width))
+        {
+          /* Nothing of the glyphs is visible, but decorations
+           * are still accumulated across runs below
+           */
+        }
+      else if (shape_attr)
         {
           draw_shaped_glyphs (renderer, run->glyphs, shape_attr, x + x_off, y - y_off);
         }
@@ -1620,6 +1768,9 @@ pango_renderer_get_layout (PangoRenderer *renderer)
   if (G_UNLIKELY (renderer->priv->line == NULL))
     return NULL;
 
+  if (G_UNLIKELY (renderer->priv->layout))
+    return renderer->priv->layout;
+
   return renderer->priv->line->layout;
 }
 
@@ -1645,3 +1796,539 @@ pango_renderer_get_layout_line (PangoRenderer *renderer)
 {
   return renderer->priv->line;
 }
+
+/* Render lists */
+
+typedef enum
+{
+  RENDER_OP_GLYPHS,
+  RENDER_OP_GLYPH_ITEM,
+  RENDER_OP_RECTANGLE,
+  RENDER_OP_TRAPEZOID,
+  RENDER_OP_ERROR_UNDERLINE,
+  RENDER_OP_SHAPE
+} RenderOpType;
+
+typedef struct _RenderOp RenderOp;
+struct _RenderOp
+{
+  guint8 type;
+  guint8 part;
+  guint8 color_set;
+  guint16 alpha;
+  PangoColor color;
+
+  union {
+    struct {
+      PangoFont *font;
+      PangoGlyphString *glyphs;
+      int x, y;
+    } glyphs;
+    struct {
+      PangoGlyphItem *glyph_item;
+      int x, y;
+    } glyph_item;
+    struct {
+      int x, y, width, height;
+    } rectangle;
+    struct {
+      double y1, x11, x21, y2, x12, x22;
+    } trapezoid;
+    struct {
+      PangoAttrShape *attr;
+      PangoLayoutLine *line;
+      PangoLayout *layout;
+      int x, y;
+    } shape;
+  };
+};
+
+struct _PangoRenderList
+{
+  int ref_count;
+
+  GWeakRef layout;
+  guint serial;
+
+  char *text;
+  PangoMatrix *matrix;
+
+  RenderOp *ops;
+  guint n_ops;
+};
+
+/**
+ * PangoRenderList:
+ *
+ * A `PangoRenderList` is a recording of what drawing a
+ * `PangoLayout` with a `PangoRenderer` does.
+ *
+ * It holds the glyph runs, rectangles and trapezoids that make
+ * up the layout, with their colors, in the order they are drawn.
+ * Replaying the list with [method@Pango.Renderer.draw_render_list]
+ * skips iterating the layout and looking at its attributes, which
+ * makes it cheap to draw the same layout over and over.
+ *
+ * A render list is immutable. It does not change when the layout
+ * that it was recorded from does; use [method@Pango.RenderList.is_current]
+ * to find out whether it needs to be recorded again.
+ *
+ * Since: 1.56
+ */
+
+G_DEFINE_BOXED_TYPE (PangoRenderList, pango_render_list,
+                     pango_render_list_ref,
+                     pango_render_list_unref);
+
+typedef struct _PangoRecordingRenderer PangoRecordingRenderer;
+typedef struct _PangoRecordingRendererClass PangoRecordingRendererClass;
+
+struct _PangoRecordingRenderer
+{
+  PangoRenderer parent_instance;
+
+  GArray *ops;
+
+  /* Copy of the layout being recorded, for shape ops */
+  PangoLayout *snapshot;
+};
+
+struct _PangoRecordingRendererClass
+{
+  PangoRendererClass parent_class;
+};
+
+static GType pango_recording_renderer_get_type (void);
+
+G_DEFINE_TYPE (PangoRecordingRenderer, pango_recording_renderer, PANGO_TYPE_RENDERER)
+
+static RenderOp *
+add_op (PangoRenderer   *renderer,
+        RenderOpType     type,
+        PangoRenderPart  part)
+{
+  PangoRecordingRenderer *recorder = (PangoRecordingRenderer *) renderer;
+  RenderOp *op;
+
+  g_array_set_size (recorder->ops, recorder->ops->len + 1);
+  op = &g_array_index (recorder->ops, RenderOp, recorder->ops->len - 1);
+
+  op->type = type;
+  op->part = part;
+  op->color_set = renderer->priv->color_set[part];
+  op->color = renderer->priv->color[part];
+  op->alpha = renderer->priv->alpha[part];
+
+  return op;
+}
+
+static void
+pango_recording_renderer_draw_glyphs (PangoRenderer    *renderer,
+                                      PangoFont        *font,
+                                      PangoGlyphString *glyphs,
+                                      int               x,
+                                      int               y)
+{
+  RenderOp *op = add_op (renderer, RENDER_OP_GLYPHS, PANGO_RENDER_PART_FOREGROUND);
+
+  op->glyphs.font = font ? g_object_ref (font) : NULL;
+  op->glyphs.glyphs = pango_glyph_string_copy (glyphs);
+  op->glyphs.x = x;
+  op->glyphs.y = y;
+}
+
+static void
+pango_recording_renderer_draw_glyph_item (PangoRenderer  *renderer,
+                                          const char     *text G_GNUC_UNUSED,
+                                          PangoGlyphItem *glyph_item,
+                                          int             x,
+                                          int             y)
+{
+  RenderOp *op = add_op (renderer, RENDER_OP_GLYPH_ITEM, PANGO_RENDER_PART_FOREGROUND);
+
+  /* The text is that of the layout, which the list keeps a copy of */
+  op->glyph_item.glyph_item = pango_glyph_item_copy (glyph_item);
+  op->glyph_item.x = x;
+  op->glyph_item.y = y;
+}
+
+static void
+pango_recording_renderer_draw_rectangle (PangoRenderer   *renderer,
+                                         PangoRenderPart  part,
+                                         int              x,
+                                         int              y,
+                                         int              width,
+                                         int              height)
+{
+  RenderOp *op = add_op (renderer, RENDER_OP_RECTANGLE, part);
+
+  op->rectangle.x = x;
+  op->rectangle.y = y;
+  op->rectangle.width = width;
+  op->rectangle.height = height;
+}
+
+static void
+pango_recording_renderer_draw_trapezoid (PangoRenderer   *renderer,
+                                         PangoRenderPart  part,
+                                         double           y1_,
+                                         double           x11,
+                                         double           x21,
+                                         double           y2,
+                                         double           x12,
+                                         double           x22)
+{
+  RenderOp *op = add_op (renderer, RENDER_OP_TRAPEZOID, part);
+
+  op->trapezoid.y1 = y1_;
+  op->trapezoid.x11 = x11;
+  op->trapezoid.x21 = x21;
+  op->trapezoid.y2 = y2;
+  op->trapezoid.x12 = x12;
+  op->trapezoid.x22 = x22;
+}
+
+static void
+pango_recording_renderer_draw_error_underline (PangoRenderer *renderer,
+                                               int            x,
+                                               int            y,
+                                               int            width,
+                                               int            height)
+{
+  RenderOp *op = add_op (renderer, RENDER_OP_ERROR_UNDERLINE, PANGO_RENDER_PART_UNDERLINE);
+
+  op->rectangle.x = x;
+  op->rectangle.y = y;
+  op->rectangle.width = width;
+  op->rectangle.height = height;
+}
+
+static void
+pango_recording_renderer_draw_shape (PangoRenderer  *renderer,
+                                     PangoAttrShape *attr,
+                                     int             x,
+                                     int             y)
+{
+  PangoRecordingRenderer *recorder = (PangoRecordingRenderer *) renderer;
+  RenderOp *op = add_op (renderer, RENDER_OP_SHAPE, PANGO_RENDER_PART_FOREGROUND);
+
+  /* Shape renderers look at the layout being drawn, which
+   * may have changed by the time the list is replayed
+   */
+  if (!recorder->snapshot)
+    recorder->snapshot = pango_layout_copy (pango_renderer_get_layout (renderer));
+
+  op->shape.attr = (PangoAttrShape *) pango_attribute_copy ((PangoAttribute *) attr);
+  op->shape.line = pango_layout_line_ref (renderer->priv->line);
+  op->shape.layout = g_object_ref (recorder->snapshot);
+  op->shape.x = x;
+  op->shape.y = y;
+}
+
+static void
+pango_recording_renderer_init (PangoRecordingRenderer *recorder)
+{
+}
+
+static void
+pango_recording_renderer_class_init (PangoRecordingRendererClass *klass)
+{
+  PangoRendererClass *renderer_class = PANGO_RENDERER_CLASS (klass);
+
+  renderer_class->draw_glyphs = pango_recording_renderer_draw_glyphs;
+  renderer_class->draw_glyph_item = pango_recording_renderer_draw_glyph_item;
+  renderer_class->draw_rectangle = pango_recording_renderer_draw_rectangle;
+  renderer_class->draw_trapezoid = pango_recording_renderer_draw_trapezoid;
+  renderer_class->draw_error_underline = pango_recording_renderer_draw_error_underline;
+  renderer_class->draw_shape = pango_recording_renderer_draw_shape;
+}
+
+static void
+render_op_clear (RenderOp *op)
+{
+  switch ((RenderOpType) op->type)
+    {
+    case RENDER_OP_GLYPHS:
+      g_clear_object (&op->glyphs.font);
+      pango_glyph_string_free (op->glyphs.glyphs);
+      break;
+    case RENDER_OP_GLYPH_ITEM:
+      pango_glyph_item_free (op->glyph_item.glyph_item);
+      break;
+    case RENDER_OP_SHAPE:
+      pango_attribute_destroy ((PangoAttribute *) op->shape.attr);
+      pango_layout_line_unref (op->shape.line);
+      g_object_unref (op->shape.layout);
+      break;
+    case RENDER_OP_RECTANGLE:
+    case RENDER_OP_TRAPEZOID:
+    case RENDER_OP_ERROR_UNDERLINE:
+    default:
+      break;
+    }
+}
+
+/**
+ * pango_render_list_new:
+ * @layout: a `PangoLayout`
+ *
+ * Records what drawing @layout does.
+ *
+ * The list can then be drawn with [method@Pango.Renderer.draw_render_list]
+ * or [func@PangoCairo.show_render_list], with the same result as drawing
+ * @layout as it is now.
+ *
+ * Return value: (transfer full): a new `PangoRenderList`
+ *
+ * Since: 1.56
+ */
+PangoRenderList *
+pango_render_list_new (PangoLayout *layout)
+{
+  PangoRecordingRenderer *recorder;
+  PangoRenderList *list;
+  const PangoMatrix *matrix;
+
+  g_return_val_if_fail (PANGO_IS_LAYOUT (layout), NULL);
+
+  list = g_new0 (PangoRenderList, 1);
+  list->ref_count = 1;
+
+  g_weak_ref_init (&list->layout, layout);
+  list->serial = pango_layout_get_serial (layout);
+  list->text = g_strdup (pango_layout_get_text (layout));
+
+  matrix = pango_context_get_matrix (pango_layout_get_context (layout));
+  list->matrix = pango_matrix_copy (matrix);
+
+  recorder = g_object_new (pango_recording_renderer_get_type (), NULL);
+  recorder->ops = g_array_new (FALSE, FALSE, sizeof (RenderOp));
+
+  pango_renderer_draw_layout ((PangoRenderer *) recorder, layout, 0, 0);
+
+  list->n_ops = recorder->ops->len;
+  list->ops = (RenderOp *) g_array_free (recorder->ops, FALSE);
+  recorder->ops = NULL;
+  g_clear_object (&recorder->snapshot);
+
+  g_object_unref (recorder);
+
+  return list;
+}
+
+/**
+ * pango_render_list_ref:
+ * @list: a `PangoRenderList`
+ *
+ * Increases the reference count of @list by one.
+ *
+ * Return value: (transfer full): @list
+ *
+ * Since: 1.56
+ */
+PangoRenderList *
+pango_render_list_ref (PangoRenderList *list)
+{
+  g_return_val_if_fail (list != NULL, NULL);
+
+  g_atomic_int_inc (&list->ref_count);
+
+  return list;
+}
+
+/**
+ * pango_render_list_unref:
+ * @list: (transfer full): a `PangoRenderList`
+ *
+ * Decreases the reference count of @list by one.
+ *
+ * If the result is zero, frees @list and all the glyphs
+ * and fonts it holds.
+ *
+ * Since: 1.56
+ */
+void
+pango_render_list_unref (PangoRenderList *list)
+{
+  g_return_if_fail (list != NULL);
+
+  if (!g_atomic_int_dec_and_test (&list->ref_count))
+    return;
+
+  for (guint i = 0; i < list->n_ops; i++)
+    render_op_clear (&list->ops[i]);
+
+  g_free (list->ops);
+  g_weak_ref_clear (&list->layout);
+  g_free (list->text);
+  if (list->matrix)
+    pango_matrix_free (list->matrix);
+  g_free (list);
+}
+
+/**
+ * pango_render_list_is_current:
+ * @list: a `PangoRenderList`
+ * @layout: a `PangoLayout`
+ *
+ * Returns whether @list was recorded from @layout, and @layout
+ * has not changed since.
+ *
+ * This compares the serial of @layout, see [method@Pango.Layout.get_serial].
+ *
+ * Return value: %TRUE if drawing @list gives the same result as
+ *   drawing @layout
+ *
+ * Since: 1.56
+ */
+gboolean
+pango_render_list_is_current (PangoRenderList *list,
+                              PangoLayout     *layout)
+{
+  PangoLayout *recorded;
+  gboolean is_current;
+
+  g_return_val_if_fail (list != NULL, FALSE);
+  g_return_val_if_fail (PANGO_IS_LAYOUT (layout), FALSE);
+
+  recorded = g_weak_ref_get (&list->layout);
+  is_current = recorded == layout &&
+               list->serial == pango_layout_get_serial (layout);
+  g_clear_object (&recorded);
+
+  return is_current;
+}
+
+static void
+set_op_color (PangoRenderer  *renderer,
+              const RenderOp *op)
+{
+  pango_renderer_set_color (renderer, op->part, op->color_set ? &op->color : NULL);
+  pango_renderer_set_alpha (renderer, op->part, op->alpha);
+}
+
+/**
+ * pango_renderer_draw_render_list:
+ * @renderer: a `PangoRenderer`
+ * @list: a `PangoRenderList`
+ * @x: X position of the top left corner of the layout the list
+ *   was recorded from, in user space coordinates in Pango units.
+ * @y: Y position of the top left corner of the layout the list
+ *   was recorded from, in user space coordinates in Pango units.
+ *
+ * Draws what was recorded in @list with the specified `PangoRenderer`.
+ *
+ * This gives the same result as drawing the layout that @list was
+ * recorded from with [method@Pango.Renderer.draw_layout], at the time
+ * it was recorded.
+ *
+ * The colors of the recorded parts are the ones the default
+ * `prepare_run` implementation picks from the attributes of the
+ * layout. Since no runs are drawn, the `prepare_run` vfunc of
+ * @renderer is not called, so subclasses that set colors there
+ * should draw the layout instead.
+ *
+ * Shapes are drawn with the `draw_shape` vfunc of @renderer, and
+ * [method@Pango.Renderer.get_layout] returns a copy of the layout
+ * as it was when @list was recorded.
+ *
+ * Since: 1.56
+ */
+void
+pango_renderer_draw_render_list (PangoRenderer   *renderer,
+                                 PangoRenderList *list,
+                                 int              x,
+                                 int              y)
+{
+  PangoRendererClass *klass;
+  double dx, dy;
+
+  g_return_if_fail (PANGO_IS_RENDERER (renderer));
+  g_return_if_fail (list != NULL);
+
+  if (!renderer->active_count)
+    pango_renderer_set_matrix (renderer, list->matrix);
+
+  pango_renderer_activate (renderer);
+
+  klass = PANGO_RENDERER_GET_CLASS (renderer);
+
+  /* Trapezoids are in device space */
+  dx = (double) x / PANGO_SCALE;
+  dy = (double) y / PANGO_SCALE;
+  if (renderer->matrix)
+    pango_matrix_transform_distance (renderer->matrix, &dx, &dy);
+
+  for (guint i = 0; i < list->n_ops; i++)
+    {
+      const RenderOp *op = &list->ops[i];
+
+      set_op_color (renderer, op);
+
+      switch ((RenderOpType) op->type)
+        {
+        case RENDER_OP_GLYPHS:
+          pango_renderer_draw_glyphs (renderer,
+                                      op->glyphs.font,
+                                      op->glyphs.glyphs,
+                                      x + op->glyphs.x,
+                                      y + op->glyphs.y);
+          break;
+
+        case RENDER_OP_GLYPH_ITEM:
+          pango_renderer_draw_glyph_item (renderer,
+                                          list->text,
+                                          op->glyph_item.glyph_item,
+                                          x + op->glyph_item.x,
+                                          y + op->glyph_item.y);
+          break;
+
+        case RENDER_OP_RECTANGLE:
+          pango_renderer_draw_rectangle (renderer,
+                                         op->part,
+                                         x + op->rectangle.x,
+                                         y + op->rectangle.y,
+                                         op->rectangle.width,
+                                         op->rectangle.height);
+          break;
+
+        case RENDER_OP_TRAPEZOID:
+          pango_renderer_draw_trapezoid (renderer,
+                                         op->part,
+                                         dy + op->trapezoid.y1,
+                                         dx + op->trapezoid.x11,
+                                         dx + op->trapezoid.x21,
+                                         dy + op->trapezoid.y2,
+                                         dx + op->trapezoid.x12,
+                                         dx + op->trapezoid.x22);
+          break;
+
+        case RENDER_OP_ERROR_UNDERLINE:
+          pango_renderer_draw_error_underline (renderer,
+                                               x + op->rectangle.x,
+                                               y + op->rectangle.y,
+                                               op->rectangle.width,
+                                               op->rectangle.height);
+          break;
+
+        case RENDER_OP_SHAPE:
+          if (klass->draw_shape)
+            {
+              renderer->priv->line = op->shape.line;
+              renderer->priv->layout = op->shape.layout;
+              klass->draw_shape (renderer,
+                                 op->shape.attr,
+                                 x + op->shape.x,
+                                 y + op->shape.y);
+              renderer->priv->line = NULL;
+              renderer->priv->layout = NULL;
+            }
+          break;
+
+        default:
+          g_assert_not_reached ();
+        }
+    }
+
+  pango_renderer_deactivate (renderer);
+}
@@ -202,6 +202,12 @@ void pango_renderer_draw_layout          (PangoRenderer    *renderer,
                                           PangoLayout      *layout,
                                           int               x,
                                           int               y);
+PANGO_AVAILABLE_IN_1_56
+void pango_renderer_draw_layout_clipped  (PangoRenderer        *renderer,
+                                          PangoLayout          *layout,
+                                          int                   x,
+                                          int                   y,
+                                          const PangoRectangle *clip);
 PANGO_AVAILABLE_IN_1_8
 void pango_renderer_draw_layout_line     (PangoRenderer    *renderer,
                                           PangoLayoutLine  *line,
@@ -284,6 +290,30 @@ PangoLayout       *pango_renderer_get_layout      (PangoRenderer     *renderer);
 PANGO_AVAILABLE_IN_1_20
 PangoLayoutLine   *pango_renderer_get_layout_line (PangoRenderer     *renderer);
 
+typedef struct _PangoRenderList PangoRenderList;
+
+#define PANGO_TYPE_RENDER_LIST (pango_render_list_get_type ())
+
+PANGO_AVAILABLE_IN_1_56
+GType            pango_render_list_get_type   (void) G_GNUC_CONST;
+PANGO_AVAILABLE_IN_1_56
+PangoRenderList *pango_render_list_new        (PangoLayout     *layout);
+PANGO_AVAILABLE_IN_1_56
+PangoRenderList *pango_render_list_ref        (PangoRenderList *list);
+PANGO_AVAILABLE_IN_1_56
+void             pango_render_list_unref      (PangoRenderList *list);
+PANGO_AVAILABLE_IN_1_56
+gboolean         pango_render_list_is_current (PangoRenderList *list,
+                                               PangoLayout     *layout);
+
+PANGO_AVAILABLE_IN_1_56
+void pango_renderer_draw_render_list (PangoRenderer   *renderer,
+                                      PangoRenderList *list,
+                                      int              x,
+                                      int              y);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(PangoRenderList, pango_render_list_unref)
+
 G_END_DECLS
 
 #endif /* __PANGO_RENDERER_H_ */
@@ -24,6 +24,27 @@
 
 #define PAREN_STACK_DEPTH 128
 
+/* Per-character properties decoded once up front by the itemizer,
+ * so that the script, emoji and width iterators don't each have to
+ * walk and decode the text on their own.
+ */
+typedef enum
+{
+  PANGO_CHAR_PROP_CLUSTER_EXTENDER = 1 << 0,
+  PANGO_CHAR_PROP_SPACE            = 1 << 1,
+  PANGO_CHAR_PROP_UPRIGHT          = 1 << 2,
+  PANGO_CHAR_PROP_ZWJ              = 1 << 3,
+  PANGO_CHAR_PROP_WIDTH_EXTENDER   = 1 << 4,
+} PangoCharPropFlags;
+
+typedef struct _PangoCharProps PangoCharProps;
+
+struct _PangoCharProps
+{
+  guint8 script;
+  guint8 flags;
+};
+
 typedef struct _ParenStackEntry ParenStackEntry;
 
 struct _ParenStackEntry
@@ -43,6 +64,9 @@ struct _PangoScriptIter
 
   ParenStackEntry paren_stack[PAREN_STACK_DEPTH];
   int paren_sp;
+
+  const PangoCharProps *props;
+  int offset;
 };
 
 PangoScriptIter *
@@ -50,6 +74,16 @@ _pango_script_iter_init (PangoScriptIter *iter,
 	                 const char      *text,
 			 int              length);
 
+PangoScriptIter *
+_pango_script_iter_init_with_props (PangoScriptIter      *iter,
+                                    const char           *text,
+                                    int                   length,
+                                    const PangoCharProps *props);
+
+gboolean
+_pango_script_is_cluster_extender (gunichar      ch,
+                                   GUnicodeType  type);
+
 void
 _pango_script_iter_fini (PangoScriptIter *iter);
 
@@ -101,6 +101,18 @@ PangoScriptIter *
 _pango_script_iter_init (PangoScriptIter *iter,
 	                 const char      *text,
 			 int              length)
+{
+  return _pango_script_iter_init_with_props (iter, text, length, NULL);
+}
+
+/* @props, if not %NULL, holds the decoded properties of each
+ * character in @text, and must outlive the iterator.
+ */
+PangoScriptIter *
+_pango_script_iter_init_with_props (PangoScriptIter      *iter,
+                                    const char           *text,
+                                    int                   length,
+                                    const PangoCharProps *props)
 {
   iter->text_start = text;
   if (length >= 0)
@@ -114,6 +126,9 @@ _pango_script_iter_init (PangoScriptIter *iter,
 
   iter->paren_sp = -1;
 
+  iter->props = props;
+  iter->offset = 0;
+
   pango_script_iter_next (iter);
 
   return iter;
@@ -286,10 +301,10 @@ get_pair_index (gunichar ch)
   return -1;
 }
 
-static gboolean
-is_cluster_extender (gunichar ch)
+gboolean
+_pango_script_is_cluster_extender (gunichar     ch,
+                                   GUnicodeType type)
 {
-  GUnicodeType type = g_unichar_type (ch);
   return (type >= G_UNICODE_SPACING_MARK && type <= G_UNICODE_NON_SPACING_MARK) ||
 	 (ch >= 0x200C && ch <= 0x200D) ||    /* ZWJ, ZWNJ */
 	 (ch >= 0xFF9E && ch <= 0xFF9F) ||    /* katakana sound marks */
@@ -301,14 +316,16 @@ is_cluster_extender (gunichar ch)
 #define REAL_SCRIPT(script) \
   ((script) > PANGO_SCRIPT_INHERITED && (script) != PANGO_SCRIPT_UNKNOWN)
 
-#define IS_CLUSTER_EXTENDER(ch) \
-  g_unichar_type (ch)
+#define IS_CLUSTER_EXTENDER(iter, ch) \
+  ((iter)->props ? \
+   ((iter)->props[(iter)->offset].flags & PANGO_CHAR_PROP_CLUSTER_EXTENDER) != 0 : \
+   _pango_script_is_cluster_extender ((ch), g_unichar_type (ch)))
 
 /* TODO: Use Unicode ScriptExtensions */
-#define SAME_SCRIPT(script1, script2, ch) \
+#define SAME_SCRIPT(script1, script2, is_extender) \
   (!REAL_SCRIPT (script1) || !REAL_SCRIPT (script2) || \
    (script1) == (script2) || \
-   is_cluster_extender (ch))
+   (is_extender))
 
 #define IS_OPEN(pair_index) (((pair_index) & 1) == 0)
 
@@ -337,13 +354,25 @@ pango_script_iter_next (PangoScriptIter *iter)
   iter->script_code = PANGO_SCRIPT_COMMON;
   iter->script_start = iter->script_end;
 
-  for (; iter->script_end < iter->text_end; iter->script_end = g_utf8_next_char (iter->script_end))
+  for (; iter->script_end < iter->text_end; iter->script_end = g_utf8_next_char (iter->script_end), iter->offset++)
     {
-      gunichar ch = g_utf8_get_char (iter->script_end);
+      gunichar ch = 0;
       PangoScript sc;
       int pair_index;
 
-      sc = (PangoScript)g_unichar_get_script (ch);
+      if (iter->props)
+        {
+          /* Only decode the characters that can be paired punctuation */
+          sc = (PangoScript)iter->props[iter->offset].script;
+          if (sc == PANGO_SCRIPT_COMMON)
+            ch = g_utf8_get_char (iter->script_end);
+        }
+      else
+        {
+          ch = g_utf8_get_char (iter->script_end);
+          sc = (PangoScript)g_unichar_get_script (ch);
+        }
+
       if (sc != PANGO_SCRIPT_COMMON)
 	pair_index = -1;
       else
@@ -389,7 +418,7 @@ pango_script_iter_next (PangoScriptIter *iter)
 	    }
 	}
 
-      if (SAME_SCRIPT (iter->script_code, sc, ch))
+      if (SAME_SCRIPT (iter->script_code, sc, IS_CLUSTER_EXTENDER (iter, ch)))
 	{
 	  if (!REAL_SCRIPT (iter->script_code) && REAL_SCRIPT (sc))
 	    {
@@ -54,6 +54,10 @@ const char *   pango_get_sysconf_subdirectory (void) G_GNUC_PURE;
 PANGO_DEPRECATED
 const char *   pango_get_lib_subdirectory (void) G_GNUC_PURE;
 
+gboolean pango_log2vis_text_is_ltr (const char     *text,
+                                    int             length,
+                                    PangoDirection  base_dir);
+
 void pango_log2vis_fill_embedding_levels (const char     *text,
                                           int             length,
                                           unsigned int    n_chars,
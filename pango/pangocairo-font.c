@@ -498,6 +498,7 @@ _pango_cairo_font_private_get_hex_box_info (PangoCairoFontPrivate *cf_priv)
   hbi = g_slice_new (PangoCairoFontHexBoxInfo);
   hbi->font = (PangoCairoFont *) mini_font;
   hbi->rows = rows;
+  hbi->boxes = NULL;
 
   hbi->digit_width  = width;
   hbi->digit_height = height;
@@ -545,6 +546,7 @@ _pango_cairo_font_hex_box_info_destroy (PangoCairoFontHexBoxInfo *hbi)
   if (hbi)
     {
       g_object_unref (hbi->font);
+      g_clear_pointer (&hbi->boxes, g_hash_table_unref);
       g_slice_free (PangoCairoFontHexBoxInfo, hbi);
     }
 }
@@ -847,6 +849,68 @@ _pango_cairo_font_private_get_glyph_extents_cache_entry (PangoCairoFontPrivate
   return entry;
 }
 
+/* The batched version of _pango_cairo_font_private_get_glyph_extents().
+ * All glyphs except hex boxes share the logical y and height of the
+ * font, so we only need to look at the cache for the ink rects.
+ */
+void
+_pango_cairo_font_private_get_glyphs_extents (PangoCairoFontPrivate *cf_priv,
+					      const PangoGlyphInfo  *glyphs,
+					      int                    n_glyphs,
+					      PangoRectangle        *ink_rects,
+					      PangoRectangle        *logical_rect)
+{
+  gboolean have_logical = FALSE;
+  int i;
+
+  if (!cf_priv ||
+      (cf_priv->glyph_extents_cache == NULL &&
+       !_pango_cairo_font_private_glyph_extents_cache_init (cf_priv)))
+    {
+      pango_font_get_glyphs_extents (NULL, glyphs, n_glyphs, ink_rects, logical_rect);
+      return;
+    }
+
+  for (i = 0; i < n_glyphs; i++)
+    {
+      PangoGlyph glyph = glyphs[i].glyph;
+
+      if (glyph & PANGO_GLYPH_UNKNOWN_FLAG)
+	{
+	  PangoRectangle glyph_logical;
+
+	  _pango_cairo_font_private_get_glyph_extents_missing (cf_priv, glyph,
+							       ink_rects ? &ink_rects[i] : NULL,
+							       logical_rect ? &glyph_logical : NULL);
+	  if (logical_rect)
+	    {
+	      pango_font_add_logical_extents (logical_rect, &glyph_logical, !have_logical);
+	      have_logical = TRUE;
+	    }
+	  continue;
+	}
+
+      if (ink_rects)
+	{
+	  if (glyph == PANGO_GLYPH_EMPTY)
+	    ink_rects[i].x = ink_rects[i].y = ink_rects[i].width = ink_rects[i].height = 0;
+	  else
+	    ink_rects[i] = _pango_cairo_font_private_get_glyph_extents_cache_entry (cf_priv, glyph)->ink_rect;
+	}
+
+      if (logical_rect)
+	{
+	  pango_font_add_logical_extents (logical_rect, &cf_priv->font_extents, !have_logical);
+	  have_logical = TRUE;
+	}
+      else if (!ink_rects)
+	break;
+    }
+
+  if (logical_rect && !have_logical)
+    logical_rect->y = logical_rect->height = 0;
+}
+
 void
 _pango_cairo_font_private_get_glyph_extents (PangoCairoFontPrivate *cf_priv,
 					     PangoGlyph             glyph,
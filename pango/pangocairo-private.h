@@ -63,6 +63,9 @@ struct _PangoCairoFontHexBoxInfo
   double line_width;
   double box_descent;
   double box_height;
+
+  /* Rendered boxes, see pangocairo-render.c */
+  GHashTable *boxes;
 };
 
 struct _PangoCairoFontPrivateScaledFontData
@@ -121,6 +124,11 @@ void _pango_cairo_font_private_get_glyph_extents (PangoCairoFontPrivate *cf_priv
 						  PangoGlyph             glyph,
 						  PangoRectangle        *ink_rect,
 						  PangoRectangle        *logical_rect);
+void _pango_cairo_font_private_get_glyphs_extents (PangoCairoFontPrivate *cf_priv,
+						   const PangoGlyphInfo  *glyphs,
+						   int                    n_glyphs,
+						   PangoRectangle        *ink_rects,
+						   PangoRectangle        *logical_rect);
 
 #define PANGO_TYPE_CAIRO_RENDERER            (pango_cairo_renderer_get_type())
 #define PANGO_CAIRO_RENDERER(object)         (G_TYPE_CHECK_INSTANCE_CAST ((object), PANGO_TYPE_CAIRO_RENDERER, PangoCairoRenderer))
@@ -94,9 +94,10 @@ set_color (PangoCairoRenderer *crenderer,
   cairo_set_source_rgba (crenderer->cr, red, green, blue, alpha);
 }
 
-/* note: modifies crenderer->cr without doing cairo_save/restore() */
+/* note: modifies cr without doing cairo_save/restore() */
 static void
-_pango_cairo_renderer_draw_frame (PangoCairoRenderer *crenderer,
+_pango_cairo_renderer_draw_frame (cairo_t            *cr,
+				  gboolean            do_path,
 				  double              x,
 				  double              y,
 				  double              width,
@@ -104,9 +105,7 @@ _pango_cairo_renderer_draw_frame (PangoCairoRenderer *crenderer,
 				  double              line_width,
 				  gboolean            invalid)
 {
-  cairo_t *cr = crenderer->cr;
-
-  if (crenderer->do_path)
+  if (do_path)
     {
       double d2 = line_width * .5, d = line_width;
 
@@ -206,15 +205,16 @@ _pango_cairo_renderer_draw_frame (PangoCairoRenderer *crenderer,
 }
 
 static void
-_pango_cairo_renderer_draw_box_glyph (PangoCairoRenderer *crenderer,
+_pango_cairo_renderer_draw_box_glyph (cairo_t            *cr,
+				      gboolean            do_path,
 				      PangoGlyphInfo     *gi,
 				      double              cx,
 				      double              cy,
 				      gboolean            invalid)
 {
-  cairo_save (crenderer->cr);
+  cairo_save (cr);
 
-  _pango_cairo_renderer_draw_frame (crenderer,
+  _pango_cairo_renderer_draw_frame (cr, do_path,
 				    cx + 1.5,
 				    cy + 1.5 - PANGO_UNKNOWN_GLYPH_HEIGHT,
 				    (double)gi->geometry.width / PANGO_SCALE - 3.0,
@@ -222,11 +222,12 @@ _pango_cairo_renderer_draw_box_glyph (PangoCairoRenderer *crenderer,
 				    1.0,
 				    invalid);
 
-  cairo_restore (crenderer->cr);
+  cairo_restore (cr);
 }
 
 static void
-_pango_cairo_renderer_draw_unknown_glyph (PangoCairoRenderer *crenderer,
+_pango_cairo_renderer_draw_unknown_glyph (cairo_t            *cr,
+					  gboolean            do_path,
 					  PangoFont          *font,
 					  PangoGlyphInfo     *gi,
 					  double              cx,
@@ -244,15 +245,15 @@ _pango_cairo_renderer_draw_unknown_glyph (PangoCairoRenderer *crenderer,
   const char *p;
   const char *name;
 
-  cairo_save (crenderer->cr);
+  cairo_save (cr);
 
   ch = gi->glyph & ~PANGO_GLYPH_UNKNOWN_FLAG;
   invalid_input = G_UNLIKELY (gi->glyph == PANGO_GLYPH_INVALID_INPUT || ch > 0x10FFFF);
 
   hbi = _pango_cairo_font_get_hex_box_info ((PangoCairoFont *)font);
-  if (!hbi || !_pango_cairo_font_install ((PangoFont *)(hbi->font), crenderer->cr))
+  if (!hbi || !_pango_cairo_font_install ((PangoFont *)(hbi->font), cr))
     {
-      _pango_cairo_renderer_draw_box_glyph (crenderer, gi, cx, cy, invalid_input);
+      _pango_cairo_renderer_draw_box_glyph (cr, do_path, gi, cx, cy, invalid_input);
       goto done;
     }
 
@@ -274,10 +275,10 @@ _pango_cairo_renderer_draw_unknown_glyph (PangoCairoRenderer *crenderer,
       double x = cx + 0.5 *((double)gi->geometry.width / PANGO_SCALE);
       double y = cy + hbi->box_descent - 0.5 * hbi->box_height;
 
-      cairo_new_sub_path (crenderer->cr);
-      cairo_arc (crenderer->cr, x, y, 1.5 * hbi->line_width, 0, 2 * G_PI);
-      cairo_close_path (crenderer->cr);
-      cairo_fill (crenderer->cr);
+      cairo_new_sub_path (cr);
+      cairo_arc (cr, x, y, 1.5 * hbi->line_width, 0, 2 * G_PI);
+      cairo_close_path (cr);
+      cairo_fill (cr);
       goto done;
     }
   else if (ch == '\t')
@@ -294,19 +295,19 @@ _pango_cairo_renderer_draw_unknown_glyph (PangoCairoRenderer *crenderer,
       double tw2 = 2.5 * hbi->line_width; /* tip width / 2 */
       double lw2 = 0.5 * hbi->line_width; /* line width / 2 */
 
-      cairo_move_to (crenderer->cr, x - lw2, y - tw2);
-      cairo_line_to (crenderer->cr, x + lw2, y - tw2);
-      cairo_line_to (crenderer->cr, x + lw2, y - lw2);
-      cairo_line_to (crenderer->cr, x + al - tl, y - lw2);
-      cairo_line_to (crenderer->cr, x + al - tl, y - tw2);
-      cairo_line_to (crenderer->cr, x + al,  y);
-      cairo_line_to (crenderer->cr, x + al - tl, y + tw2);
-      cairo_line_to (crenderer->cr, x + al - tl, y + lw2);
-      cairo_line_to (crenderer->cr, x + lw2, y + lw2);
-      cairo_line_to (crenderer->cr, x + lw2, y + tw2);
-      cairo_line_to (crenderer->cr, x - lw2, y + tw2);
-      cairo_close_path (crenderer->cr);
-      cairo_fill (crenderer->cr);
+      cairo_move_to (cr, x - lw2, y - tw2);
+      cairo_line_to (cr, x + lw2, y - tw2);
+      cairo_line_to (cr, x + lw2, y - lw2);
+      cairo_line_to (cr, x + al - tl, y - lw2);
+      cairo_line_to (cr, x + al - tl, y - tw2);
+      cairo_line_to (cr, x + al,  y);
+      cairo_line_to (cr, x + al - tl, y + tw2);
+      cairo_line_to (cr, x + al - tl, y + lw2);
+      cairo_line_to (cr, x + lw2, y + lw2);
+      cairo_line_to (cr, x + lw2, y + tw2);
+      cairo_line_to (cr, x - lw2, y + tw2);
+      cairo_close_path (cr);
+      cairo_fill (cr);
       goto done;
     }
   else if (ch == '\n' || ch == 0x2028 || ch == 0x2029)
@@ -324,17 +325,17 @@ _pango_cairo_renderer_draw_unknown_glyph (PangoCairoRenderer *crenderer,
       double y = cy - (hbi->box_height - al) / 2;
       double lw2 = 0.5 * hbi->line_width; /* line width / 2 */
 
-      cairo_move_to (crenderer->cr, x, y);
-      cairo_line_to (crenderer->cr, x + tl, y - tw2);
-      cairo_line_to (crenderer->cr, x + tl, y - lw2);
-      cairo_line_to (crenderer->cr, x + al - lw2, y - lw2);
-      cairo_line_to (crenderer->cr, x + al - lw2, y - ah);
-      cairo_line_to (crenderer->cr, x + al + lw2, y - ah);
-      cairo_line_to (crenderer->cr, x + al + lw2, y + lw2);
-      cairo_line_to (crenderer->cr, x + tl, y + lw2);
-      cairo_line_to (crenderer->cr, x + tl, y + tw2);
-      cairo_close_path (crenderer->cr);
-      cairo_fill (crenderer->cr);
+      cairo_move_to (cr, x, y);
+      cairo_line_to (cr, x + tl, y - tw2);
+      cairo_line_to (cr, x + tl, y - lw2);
+      cairo_line_to (cr, x + al - lw2, y - lw2);
+      cairo_line_to (cr, x + al - lw2, y - ah);
+      cairo_line_to (cr, x + al + lw2, y - ah);
+      cairo_line_to (cr, x + al + lw2, y + lw2);
+      cairo_line_to (cr, x + tl, y + lw2);
+      cairo_line_to (cr, x + tl, y + tw2);
+      cairo_close_path (cr);
+      cairo_fill (cr);
       goto done;
     }
   else if ((name = pango_get_ignorable_size (ch, &rows, &cols)))
@@ -356,7 +357,7 @@ _pango_cairo_renderer_draw_unknown_glyph (PangoCairoRenderer *crenderer,
   lsb = ((double)gi->geometry.width / PANGO_SCALE - width) * .5;
   lsb = floor (lsb / hbi->pad_x) * hbi->pad_x;
 
-  _pango_cairo_renderer_draw_frame (crenderer,
+  _pango_cairo_renderer_draw_frame (cr, do_path,
 				    cx + lsb + 1.5 * hbi->pad_x,
 				    cy + hbi->box_descent - hbi->box_height + hbi->pad_y * .5,
 				    width - hbi->pad_x,
@@ -380,19 +381,141 @@ _pango_cairo_renderer_draw_unknown_glyph (PangoCairoRenderer *crenderer,
           if (!p)
             goto done;
 
-	  cairo_move_to (crenderer->cr, x, y);
+	  cairo_move_to (cr, x, y);
 
           hexbox_string[0] = p[0];
 
-	  if (crenderer->do_path)
-	      cairo_text_path (crenderer->cr, hexbox_string);
+	  if (do_path)
+	      cairo_text_path (cr, hexbox_string);
 	  else
-	      cairo_show_text (crenderer->cr, hexbox_string);
+	      cairo_show_text (cr, hexbox_string);
 	}
     }
 
 done:
-  cairo_restore (crenderer->cr);
+  cairo_restore (cr);
+}
+
+/* Hex boxes are expensive to draw: a frame and a handful of
+ * digits, each a separate cairo call. Text with binary junk or
+ * unsupported scripts can have thousands of them, but few distinct
+ * ones, so each box is drawn once into a recording surface, which
+ * is then used as a mask with the current source wherever that
+ * box appears. Once the cache of a font is full, boxes that are not
+ * in it yet are drawn directly; recording a box that is only used
+ * once is slower than drawing it.
+ */
+#define HEX_BOX_CACHE_SIZE 256
+
+typedef struct
+{
+  PangoGlyph glyph;
+  int width;
+  cairo_antialias_t antialias;
+} HexBoxKey;
+
+static guint
+hex_box_key_hash (gconstpointer v)
+{
+  const HexBoxKey *key = v;
+
+  return key->glyph ^ ((guint) key->width * 16777619) ^ ((guint) key->antialias << 28);
+}
+
+static gboolean
+hex_box_key_equal (gconstpointer v1,
+                   gconstpointer v2)
+{
+  const HexBoxKey *key1 = v1;
+  const HexBoxKey *key2 = v2;
+
+  return key1->glyph == key2->glyph &&
+         key1->width == key2->width &&
+         key1->antialias == key2->antialias;
+}
+
+G_LOCK_DEFINE_STATIC (hex_boxes);
+
+/* Returns NULL if the box is not cached and the cache is full */
+static cairo_surface_t *
+get_hex_box (PangoCairoFontHexBoxInfo *hbi,
+             PangoFont                *font,
+             PangoGlyphInfo           *gi,
+             cairo_antialias_t         antialias)
+{
+  HexBoxKey key = { gi->glyph, gi->geometry.width, antialias };
+  cairo_surface_t *box;
+  cairo_rectangle_t extents;
+  double height;
+  cairo_t *cr;
+
+  G_LOCK (hex_boxes);
+  if (!hbi->boxes)
+    hbi->boxes = g_hash_table_new_full (hex_box_key_hash, hex_box_key_equal,
+                                        g_free, (GDestroyNotify) cairo_surface_destroy);
+  box = g_hash_table_lookup (hbi->boxes, &key);
+  if (box)
+    cairo_surface_reference (box);
+  else if (g_hash_table_size (hbi->boxes) >= HEX_BOX_CACHE_SIZE)
+    {
+      G_UNLOCK (hex_boxes);
+      return NULL;
+    }
+  G_UNLOCK (hex_boxes);
+
+  if (box)
+    return box;
+
+  /* Boxes, dots and arrows stay within the glyph width and the
+   * box height, or the size of the fallback box glyph. Bound the
+   * surface with a generous margin around that, so cairo doesn't
+   * have to replay it to find its extents when masking with it
+   */
+  height = MAX (hbi->box_height, PANGO_UNKNOWN_GLYPH_HEIGHT);
+  extents.x = - height;
+  extents.y = - 2 * height;
+  extents.width = MAX ((double) gi->geometry.width / PANGO_SCALE, 0) + 2 * height;
+  extents.height = 3 * height;
+
+  box = cairo_recording_surface_create (CAIRO_CONTENT_ALPHA, &extents);
+  cr = cairo_create (box);
+  cairo_set_antialias (cr, antialias);
+  _pango_cairo_renderer_draw_unknown_glyph (cr, FALSE, font, gi, 0, 0);
+  cairo_destroy (cr);
+
+  G_LOCK (hex_boxes);
+  g_hash_table_replace (hbi->boxes,
+                        g_memdup2 (&key, sizeof (HexBoxKey)),
+                        cairo_surface_reference (box));
+  G_UNLOCK (hex_boxes);
+
+  return box;
+}
+
+/* Draws an unknown glyph with the current source, from
+ * the cache when possible
+ */
+static void
+draw_hex_box (PangoCairoRenderer *crenderer,
+              PangoFont          *font,
+              PangoGlyphInfo     *gi,
+              double              cx,
+              double              cy)
+{
+  PangoCairoFontHexBoxInfo *hbi;
+  cairo_surface_t *box;
+
+  if (crenderer->do_path ||
+      !(hbi = _pango_cairo_font_get_hex_box_info ((PangoCairoFont *)font)) ||
+      !(box = get_hex_box (hbi, font, gi, cairo_get_antialias (crenderer->cr))))
+    {
+      _pango_cairo_renderer_draw_unknown_glyph (crenderer->cr, crenderer->do_path,
+                                                font, gi, cx, cy);
+      return;
+    }
+
+  cairo_mask_surface (crenderer->cr, box, cx, cy);
+  cairo_surface_destroy (box);
 }
 
 #ifndef STACK_BUFFER_SIZE
@@ -439,7 +562,7 @@ pango_cairo_renderer_show_text_glyphs (PangoRenderer        *renderer,
 			  base_y :
 			  base_y + (double)(gi->geometry.y_offset) / PANGO_SCALE;
 
-	      _pango_cairo_renderer_draw_unknown_glyph (crenderer, font, gi, cx, cy);
+	      draw_hex_box (crenderer, font, gi, cx, cy);
 	    }
 	  x_position += gi->geometry.width;
 	}
@@ -469,7 +592,7 @@ pango_cairo_renderer_show_text_glyphs (PangoRenderer        *renderer,
               if (gi->glyph == (0x20 | PANGO_GLYPH_UNKNOWN_FLAG))
                 ; /* no hex boxes for space, please */
               else
-	        _pango_cairo_renderer_draw_unknown_glyph (crenderer, font, gi, cx, cy);
+	        draw_hex_box (crenderer, font, gi, cx, cy);
             }
 	  else
 	    {
@@ -1004,7 +1127,49 @@ _pango_cairo_do_layout (cairo_t     *cr,
   crenderer->do_path = do_path;
   save_current_point (crenderer);
 
-  pango_renderer_draw_layout (renderer, layout, 0, 0);
+  /* Only draw what shows up in the clip. Text that is drawn with
+   * show_text_glyphs is kept whole, as it is searchable and can be
+   * copied from the output even where it is not visible.
+   */
+  if (!do_path && !crenderer->has_show_text_glyphs)
+    {
+      PangoRectangle clip;
+      double x1, y1, x2, y2;
+
+      cairo_clip_extents (cr, &x1, &y1, &x2, &y2);
+
+      x1 = CLAMP ((x1 - crenderer->x_offset) * PANGO_SCALE, G_MININT / 2, G_MAXINT / 2);
+      y1 = CLAMP ((y1 - crenderer->y_offset) * PANGO_SCALE, G_MININT / 2, G_MAXINT / 2);
+      x2 = CLAMP ((x2 - crenderer->x_offset) * PANGO_SCALE, G_MININT / 2, G_MAXINT / 2);
+      y2 = CLAMP ((y2 - crenderer->y_offset) * PANGO_SCALE, G_MININT / 2, G_MAXINT / 2);
+
+      clip.x = floor (x1);
+      clip.y = floor (y1);
+      clip.width = ceil (x2) - clip.x;
+      clip.height = ceil (y2) - clip.y;
+
+      pango_renderer_draw_layout_clipped (renderer, layout, 0, 0, &clip);
+    }
+  else
+    pango_renderer_draw_layout (renderer, layout, 0, 0);
+
+  restore_current_point (crenderer);
+
+  release_renderer (crenderer);
+}
+
+static void
+_pango_cairo_do_render_list (cairo_t         *cr,
+			     PangoRenderList *list)
+{
+  PangoCairoRenderer *crenderer = acquire_renderer ();
+  PangoRenderer *renderer = (PangoRenderer *) crenderer;
+
+  crenderer->cr = cr;
+  crenderer->do_path = FALSE;
+  save_current_point (crenderer);
+
+  pango_renderer_draw_render_list (renderer, list, 0, 0);
 
   restore_current_point (crenderer);
 
@@ -1127,6 +1292,9 @@ pango_cairo_show_layout_line (cairo_t          *cr,
  * The top-left corner of the `PangoLayout` will be drawn
  * at the current point of the cairo context.
  *
+ * Lines and runs that lie entirely outside the clip region
+ * of @cr are skipped.
+ *
  * Since: 1.10
  */
 void
@@ -1139,6 +1307,31 @@ pango_cairo_show_layout (cairo_t     *cr,
   _pango_cairo_do_layout (cr, layout, FALSE);
 }
 
+/**
+ * pango_cairo_show_render_list:
+ * @cr: a Cairo context
+ * @list: a `PangoRenderList`
+ *
+ * Draws a `PangoRenderList` in the specified cairo context.
+ *
+ * The top-left corner of the layout that @list was recorded
+ * from will be drawn at the current point of the cairo context.
+ * The result is the same as drawing the layout itself with
+ * [func@PangoCairo.show_layout], without walking its lines
+ * and runs again.
+ *
+ * Since: 1.56
+ */
+void
+pango_cairo_show_render_list (cairo_t         *cr,
+			      PangoRenderList *list)
+{
+  g_return_if_fail (cr != NULL);
+  g_return_if_fail (list != NULL);
+
+  _pango_cairo_do_render_list (cr, list);
+}
+
 /**
  * pango_cairo_show_error_underline:
  * @cr: a Cairo context
@@ -186,6 +186,9 @@ void pango_cairo_show_layout_line  (cairo_t          *cr,
 PANGO_AVAILABLE_IN_1_10
 void pango_cairo_show_layout       (cairo_t          *cr,
 				    PangoLayout      *layout);
+PANGO_AVAILABLE_IN_1_56
+void pango_cairo_show_render_list  (cairo_t          *cr,
+				    PangoRenderList  *list);
 
 PANGO_AVAILABLE_IN_1_14
 void pango_cairo_show_error_underline (cairo_t       *cr,
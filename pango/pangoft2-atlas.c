@@ -0,0 +1,724 @@
+/* Pango
+ * pangoft2-atlas.c: Rendering to a glyph atlas
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include "config.h"
+#include <math.h>
+#include <string.h>
+
+#include "pangoft2-private.h"
+#include "pango-impl-utils.h"
+
+/* Glyphs are packed into shelves: horizontal strips of the atlas
+ * that are filled from left to right. When the atlas is full, the
+ * shelf that was used least recently is emptied and reused, unless
+ * it holds glyphs of the layout that is being rendered right now.
+ */
+
+#define SHELF_PADDING 1
+
+typedef struct _AtlasShelf AtlasShelf;
+typedef struct _AtlasGlyph AtlasGlyph;
+
+struct _AtlasShelf
+{
+  int y;
+  int height;
+  int x;                /* Start of the free space */
+  guint last_used;      /* Serial of the last render that used the shelf */
+  GPtrArray *glyphs;
+};
+
+struct _AtlasGlyph
+{
+  /* Key */
+  PangoFont *font;
+  PangoGlyph glyph;
+  int subpixel;
+
+  AtlasShelf *shelf;
+  PangoRectangle area;  /* In the atlas */
+  int bitmap_left;
+  int bitmap_top;
+};
+
+struct _PangoFT2Atlas
+{
+  int ref_count;
+
+  FT_Bitmap bitmap;
+  int subpixel_positions;
+
+  GHashTable *glyphs;   /* AtlasGlyph => itself */
+  GPtrArray *shelves;
+  int shelves_end;      /* Start of the space that no shelf uses yet */
+
+  guint serial;
+  PangoRectangle damage;
+
+  PangoRenderer *renderer;
+};
+
+G_DEFINE_BOXED_TYPE (PangoFT2Atlas, pango_ft2_atlas,
+                     pango_ft2_atlas_ref,
+                     pango_ft2_atlas_unref);
+
+static guint
+atlas_glyph_hash (gconstpointer key)
+{
+  const AtlasGlyph *g = key;
+
+  return g_direct_hash (g->font) ^ (g->glyph * 31) ^ g->subpixel;
+}
+
+static gboolean
+atlas_glyph_equal (gconstpointer a,
+                   gconstpointer b)
+{
+  const AtlasGlyph *ga = a;
+  const AtlasGlyph *gb = b;
+
+  return ga->font == gb->font &&
+         ga->glyph == gb->glyph &&
+         ga->subpixel == gb->subpixel;
+}
+
+static void
+atlas_glyph_free (AtlasGlyph *glyph)
+{
+  g_object_unref (glyph->font);
+  g_slice_free (AtlasGlyph, glyph);
+}
+
+static void
+atlas_shelf_free (AtlasShelf *shelf)
+{
+  g_ptr_array_unref (shelf->glyphs);
+  g_slice_free (AtlasShelf, shelf);
+}
+
+static void
+atlas_add_damage (PangoFT2Atlas        *atlas,
+                  const PangoRectangle *area)
+{
+  int x0, y0, x1, y1;
+
+  if (area->width <= 0 || area->height <= 0)
+    return;
+
+  if (atlas->damage.width == 0)
+    {
+      atlas->damage = *area;
+      return;
+    }
+
+  x0 = MIN (atlas->damage.x, area->x);
+  y0 = MIN (atlas->damage.y, area->y);
+  x1 = MAX (atlas->damage.x + atlas->damage.width, area->x + area->width);
+  y1 = MAX (atlas->damage.y + atlas->damage.height, area->y + area->height);
+
+  atlas->damage.x = x0;
+  atlas->damage.y = y0;
+  atlas->damage.width = x1 - x0;
+  atlas->damage.height = y1 - y0;
+}
+
+static AtlasShelf *
+atlas_add_shelf (PangoFT2Atlas *atlas,
+                 int            height)
+{
+  AtlasShelf *shelf;
+
+  shelf = g_slice_new (AtlasShelf);
+  shelf->y = atlas->shelves_end;
+  shelf->height = height;
+  shelf->x = 0;
+  shelf->last_used = 0;
+  shelf->glyphs = g_ptr_array_new ();
+
+  atlas->shelves_end += height;
+  g_ptr_array_add (atlas->shelves, shelf);
+
+  return shelf;
+}
+
+static void
+atlas_clear_shelf (PangoFT2Atlas *atlas,
+                   AtlasShelf    *shelf)
+{
+  PangoRectangle area;
+
+  /* The hash table owns the glyphs */
+  for (guint i = 0; i < shelf->glyphs->len; i++)
+    g_hash_table_remove (atlas->glyphs, g_ptr_array_index (shelf->glyphs, i));
+  g_ptr_array_set_size (shelf->glyphs, 0);
+
+  for (int y = shelf->y; y < shelf->y + shelf->height; y++)
+    memset (atlas->bitmap.buffer + y * atlas->bitmap.pitch, 0, shelf->x);
+
+  area.x = 0;
+  area.y = shelf->y;
+  area.width = shelf->x;
+  area.height = shelf->height;
+  atlas_add_damage (atlas, &area);
+
+  shelf->x = 0;
+}
+
+/* Finds room for a @width x @height bitmap, making some
+ * if needed. Returns %NULL if the atlas is full with glyphs
+ * of the current render.
+ */
+static AtlasShelf *
+atlas_allocate (PangoFT2Atlas *atlas,
+                int            width,
+                int            height,
+                int           *x)
+{
+  AtlasShelf *best = NULL;
+  int padded_width = width + SHELF_PADDING;
+  int padded_height = height + SHELF_PADDING;
+
+  if (padded_width > (int) atlas->bitmap.width)
+    return NULL;
+
+  /* The best fitting shelf that has room, not wasting too much height */
+  for (guint i = 0; i < atlas->shelves->len; i++)
+    {
+      AtlasShelf *shelf = g_ptr_array_index (atlas->shelves, i);
+
+      if (shelf->height < padded_height ||
+          shelf->height > padded_height * 2 ||
+          shelf->x + padded_width > (int) atlas->bitmap.width)
+        continue;
+
+      if (!best || shelf->height < best->height)
+        best = shelf;
+    }
+
+  if (!best && atlas->shelves_end + padded_height <= (int) atlas->bitmap.rows)
+    best = atlas_add_shelf (atlas, padded_height);
+
+  if (!best)
+    {
+      /* Evict the least recently used shelf that is tall enough */
+      for (guint i = 0; i < atlas->shelves->len; i++)
+        {
+          AtlasShelf *shelf = g_ptr_array_index (atlas->shelves, i);
+
+          if (shelf->height < padded_height ||
+              shelf->last_used == atlas->serial)
+            continue;
+
+          if (!best || shelf->last_used < best->last_used)
+            best = shelf;
+        }
+
+      if (!best)
+        return NULL;
+
+      atlas_clear_shelf (atlas, best);
+    }
+
+  *x = best->x;
+  best->x += padded_width;
+
+  return best;
+}
+
+static AtlasGlyph *
+atlas_add_glyph (PangoFT2Atlas *atlas,
+                 PangoFont     *font,
+                 PangoGlyph     glyph,
+                 int            subpixel)
+{
+  PangoFT2RenderedGlyph *rendered;
+  gboolean from_cache = FALSE;
+  AtlasShelf *shelf;
+  AtlasGlyph *g = NULL;
+  int x;
+
+  /* Unpositioned glyphs are the same that the FT2 renderer draws,
+   * so share its cache
+   */
+  if (subpixel == 0)
+    rendered = _pango_ft2_font_get_cache_glyph_data (font, glyph);
+  else
+    rendered = NULL;
+
+  if (rendered)
+    from_cache = TRUE;
+  else
+    rendered = _pango_ft2_font_render_glyph (font, glyph,
+                                             subpixel * 64 / atlas->subpixel_positions);
+
+  if (rendered == NULL)
+    return NULL;
+
+  /* Empty glyphs, like spaces, take no room */
+  if (rendered->bitmap.width == 0 || rendered->bitmap.rows == 0)
+    {
+      shelf = NULL;
+      x = 0;
+    }
+  else
+    {
+      shelf = atlas_allocate (atlas, rendered->bitmap.width, rendered->bitmap.rows, &x);
+      if (shelf == NULL)
+        goto out;
+    }
+
+  g = g_slice_new (AtlasGlyph);
+  g->font = g_object_ref (font);
+  g->glyph = glyph;
+  g->subpixel = subpixel;
+  g->shelf = shelf;
+  g->area.x = x;
+  g->area.y = shelf ? shelf->y : 0;
+  g->area.width = rendered->bitmap.width;
+  g->area.height = rendered->bitmap.rows;
+  g->bitmap_left = rendered->bitmap_left;
+  g->bitmap_top = rendered->bitmap_top;
+
+  for (int iy = 0; iy < g->area.height; iy++)
+    {
+      const guchar *src = rendered->bitmap.buffer + iy * rendered->bitmap.pitch;
+      guchar *dest = atlas->bitmap.buffer + (g->area.y + iy) * atlas->bitmap.pitch + g->area.x;
+
+      switch (rendered->bitmap.pixel_mode)
+        {
+        case ft_pixel_mode_grays:
+          memcpy (dest, src, g->area.width);
+          break;
+
+        case ft_pixel_mode_mono:
+          for (int ix = 0; ix < g->area.width; ix++)
+            dest[ix] = (src[ix / 8] & (1 << (7 - (ix % 8)))) ? 0xff : 0;
+          break;
+
+        default:
+          g_warning ("pango_ft2_atlas_render_layout: "
+                     "Unrecognized glyph bitmap pixel mode %d\n",
+                     rendered->bitmap.pixel_mode);
+          break;
+        }
+    }
+
+  atlas_add_damage (atlas, &g->area);
+
+  if (shelf)
+    g_ptr_array_add (shelf->glyphs, g);
+  g_hash_table_add (atlas->glyphs, g);
+
+out:
+  if (!from_cache)
+    _pango_ft2_rendered_glyph_free (rendered);
+
+  return g;
+}
+
+static AtlasGlyph *
+atlas_lookup_glyph (PangoFT2Atlas *atlas,
+                    PangoFont     *font,
+                    PangoGlyph     glyph,
+                    int            subpixel)
+{
+  AtlasGlyph key;
+  AtlasGlyph *g;
+
+  key.font = font;
+  key.glyph = glyph;
+  key.subpixel = subpixel;
+
+  g = g_hash_table_lookup (atlas->glyphs, &key);
+  if (!g)
+    g = atlas_add_glyph (atlas, font, glyph, subpixel);
+
+  if (g && g->shelf)
+    g->shelf->last_used = atlas->serial;
+
+  return g;
+}
+
+/* The renderer that turns draw calls into quads */
+
+typedef struct _PangoFT2AtlasRenderer PangoFT2AtlasRenderer;
+typedef struct _PangoFT2AtlasRendererClass PangoFT2AtlasRendererClass;
+
+struct _PangoFT2AtlasRenderer
+{
+  PangoRenderer parent_instance;
+
+  PangoFT2Atlas *atlas;
+  GArray *quads;
+};
+
+struct _PangoFT2AtlasRendererClass
+{
+  PangoRendererClass parent_class;
+};
+
+static GType pango_ft2_atlas_renderer_get_type (void);
+
+G_DEFINE_TYPE (PangoFT2AtlasRenderer, pango_ft2_atlas_renderer, PANGO_TYPE_RENDERER)
+
+static PangoFT2AtlasQuad *
+add_quad (PangoRenderer   *renderer,
+          PangoRenderPart  part)
+{
+  PangoFT2AtlasRenderer *arenderer = (PangoFT2AtlasRenderer *) renderer;
+  PangoFT2AtlasQuad *quad;
+  PangoColor *color;
+
+  g_array_set_size (arenderer->quads, arenderer->quads->len + 1);
+  quad = &g_array_index (arenderer->quads, PangoFT2AtlasQuad, arenderer->quads->len - 1);
+
+  color = pango_renderer_get_color (renderer, part);
+  if (color)
+    quad->color = *color;
+  else
+    quad->color.red = quad->color.green = quad->color.blue = 0;
+
+  quad->alpha = pango_renderer_get_alpha (renderer, part);
+  if (quad->alpha == 0)
+    quad->alpha = 0xffff;
+
+  return quad;
+}
+
+static void
+pango_ft2_atlas_renderer_draw_glyph (PangoRenderer *renderer,
+                                     PangoFont     *font,
+                                     PangoGlyph     glyph,
+                                     double         x,
+                                     double         y)
+{
+  PangoFT2Atlas *atlas = ((PangoFT2AtlasRenderer *) renderer)->atlas;
+  PangoFT2AtlasQuad *quad;
+  AtlasGlyph *g;
+  int n = atlas->subpixel_positions;
+  int ix, iy, subpixel;
+
+  if (glyph & PANGO_GLYPH_UNKNOWN_FLAG)
+    {
+      /* Like the FT2 renderer, draw the same box for all missing glyphs */
+      gunichar wc = glyph & (~PANGO_GLYPH_UNKNOWN_FLAG);
+
+      if (G_UNLIKELY (glyph == PANGO_GLYPH_INVALID_INPUT || wc > 0x10FFFF))
+        glyph = PANGO_GLYPH_INVALID_INPUT;
+      else
+        glyph = PANGO_GLYPH_UNKNOWN_FLAG;
+    }
+
+  /* Round to the nearest of the n positions within a pixel */
+  ix = floor (x * n + 0.5);
+  subpixel = ix % n;
+  if (subpixel < 0)
+    subpixel += n;
+  ix = (ix - subpixel) / n;
+  iy = floor (y + 0.5);
+
+  g = atlas_lookup_glyph (atlas, font, glyph, subpixel);
+  if (!g || g->area.width == 0 || g->area.height == 0)
+    return;
+
+  quad = add_quad (renderer, PANGO_RENDER_PART_FOREGROUND);
+  quad->atlas = g->area;
+  quad->device.x = ix + g->bitmap_left;
+  quad->device.y = iy - g->bitmap_top;
+  quad->device.width = g->area.width;
+  quad->device.height = g->area.height;
+}
+
+static void
+pango_ft2_atlas_renderer_draw_trapezoid (PangoRenderer   *renderer,
+                                         PangoRenderPart  part,
+                                         double           y1,
+                                         double           x11,
+                                         double           x21,
+                                         double           y2,
+                                         double           x12,
+                                         double           x22)
+{
+  PangoFT2AtlasQuad *quad;
+  int x0, x1, iy1, iy2;
+
+  /* Only rectangles can be drawn as quads */
+  if (x11 != x12 || x21 != x22)
+    return;
+
+  x0 = floor (x11 + 0.5);
+  x1 = floor (x21 + 0.5);
+  iy1 = floor (y1 + 0.5);
+  iy2 = floor (y2 + 0.5);
+
+  if (x1 <= x0 || iy2 <= iy1)
+    return;
+
+  /* The atlas has an opaque pixel in its corner */
+  quad = add_quad (renderer, part);
+  quad->atlas.x = 0;
+  quad->atlas.y = 0;
+  quad->atlas.width = 1;
+  quad->atlas.height = 1;
+  quad->device.x = x0;
+  quad->device.y = iy1;
+  quad->device.width = x1 - x0;
+  quad->device.height = iy2 - iy1;
+}
+
+static void
+pango_ft2_atlas_renderer_init (PangoFT2AtlasRenderer *renderer G_GNUC_UNUSED)
+{
+}
+
+static void
+pango_ft2_atlas_renderer_class_init (PangoFT2AtlasRendererClass *klass)
+{
+  PangoRendererClass *renderer_class = PANGO_RENDERER_CLASS (klass);
+
+  renderer_class->draw_glyph = pango_ft2_atlas_renderer_draw_glyph;
+  renderer_class->draw_trapezoid = pango_ft2_atlas_renderer_draw_trapezoid;
+}
+
+/**
+ * PangoFT2Atlas:
+ *
+ * A `PangoFT2Atlas` is a bitmap that holds rasterized glyphs,
+ * for renderers that draw text as textured rectangles, such as
+ * GPU compositors.
+ *
+ * [func@PangoFT2.Atlas.render_layout] rasterizes each glyph of
+ * a layout into the atlas the first time it is needed, and
+ * returns a list of [struct@PangoFT2.AtlasQuad] that say where
+ * to draw which part of the atlas. Glyphs stay in the atlas for
+ * later layouts until it runs out of space; then the glyphs that
+ * were used least recently are dropped.
+ *
+ * Since: 1.56
+ */
+
+/**
+ * pango_ft2_atlas_new:
+ * @width: width of the atlas bitmap, in pixels
+ * @height: height of the atlas bitmap, in pixels
+ * @subpixel_positions: how many horizontal positions within a
+ *   pixel to rasterize glyphs at, between 1 and 64
+ *
+ * Creates a new glyph atlas.
+ *
+ * With @subpixel_positions set to 1, glyphs are placed at whole
+ * pixels, like [func@PangoFT2.render_layout] does. Higher values
+ * place glyphs more precisely, at the cost of rasterizing and
+ * storing each glyph up to that many times.
+ *
+ * Return value: (transfer full): a new `PangoFT2Atlas`
+ *
+ * Since: 1.56
+ */
+PangoFT2Atlas *
+pango_ft2_atlas_new (int width,
+                     int height,
+                     int subpixel_positions)
+{
+  PangoFT2Atlas *atlas;
+
+  g_return_val_if_fail (width > 0 && height > 0, NULL);
+  g_return_val_if_fail (subpixel_positions >= 1 && subpixel_positions <= 64, NULL);
+
+  atlas = g_new0 (PangoFT2Atlas, 1);
+  atlas->ref_count = 1;
+
+  atlas->bitmap.width = width;
+  atlas->bitmap.rows = height;
+  atlas->bitmap.pitch = (width + 3) & ~3;
+  atlas->bitmap.num_grays = 256;
+  atlas->bitmap.pixel_mode = ft_pixel_mode_grays;
+  atlas->bitmap.buffer = g_malloc0_n (atlas->bitmap.rows, atlas->bitmap.pitch);
+
+  atlas->subpixel_positions = subpixel_positions;
+
+  atlas->glyphs = g_hash_table_new_full (atlas_glyph_hash, atlas_glyph_equal,
+                                         (GDestroyNotify) atlas_glyph_free, NULL);
+  atlas->shelves = g_ptr_array_new_with_free_func ((GDestroyNotify) atlas_shelf_free);
+
+  /* Reserve the opaque pixel for rectangles, above
+   * the shelves so that it is never evicted
+   */
+  atlas->bitmap.buffer[0] = 0xff;
+  atlas->shelves_end = 1 + SHELF_PADDING;
+
+  atlas->damage.x = 0;
+  atlas->damage.y = 0;
+  atlas->damage.width = width;
+  atlas->damage.height = height;
+
+  atlas->renderer = g_object_new (pango_ft2_atlas_renderer_get_type (), NULL);
+  ((PangoFT2AtlasRenderer *) atlas->renderer)->atlas = atlas;
+
+  return atlas;
+}
+
+/**
+ * pango_ft2_atlas_ref:
+ * @atlas: a `PangoFT2Atlas`
+ *
+ * Increases the reference count of @atlas by one.
+ *
+ * Return value: (transfer full): @atlas
+ *
+ * Since: 1.56
+ */
+PangoFT2Atlas *
+pango_ft2_atlas_ref (PangoFT2Atlas *atlas)
+{
+  g_return_val_if_fail (atlas != NULL, NULL);
+
+  g_atomic_int_inc (&atlas->ref_count);
+
+  return atlas;
+}
+
+/**
+ * pango_ft2_atlas_unref:
+ * @atlas: (transfer full): a `PangoFT2Atlas`
+ *
+ * Decreases the reference count of @atlas by one.
+ *
+ * If the result is zero, frees @atlas and the glyphs in it.
+ *
+ * Since: 1.56
+ */
+void
+pango_ft2_atlas_unref (PangoFT2Atlas *atlas)
+{
+  g_return_if_fail (atlas != NULL);
+
+  if (!g_atomic_int_dec_and_test (&atlas->ref_count))
+    return;
+
+  g_object_unref (atlas->renderer);
+  g_ptr_array_unref (atlas->shelves);
+  g_hash_table_unref (atlas->glyphs);
+  g_free (atlas->bitmap.buffer);
+  g_free (atlas);
+}
+
+/**
+ * pango_ft2_atlas_get_bitmap:
+ * @atlas: a `PangoFT2Atlas`
+ *
+ * Gets the bitmap that holds the glyphs of @atlas.
+ *
+ * It has one byte of coverage per pixel. Its contents change
+ * when [func@PangoFT2.Atlas.render_layout] adds glyphs; use
+ * [func@PangoFT2.Atlas.get_damage] to find out which parts.
+ *
+ * Return value: (transfer none): the atlas bitmap
+ *
+ * Since: 1.56
+ */
+const FT_Bitmap *
+pango_ft2_atlas_get_bitmap (PangoFT2Atlas *atlas)
+{
+  g_return_val_if_fail (atlas != NULL, NULL);
+
+  return &atlas->bitmap;
+}
+
+/**
+ * pango_ft2_atlas_get_damage:
+ * @atlas: a `PangoFT2Atlas`
+ * @area: (out caller-allocates): return location for the changed area
+ *
+ * Gets the part of the atlas bitmap that changed since the
+ * last call to this function, and forgets about it.
+ *
+ * This is meant for uploading only the changed part of the
+ * atlas to a texture.
+ *
+ * Return value: %TRUE if anything changed
+ *
+ * Since: 1.56
+ */
+gboolean
+pango_ft2_atlas_get_damage (PangoFT2Atlas  *atlas,
+                            PangoRectangle *area)
+{
+  g_return_val_if_fail (atlas != NULL, FALSE);
+  g_return_val_if_fail (area != NULL, FALSE);
+
+  *area = atlas->damage;
+
+  atlas->damage.x = 0;
+  atlas->damage.y = 0;
+  atlas->damage.width = 0;
+  atlas->damage.height = 0;
+
+  return area->width > 0;
+}
+
+/**
+ * pango_ft2_atlas_render_layout:
+ * @atlas: a `PangoFT2Atlas`
+ * @layout: a `PangoLayout` created with a `PangoFT2FontMap`
+ * @x: the X position of the left of the layout, in pixels
+ * @y: the Y position of the top of the layout, in pixels
+ * @n_quads: (out): return location for the number of quads
+ *
+ * Renders @layout into quads that draw parts of @atlas.
+ *
+ * Glyphs that are not in the atlas yet are rasterized into it.
+ * Drawing the returned quads in order gives the same result as
+ * [func@PangoFT2.render_layout], with two exceptions: only
+ * rectangles are drawn of the lines that decorate the text, so
+ * error underlines are left out, and glyphs that don't fit into
+ * the atlas at all are skipped.
+ *
+ * The quads are only valid until the next call to this function,
+ * which may reuse their part of the atlas for other glyphs.
+ *
+ * Return value: (array length=n_quads) (transfer full): the quads,
+ *   free with g_free()
+ *
+ * Since: 1.56
+ */
+PangoFT2AtlasQuad *
+pango_ft2_atlas_render_layout (PangoFT2Atlas *atlas,
+                               PangoLayout   *layout,
+                               int            x,
+                               int            y,
+                               int           *n_quads)
+{
+  PangoFT2AtlasRenderer *renderer;
+
+  g_return_val_if_fail (atlas != NULL, NULL);
+  g_return_val_if_fail (PANGO_IS_LAYOUT (layout), NULL);
+  g_return_val_if_fail (n_quads != NULL, NULL);
+
+  renderer = (PangoFT2AtlasRenderer *) atlas->renderer;
+
+  atlas->serial++;
+  renderer->quads = g_array_new (FALSE, FALSE, sizeof (PangoFT2AtlasQuad));
+
+  pango_renderer_draw_layout (atlas->renderer, layout, x * PANGO_SCALE, y * PANGO_SCALE);
+
+  *n_quads = renderer->quads->len;
+
+  return (PangoFT2AtlasQuad *) g_array_free (g_steal_pointer (&renderer->quads), FALSE);
+}
@@ -93,6 +93,8 @@ void  _pango_ft2_font_set_cache_glyph_data    (PangoFont      *font,
 					       void           *cached_glyph);
 void  _pango_ft2_font_set_glyph_cache_destroy (PangoFont      *font,
 					       GDestroyNotify  destroy_notify);
+void  _pango_ft2_font_set_transform           (PangoFT2Font   *ft2font,
+					       FT_Vector      *delta);
 
 #define PANGO_TYPE_FT2_RENDERER            (pango_ft2_renderer_get_type())
 #define PANGO_FT2_RENDERER(object)         (G_TYPE_CHECK_INSTANCE_CAST ((object), PANGO_TYPE_FT2_RENDERER, PangoFT2Renderer))
@@ -103,4 +105,18 @@ GType pango_ft2_renderer_get_type    (void) G_GNUC_CONST;
 
 PangoRenderer *_pango_ft2_font_map_get_renderer (PangoFT2FontMap *ft2fontmap);
 
+typedef struct _PangoFT2RenderedGlyph PangoFT2RenderedGlyph;
+
+struct _PangoFT2RenderedGlyph
+{
+  FT_Bitmap bitmap;
+  int bitmap_left;
+  int bitmap_top;
+};
+
+PangoFT2RenderedGlyph *_pango_ft2_font_render_glyph   (PangoFont             *font,
+						       PangoGlyph             glyph_index,
+						       int                    x_offset);
+void                   _pango_ft2_rendered_glyph_free (PangoFT2RenderedGlyph *rendered);
+
 #endif /* __PANGOFT2_PRIVATE_H__ */
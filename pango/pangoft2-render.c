@@ -22,6 +22,7 @@
 
 #include "config.h"
 #include <math.h>
+#include <string.h>
 
 #include "pango-font-private.h"
 #include "pangoft2-private.h"
@@ -43,6 +44,10 @@ struct _PangoFT2Renderer
   PangoRenderer parent_instance;
 
   FT_Bitmap *bitmap;
+
+  /* Scratch row for rasterizing trapezoids, kept zeroed */
+  int *cells;
+  int n_cells;
 };
 
 struct _PangoFT2RendererClass
@@ -71,11 +76,24 @@ pango_ft2_renderer_init (PangoFT2Renderer *renderer G_GNUC_UNUSED)
 {
 }
 
+static void
+pango_ft2_renderer_finalize (GObject *object)
+{
+  PangoFT2Renderer *renderer = PANGO_FT2_RENDERER (object);
+
+  g_free (renderer->cells);
+
+  G_OBJECT_CLASS (pango_ft2_renderer_parent_class)->finalize (object);
+}
+
 static void
 pango_ft2_renderer_class_init (PangoFT2RendererClass *klass)
 {
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
   PangoRendererClass *renderer_class = PANGO_RENDERER_CLASS (klass);
 
+  object_class->finalize = pango_ft2_renderer_finalize;
+
   renderer_class->draw_glyph = pango_ft2_renderer_draw_glyph;
   renderer_class->draw_trapezoid = pango_ft2_renderer_draw_trapezoid;
 }
@@ -87,15 +105,8 @@ pango_ft2_renderer_set_bitmap (PangoFT2Renderer *renderer,
   renderer->bitmap = bitmap;
 }
 
-typedef struct
-{
-  FT_Bitmap bitmap;
-  int bitmap_left;
-  int bitmap_top;
-} PangoFT2RenderedGlyph;
-
-static void
-pango_ft2_free_rendered_glyph (PangoFT2RenderedGlyph *rendered)
+void
+_pango_ft2_rendered_glyph_free (PangoFT2RenderedGlyph *rendered)
 {
   g_free (rendered->bitmap.buffer);
   g_slice_free (PangoFT2RenderedGlyph, rendered);
@@ -182,9 +193,14 @@ pango_ft2_font_render_box_glyph (int      width,
   return box;
 }
 
-static PangoFT2RenderedGlyph *
-pango_ft2_font_render_glyph (PangoFont *font,
-			     PangoGlyph glyph_index)
+/* @x_offset is added to the glyph origin before rasterizing
+ * it, in 26.6 fixed point. It lets callers position glyphs at
+ * fractions of a pixel.
+ */
+PangoFT2RenderedGlyph *
+_pango_ft2_font_render_glyph (PangoFont  *font,
+			      PangoGlyph  glyph_index,
+			      int         x_offset)
 {
   FT_Face face;
   gboolean invalid_input;
@@ -222,11 +238,22 @@ pango_ft2_font_render_glyph (PangoFont *font,
       rendered = g_slice_new (PangoFT2RenderedGlyph);
 
       /* Draw glyph */
+      if (x_offset != 0)
+        {
+          FT_Vector delta = { x_offset, 0 };
+
+          /* Keep the font matrix (e.g. synthetic oblique) in place */
+          _pango_ft2_font_set_transform (ft2font, &delta);
+        }
+
       FT_Load_Glyph (face, glyph_index, ft2font->load_flags);
       FT_Render_Glyph (face->glyph,
 		       (ft2font->load_flags & FT_LOAD_TARGET_MONO ?
 			ft_render_mode_mono : ft_render_mode_normal));
 
+      if (x_offset != 0)
+        _pango_ft2_font_set_transform (ft2font, NULL);
+
       rendered->bitmap = face->glyph->bitmap;
       rendered->bitmap.buffer = g_memdup2 (face->glyph->bitmap.buffer,
                                            face->glyph->bitmap.rows * face->glyph->bitmap.pitch);
@@ -287,7 +314,7 @@ pango_ft2_renderer_draw_glyph (PangoRenderer *renderer,
   add_glyph_to_cache = FALSE;
   if (rendered_glyph == NULL)
     {
-      rendered_glyph = pango_ft2_font_render_glyph (font, glyph);
+      rendered_glyph = _pango_ft2_font_render_glyph (font, glyph, 0);
       if (rendered_glyph == NULL)
         return;
       add_glyph_to_cache = TRUE;
@@ -372,209 +399,270 @@ pango_ft2_renderer_draw_glyph (PangoRenderer *renderer,
   if (add_glyph_to_cache)
     {
       _pango_ft2_font_set_glyph_cache_destroy (font,
-					       (GDestroyNotify) pango_ft2_free_rendered_glyph);
+					       (GDestroyNotify) _pango_ft2_rendered_glyph_free);
       _pango_ft2_font_set_cache_glyph_data (font,
 					    glyph, rendered_glyph);
     }
 }
 
-typedef struct {
-  double y;
-  double x1;
-  double x2;
-} Position;
+/* Decorations and trapezoids are rasterized with fixed-point
+ * coordinates that have 8 bits of fraction. Coverage is the
+ * exact area of each pixel that is covered, scaled to [0,256].
+ */
+#define FIXED_SHIFT 8
+#define FIXED_ONE   (1 << FIXED_SHIFT)
+#define FIXED_MASK  (FIXED_ONE - 1)
+
+/* The number of horizontal slices each pixel row of a
+ * trapezoid is cut into; the slanted edges are taken
+ * to be vertical within a slice
+ */
+#define SUBROWS 4
+
+/* Largest coordinate we bother with, to keep the fixed-point
+ * math from overflowing; anything beyond is outside the bitmap
+ */
+#define COORD_LIMIT ((double) (1 << 22))
+
+/* Steeper edges are as good as horizontal */
+#define SLOPE_LIMIT ((double) (1 << 12))
+
+static inline int
+to_fixed (double v)
+{
+  return (int) floor (CLAMP (v, -COORD_LIMIT, COORD_LIMIT) * FIXED_ONE + 0.5);
+}
+
+/* @area is in units of 1 / (FIXED_ONE * FIXED_ONE) pixels.
+ *
+ * Coverage is added up, so that pixels that get divided into
+ * multiple pieces still end up fully black.
+ */
+static inline void
+add_coverage (guchar *dest,
+              int     area)
+{
+  int c = *dest + (area >> FIXED_SHIFT);
 
+  *dest = MIN (c, 255);
+}
+
+/* Rectangles need no slicing: each row covers the same span,
+ * and rows that are entirely covered can be filled directly.
+ * Coordinates are fixed-point and clipped to the bitmap.
+ */
 static void
-draw_simple_trap (PangoRenderer *renderer,
-		  Position      *t,
-		  Position      *b)
+draw_fixed_rectangle (FT_Bitmap *bitmap,
+                      int        x1,
+                      int        y1,
+                      int        x2,
+                      int        y2)
 {
-  FT_Bitmap *bitmap = PANGO_FT2_RENDERER (renderer)->bitmap;
-  int iy = floor (t->y);
-  int x1, x2, x;
-  double dy = b->y - t->y;
-  guchar *dest;
+  int ix1, ix2, iy, iy_end;
+  int left, right;
 
-  if (iy < 0 || iy >= (int) bitmap->rows)
+  if (x1 >= x2 || y1 >= y2)
     return;
-  dest = bitmap->buffer + iy * bitmap->pitch;
 
-  if (t->x1 < b->x1)
-    x1 = floor (t->x1);
-  else
-    x1 = floor (b->x1);
+  ix1 = x1 >> FIXED_SHIFT;
+  ix2 = x2 >> FIXED_SHIFT;
 
-  if (t->x2 > b->x2)
-    x2 = ceil (t->x2);
+  if (ix1 == ix2)
+    {
+      left = x2 - x1;
+      right = 0;
+    }
   else
-    x2 = ceil (b->x2);
-
-  x1 = CLAMP (x1, 0, (int) bitmap->width);
-  x2 = CLAMP (x2, 0, (int) bitmap->width);
+    {
+      left = FIXED_ONE - (x1 & FIXED_MASK);
+      right = x2 & FIXED_MASK;
+    }
 
-  for (x = x1; x < x2; x++)
+  iy_end = (y2 + FIXED_MASK) >> FIXED_SHIFT;
+  for (iy = y1 >> FIXED_SHIFT; iy < iy_end; iy++)
     {
-      double top_left = MAX (t->x1, x);
-      double top_right = MIN (t->x2, x + 1);
-      double bottom_left = MAX (b->x1, x);
-      double bottom_right = MIN (b->x2, x + 1);
-      double c = 0.5 * dy * ((top_right - top_left) + (bottom_right - bottom_left));
-
-      /* When converting to [0,255], we round up. This is intended
-       * to prevent the problem of pixels that get divided into
-       * multiple slices not being fully black.
-       */
-      int ic = c * 256;
+      guchar *row = bitmap->buffer + iy * bitmap->pitch;
+      int h = MIN (y2, (iy + 1) << FIXED_SHIFT) - MAX (y1, iy << FIXED_SHIFT);
+      int x;
+
+      add_coverage (&row[ix1], left * h);
 
-      dest[x] = MIN (dest[x] + ic, 255);
+      if (ix2 <= ix1)
+        continue;
+
+      if (h == FIXED_ONE)
+        memset (row + ix1 + 1, 0xff, ix2 - ix1 - 1);
+      else
+        for (x = ix1 + 1; x < ix2; x++)
+          add_coverage (&row[x], FIXED_ONE * h);
+
+      if (right)
+        add_coverage (&row[ix2], right * h);
     }
 }
 
-static void
-interpolate_position (Position *result,
-		      Position *top,
-		      Position *bottom,
-		      double    val,
-		      double    val1,
-		      double    val2)
+/* Makes sure the renderer has a zeroed row of coverage
+ * cells for the current bitmap. See draw_fixed_trapezoid()
+ */
+static int *
+get_cells (PangoFT2Renderer *renderer)
+{
+  int n_cells = 2 * ((int) renderer->bitmap->width + 1);
+
+  if (renderer->n_cells < n_cells)
+    {
+      g_free (renderer->cells);
+      renderer->cells = g_new0 (int, n_cells);
+      renderer->n_cells = n_cells;
+    }
+
+  return renderer->cells;
+}
+
+/* Adds the span [@xl, @xr) of a slice with height @h to a row
+ * of cells. Pixels that the span only partially covers get their
+ * area in @partial; fully covered ones are recorded as a difference
+ * in @full at both ends, so the cost doesn't depend on the width
+ * of the span.
+ */
+static inline void
+add_span (int *partial,
+          int *full,
+          int  xl,
+          int  xr,
+          int  h)
 {
-  result->y  = (top->y *  (val2 - val) + bottom->y *  (val - val1)) / (val2 - val1);
-  result->x1 = (top->x1 * (val2 - val) + bottom->x1 * (val - val1)) / (val2 - val1);
-  result->x2 = (top->x2 * (val2 - val) + bottom->x2 * (val - val1)) / (val2 - val1);
+  int ixl = xl >> FIXED_SHIFT;
+  int ixr = xr >> FIXED_SHIFT;
+
+  if (ixl == ixr)
+    {
+      partial[ixl] += (xr - xl) * h;
+      return;
+    }
+
+  partial[ixl] += (FIXED_ONE - (xl & FIXED_MASK)) * h;
+  full[ixl + 1] += h;
+  full[ixr] -= h;
+  partial[ixr] += (xr & FIXED_MASK) * h;
 }
 
 /* This draws a trapezoid with the parallel sides aligned with
- * the X axis. We do this by subdividing the trapezoid vertically
- * into thin slices (themselves trapezoids) where two edge sides are each
- * contained within a single pixel and then rasterizing each
- * slice. There are frequently multiple slices within a single
- * line so we have to accumulate to get the final result.
+ * the X axis. Each pixel row is cut into SUBROWS slices, and
+ * both edges are stepped in fixed point to the middle of each
+ * slice. The spans are collected in a row of cells, which is
+ * then added to the bitmap and cleared again.
  */
 static void
-pango_ft2_renderer_draw_trapezoid (PangoRenderer   *renderer,
-				   PangoRenderPart  part G_GNUC_UNUSED,
-				   double           y1,
-				   double           x11,
-				   double           x21,
-				   double           y2,
-				   double           x12,
-				   double           x22)
+draw_fixed_trapezoid (PangoFT2Renderer *renderer,
+                      double            y1,
+                      double            x11,
+                      double            x21,
+                      double            y2,
+                      double            x12,
+                      double            x22)
 {
-  Position pos;
-  Position t;
-  Position b;
-  gboolean done = FALSE;
-
-  if (y1 == y2)
+  FT_Bitmap *bitmap = renderer->bitmap;
+  int width = bitmap->width;
+  int fy1, fy2, fy_base, iy, iy_end;
+  gint64 xl_base, xr_base, dxl, dxr;
+  int *partial, *full;
+
+  fy_base = to_fixed (y1);
+  fy1 = to_fixed (CLAMP (y1, 0, bitmap->rows));
+  fy2 = to_fixed (CLAMP (y2, 0, bitmap->rows));
+  if (fy1 >= fy2)
     return;
 
-  pos.y = t.y = y1;
-  pos.x1 = t.x1 = x11;
-  pos.x2 = t.x2 = x21;
-  b.y = y2;
-  b.x1 = x12;
-  b.x2 = x22;
+  /* The edges, as X at @y1 in fixed point with another 16 bits
+   * of fraction, and as the change of X per half a fixed-point
+   * unit of Y, with 16 bits of fraction
+   */
+  xl_base = (gint64) to_fixed (x11) << 16;
+  xr_base = (gint64) to_fixed (x21) << 16;
+  dxl = (gint64) floor (CLAMP ((x12 - x11) / (y2 - y1), -SLOPE_LIMIT, SLOPE_LIMIT) * 32768. + 0.5);
+  dxr = (gint64) floor (CLAMP ((x22 - x21) / (y2 - y1), -SLOPE_LIMIT, SLOPE_LIMIT) * 32768. + 0.5);
+
+  partial = get_cells (renderer);
+  full = partial + width + 1;
 
-  while (!done)
+  iy_end = (fy2 + FIXED_MASK) >> FIXED_SHIFT;
+  for (iy = fy1 >> FIXED_SHIFT; iy < iy_end; iy++)
     {
-      Position pos_next;
-      double y_next, x1_next, x2_next;
-      double ix1, ix2;
-
-      /* The algorithm here is written to emphasize simplicity and
-       * numerical stability as opposed to speed.
-       *
-       * While the end result is slicing up the polygon vertically,
-       * conceptually we aren't walking in the X direction, rather we
-       * are walking along the edges. When we compute crossing of
-       * horizontal pixel boundaries, we use the X coordinate as the
-       * interpolating variable, when we compute crossing for vertical
-       * pixel boundaries, we use the Y coordinate.
-       *
-       * This allows us to handle almost exactly horizontal edges without
-       * running into difficulties. (Almost exactly horizontal edges
-       * come up frequently due to inexactness in computing, say,
-       * a 90 degree rotation transformation)
-       */
+      guchar *row = bitmap->buffer + iy * bitmap->pitch;
+      int min_x = width, max_x = 0;
+      int s, x, run;
 
-      pos_next = b;
-      done = TRUE;
+      for (s = 0; s < SUBROWS; s++)
+        {
+          int top = (iy << FIXED_SHIFT) + s * (FIXED_ONE / SUBROWS);
+          int bottom = top + FIXED_ONE / SUBROWS;
+          gint64 mid2, xl, xr;
 
-      /* Check for crossing vertical pixel boundaries */
-      y_next = floor (pos.y) + 1;
-      if (y_next < pos_next.y)
-	{
-	  interpolate_position (&pos_next, &t, &b,
-				y_next, t.y, b.y);
-	  pos_next.y = y_next;
-	  done = FALSE;
-	}
+          top = MAX (top, fy1);
+          bottom = MIN (bottom, fy2);
+          if (top >= bottom)
+            continue;
 
-      /* Check left side for crossing horizontal pixel boundaries */
-      ix1 = floor (pos.x1);
+          /* Twice the distance of the middle of the slice from @y1 */
+          mid2 = (gint64) top + bottom - 2 * (gint64) fy_base;
 
-      if (b.x1 < t.x1)
-	{
-	  if (ix1 == pos.x1)
-	    x1_next = ix1 - 1;
-	  else
-	    x1_next = ix1;
+          xl = (xl_base + dxl * mid2) >> 16;
+          xr = (xr_base + dxr * mid2) >> 16;
+          xl = CLAMP (xl, 0, (gint64) width << FIXED_SHIFT);
+          xr = CLAMP (xr, 0, (gint64) width << FIXED_SHIFT);
+          if (xl >= xr)
+            continue;
 
-	  if (x1_next > pos_next.x1)
-	    {
-	      interpolate_position (&pos_next, &t, &b,
-				    x1_next, t.x1, b.x1);
-	      pos_next.x1 = x1_next;
-	      done = FALSE;
-	    }
-	}
-      else if (b.x1 > t.x1)
-	{
-	  x1_next = ix1 + 1;
+          add_span (partial, full, (int) xl, (int) xr, bottom - top);
 
-	  if (x1_next < pos_next.x1)
-	    {
-	      interpolate_position (&pos_next, &t, &b,
-				    x1_next, t.x1, b.x1);
-	      pos_next.x1 = x1_next;
-	      done = FALSE;
-	    }
-	}
+          min_x = MIN (min_x, (int) (xl >> FIXED_SHIFT));
+          max_x = MAX (max_x, (int) (xr >> FIXED_SHIFT) + 1);
+        }
 
-      /* Check right side for crossing horizontal pixel boundaries */
-      ix2 = floor (pos.x2);
+      for (x = min_x, run = 0; x < max_x; x++)
+        {
+          run += full[x];
 
-      if (b.x2 < t.x2)
-	{
-	  if (ix2 == pos.x2)
-	    x2_next = ix2 - 1;
-	  else
-	    x2_next = ix2;
+          if (x < width)
+            add_coverage (&row[x], partial[x] + run * FIXED_ONE);
 
-	  if (x2_next > pos_next.x2)
-	    {
-	      interpolate_position (&pos_next, &t, &b,
-				    x2_next, t.x2, b.x2);
-	      pos_next.x2 = x2_next;
-	      done = FALSE;
-	    }
-	}
-      else if (x22 > x21)
-	{
-	  x2_next = ix2 + 1;
+          partial[x] = 0;
+          full[x] = 0;
+        }
+    }
+}
 
-	  if (x2_next < pos_next.x2)
-	    {
-	      interpolate_position (&pos_next, &t, &b,
-				    x2_next, t.x2, b.x2);
-	      pos_next.x2 = x2_next;
-	      done = FALSE;
-	    }
-	}
+static void
+pango_ft2_renderer_draw_trapezoid (PangoRenderer   *renderer,
+				   PangoRenderPart  part G_GNUC_UNUSED,
+				   double           y1,
+				   double           x11,
+				   double           x21,
+				   double           y2,
+				   double           x12,
+				   double           x22)
+{
+  FT_Bitmap *bitmap = PANGO_FT2_RENDERER (renderer)->bitmap;
+
+  if (!(y1 < y2))
+    return;
 
-      draw_simple_trap (renderer, &pos, &pos_next);
-      pos = pos_next;
+  /* Underlines, strikethroughs and the like are rectangles */
+  if (x11 == x12 && x21 == x22)
+    {
+      int max_x = bitmap->width << FIXED_SHIFT;
+      int max_y = bitmap->rows << FIXED_SHIFT;
+
+      draw_fixed_rectangle (bitmap,
+                            CLAMP (to_fixed (x11), 0, max_x),
+                            CLAMP (to_fixed (y1), 0, max_y),
+                            CLAMP (to_fixed (x21), 0, max_x),
+                            CLAMP (to_fixed (y2), 0, max_y));
+      return;
     }
+
+  draw_fixed_trapezoid (PANGO_FT2_RENDERER (renderer), y1, x11, x21, y2, x12, x22);
 }
 
 /**
@@ -131,8 +131,13 @@ load_fallback_face (PangoFT2Font *ft2font,
   FcPatternDestroy (matched);
 }
 
-static void
-set_transform (PangoFT2Font *ft2font)
+/* Installs the font matrix from the pattern, if any, followed by
+ * @delta (in 26.6 units) on the face. Pass %NULL for @delta to
+ * restore the plain font transform.
+ */
+void
+_pango_ft2_font_set_transform (PangoFT2Font *ft2font,
+                               FT_Vector    *delta)
 {
   PangoFcFont *fcfont = (PangoFcFont *)ft2font;
   FcMatrix *fc_matrix;
@@ -146,8 +151,10 @@ set_transform (PangoFT2Font *ft2font)
       ft_matrix.xy = 0x10000L * fc_matrix->xy;
       ft_matrix.yx = 0x10000L * fc_matrix->yx;
 
-      FT_Set_Transform (ft2font->face, &ft_matrix, NULL);
+      FT_Set_Transform (ft2font->face, &ft_matrix, delta);
     }
+  else
+    FT_Set_Transform (ft2font->face, NULL, delta);
 }
 
 /**
@@ -243,7 +250,7 @@ pango_ft2_font_get_face (PangoFont *font)
 
       g_assert (ft2font->face);
 
-      set_transform (ft2font);
+      _pango_ft2_font_set_transform (ft2font, NULL);
 
       error = FT_Set_Char_Size (ft2font->face,
                                 PANGO_PIXELS_26_6 (ft2font->size),
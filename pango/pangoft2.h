@@ -107,6 +107,60 @@ void pango_ft2_render_layout_subpixel      (FT_Bitmap        *bitmap,
 					    int               x,
 					    int               y);
 
+/**
+ * PangoFT2AtlasQuad:
+ * @atlas: the area of the atlas bitmap to draw, in pixels
+ * @device: the area to draw it to, in device pixels
+ * @color: the color to draw with
+ * @alpha: the alpha to draw with, from 0 to 65535
+ *
+ * A `PangoFT2AtlasQuad` describes one textured rectangle that
+ * [func@PangoFT2.Atlas.render_layout] produces.
+ *
+ * The atlas bitmap holds coverage values. A quad is drawn by
+ * filling @device with @color, using the coverage in @atlas,
+ * scaled to the size of @device, as mask. Glyphs have the same
+ * size in the atlas and on the device; rectangles such as
+ * underlines stretch a single opaque pixel.
+ *
+ * Since: 1.56
+ */
+typedef struct _PangoFT2AtlasQuad PangoFT2AtlasQuad;
+
+struct _PangoFT2AtlasQuad
+{
+  PangoRectangle atlas;
+  PangoRectangle device;
+  PangoColor color;
+  guint16 alpha;
+};
+
+typedef struct _PangoFT2Atlas PangoFT2Atlas;
+
+#define PANGO_TYPE_FT2_ATLAS (pango_ft2_atlas_get_type ())
+
+PANGO_AVAILABLE_IN_1_56
+GType              pango_ft2_atlas_get_type      (void) G_GNUC_CONST;
+PANGO_AVAILABLE_IN_1_56
+PangoFT2Atlas     *pango_ft2_atlas_new           (int               width,
+						  int               height,
+						  int               subpixel_positions);
+PANGO_AVAILABLE_IN_1_56
+PangoFT2Atlas     *pango_ft2_atlas_ref           (PangoFT2Atlas    *atlas);
+PANGO_AVAILABLE_IN_1_56
+void               pango_ft2_atlas_unref         (PangoFT2Atlas    *atlas);
+PANGO_AVAILABLE_IN_1_56
+const FT_Bitmap   *pango_ft2_atlas_get_bitmap    (PangoFT2Atlas    *atlas);
+PANGO_AVAILABLE_IN_1_56
+gboolean           pango_ft2_atlas_get_damage    (PangoFT2Atlas    *atlas,
+						  PangoRectangle   *area);
+PANGO_AVAILABLE_IN_1_56
+PangoFT2AtlasQuad *pango_ft2_atlas_render_layout (PangoFT2Atlas    *atlas,
+						  PangoLayout      *layout,
+						  int               x,
+						  int               y,
+						  int              *n_quads);
+
 PANGO_AVAILABLE_IN_ALL
 GType pango_ft2_font_map_get_type (void) G_GNUC_CONST;
 
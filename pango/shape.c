@@ -362,41 +362,46 @@ glyph_has_color (hb_font_t      *font,
 
 /* }}} */
 
+typedef struct
+{
+  PangoHbShapeContext context;
+  hb_font_t *hb_font;
+  hb_buffer_t *hb_buffer;
+  gboolean free_buffer;
+  unsigned int item_offset;
+} PangoHbShapeResult;
+
+/* Shapes the item into an hb_buffer_t. The buffer is owned
+ * by @result and must be released with pango_hb_shape_result_clear()
+ * after the glyphs have been copied out.
+ */
 static void
-pango_hb_shape (const char          *item_text,
-                int                  item_length,
-                const char          *paragraph_text,
-                int                  paragraph_length,
-                const PangoAnalysis *analysis,
-                PangoLogAttr        *log_attrs,
-                int                  num_chars,
-                PangoGlyphString    *glyphs,
-                PangoShapeFlags      flags)
+pango_hb_shape_to_buffer (const char          *item_text,
+                          int                  item_length,
+                          const char          *paragraph_text,
+                          int                  paragraph_length,
+                          const PangoAnalysis *analysis,
+                          PangoLogAttr        *log_attrs,
+                          int                  num_chars,
+                          PangoHbShapeResult  *result)
 {
-  PangoHbShapeContext context = { 0, };
   hb_buffer_flags_t hb_buffer_flags;
   hb_font_t *hb_font;
   hb_buffer_t *hb_buffer;
   hb_direction_t hb_direction;
-  gboolean free_buffer;
-  hb_glyph_info_t *hb_glyph;
-  hb_glyph_position_t *hb_position;
-  int last_cluster;
-  guint i, num_glyphs;
   unsigned int item_offset = item_text - paragraph_text;
   hb_feature_t features[32];
   unsigned int num_features = 0;
-  PangoGlyphInfo *infos;
   PangoTextTransform transform;
   int hyphen_index;
-  gboolean font_is_color;
 
-  g_return_if_fail (analysis != NULL);
-  g_return_if_fail (analysis->font != NULL);
+  result->context.show_flags = find_show_flags (analysis);
+  hb_font = pango_font_get_hb_font_for_context (analysis->font, &result->context);
+  hb_buffer = acquire_buffer (&result->free_buffer);
 
-  context.show_flags = find_show_flags (analysis);
-  hb_font = pango_font_get_hb_font_for_context (analysis->font, &context);
-  hb_buffer = acquire_buffer (&free_buffer);
+  result->hb_font = hb_font;
+  result->hb_buffer = hb_buffer;
+  result->item_offset = item_offset;
 
   transform = find_text_transform (analysis);
 
@@ -408,7 +413,7 @@ pango_hb_shape (const char          *item_text,
 
   hb_buffer_flags = HB_BUFFER_FLAG_BOT | HB_BUFFER_FLAG_EOT;
 
-  if (context.show_flags & PANGO_SHOW_IGNORABLES)
+  if (result->context.show_flags & PANGO_SHOW_IGNORABLES)
     hb_buffer_flags |= HB_BUFFER_FLAG_PRESERVE_DEFAULT_IGNORABLES;
 
   /* setup buffer */
@@ -513,6 +518,49 @@ pango_hb_shape (const char          *item_text,
 
   if (PANGO_GRAVITY_IS_IMPROPER (analysis->gravity))
     hb_buffer_reverse (hb_buffer);
+}
+
+static void
+pango_hb_shape_result_clear (PangoHbShapeResult *result)
+{
+  release_buffer (result->hb_buffer, result->free_buffer);
+  hb_font_destroy (result->hb_font);
+}
+
+static void
+pango_hb_shape (const char          *item_text,
+                int                  item_length,
+                const char          *paragraph_text,
+                int                  paragraph_length,
+                const PangoAnalysis *analysis,
+                PangoLogAttr        *log_attrs,
+                int                  num_chars,
+                PangoGlyphString    *glyphs,
+                PangoShapeFlags      flags)
+{
+  PangoHbShapeResult result = { { 0, }, };
+  hb_font_t *hb_font;
+  hb_buffer_t *hb_buffer;
+  hb_glyph_info_t *hb_glyph;
+  hb_glyph_position_t *hb_position;
+  int last_cluster;
+  guint i, num_glyphs;
+  unsigned int item_offset;
+  PangoGlyphInfo *infos;
+  gboolean font_is_color;
+
+  g_return_if_fail (analysis != NULL);
+  g_return_if_fail (analysis->font != NULL);
+
+  pango_hb_shape_to_buffer (item_text, item_length,
+                            paragraph_text, paragraph_length,
+                            analysis,
+                            log_attrs, num_chars,
+                            &result);
+
+  hb_font = result.hb_font;
+  hb_buffer = result.hb_buffer;
+  item_offset = result.item_offset;
 
   /* buffer output */
   num_glyphs = hb_buffer_get_length (hb_buffer);
@@ -551,8 +599,7 @@ pango_hb_shape (const char          *item_text,
         hb_position++;
       }
 
-  release_buffer (hb_buffer, free_buffer);
-  hb_font_destroy (hb_font);
+  pango_hb_shape_result_clear (&result);
 }
 
 /* }}} */
@@ -610,9 +657,168 @@ fallback_shape (const char          *text,
 }
 
 /*  }}} */
-/* {{{ Shaping implementation */
+/* {{{ Position rounding */
+
+typedef enum
+{
+  ROUND_NONE,
+  ROUND_WIDTH,
+  ROUND_ALL,
+  ROUND_HINT,
+  ROUND_QUANTIZE
+} PositionRoundingMode;
+
+typedef struct
+{
+  PositionRoundingMode mode;
+  double x_scale, x_scale_inv;
+  double y_scale, y_scale_inv;
+  int n_positions;
+} PositionRounding;
 
 static void
+position_rounding_init (PositionRounding    *rounding,
+                        const PangoAnalysis *analysis,
+                        PangoShapeFlags      flags,
+                        int                  n_positions)
+{
+  rounding->mode = ROUND_NONE;
+
+  if ((flags & PANGO_SHAPE_ROUND_POSITIONS) == 0)
+    {
+      rounding->n_positions = n_positions;
+      if (rounding->n_positions == 0)
+        return;
+
+      /* Quantize in device units, like hinting does */
+      rounding->x_scale_inv = rounding->y_scale_inv = 1.0;
+      if (analysis->font)
+        pango_font_get_scale_factors (analysis->font,
+                                      &rounding->x_scale_inv,
+                                      &rounding->y_scale_inv);
+
+      if (PANGO_GRAVITY_IS_IMPROPER (analysis->gravity))
+        {
+          rounding->x_scale_inv = -rounding->x_scale_inv;
+          rounding->y_scale_inv = -rounding->y_scale_inv;
+        }
+
+      rounding->x_scale = 1.0 / rounding->x_scale_inv;
+      rounding->y_scale = 1.0 / rounding->y_scale_inv;
+      rounding->mode = ROUND_QUANTIZE;
+
+      return;
+    }
+
+  if (analysis->font && pango_font_is_hinted (analysis->font))
+    {
+      double x_scale_inv, y_scale_inv;
+
+      pango_font_get_scale_factors (analysis->font, &x_scale_inv, &y_scale_inv);
+
+      if (PANGO_GRAVITY_IS_IMPROPER (analysis->gravity))
+        {
+          x_scale_inv = -x_scale_inv;
+          y_scale_inv = -y_scale_inv;
+        }
+
+      rounding->x_scale_inv = x_scale_inv;
+      rounding->y_scale_inv = y_scale_inv;
+      rounding->x_scale = 1.0 / x_scale_inv;
+      rounding->y_scale = 1.0 / y_scale_inv;
+
+      if (rounding->x_scale == 1.0 && rounding->y_scale == 1.0)
+        rounding->mode = ROUND_WIDTH;
+      else
+        rounding->mode = ROUND_HINT;
+    }
+  else
+    rounding->mode = ROUND_ALL;
+}
+
+/* Rounds @value, in Pango units, to the nearest of @n_positions
+ * evenly spaced positions per device unit
+ */
+static inline int
+pango_units_quantize (int value,
+                      int n_positions)
+{
+  double q = floor ((double) value * n_positions / PANGO_SCALE + 0.5);
+
+  return (int) floor (q * PANGO_SCALE / n_positions + 0.5);
+}
+
+static inline void
+position_rounding_apply (const PositionRounding *rounding,
+                         PangoGlyphGeometry     *geometry)
+{
+#define HINT(value, scale_inv, scale) (PANGO_UNITS_ROUND ((int) ((value) * scale)) * scale_inv)
+#define HINT_X(value) HINT ((value), rounding->x_scale, rounding->x_scale_inv)
+#define HINT_Y(value) HINT ((value), rounding->y_scale, rounding->y_scale_inv)
+#define QUANTIZE(value, scale_inv, scale) (pango_units_quantize ((int) ((value) * scale), rounding->n_positions) * scale_inv)
+#define QUANTIZE_X(value) QUANTIZE ((value), rounding->x_scale, rounding->x_scale_inv)
+#define QUANTIZE_Y(value) QUANTIZE ((value), rounding->y_scale, rounding->y_scale_inv)
+  switch (rounding->mode)
+    {
+    case ROUND_WIDTH:
+      geometry->width = PANGO_UNITS_ROUND (geometry->width);
+      break;
+
+    case ROUND_ALL:
+      geometry->width = PANGO_UNITS_ROUND (geometry->width);
+      geometry->x_offset = PANGO_UNITS_ROUND (geometry->x_offset);
+      geometry->y_offset = PANGO_UNITS_ROUND (geometry->y_offset);
+      break;
+
+    case ROUND_HINT:
+      geometry->width    = HINT_X (geometry->width);
+      geometry->x_offset = HINT_X (geometry->x_offset);
+      geometry->y_offset = HINT_Y (geometry->y_offset);
+      break;
+
+    case ROUND_QUANTIZE:
+      geometry->width    = QUANTIZE_X (geometry->width);
+      geometry->x_offset = QUANTIZE_X (geometry->x_offset);
+      geometry->y_offset = QUANTIZE_Y (geometry->y_offset);
+      break;
+
+    case ROUND_NONE:
+    default:
+      break;
+    }
+#undef QUANTIZE_Y
+#undef QUANTIZE_X
+#undef QUANTIZE
+#undef HINT_Y
+#undef HINT_X
+#undef HINT
+}
+
+/* Quantizes a horizontal distance the way shaping quantizes glyph
+ * widths, to @n_positions positions per device unit of the font
+ */
+int
+pango_analysis_quantize_width (const PangoAnalysis *analysis,
+                               int                  width,
+                               int                  n_positions)
+{
+  PositionRounding rounding;
+  PangoGlyphGeometry geometry = { width, 0, 0 };
+
+  position_rounding_init (&rounding, analysis, PANGO_SHAPE_NONE, n_positions);
+  position_rounding_apply (&rounding, &geometry);
+
+  return geometry.width;
+}
+
+/* }}} */
+/* {{{ Shaping implementation */
+
+/* Like pango_shape_item(), but also quantizes glyph positions to
+ * @n_positions positions per device unit unless @flags asks for
+ * rounding them. See pango_context_set_subpixel_positions().
+ */
+void
 pango_shape_internal (const char          *item_text,
                       int                  item_length,
                       const char          *paragraph_text,
@@ -621,7 +827,8 @@ pango_shape_internal (const char          *item_text,
                       PangoLogAttr        *log_attrs,
                       int                  num_chars,
                       PangoGlyphString    *glyphs,
-                      PangoShapeFlags      flags)
+                      PangoShapeFlags      flags,
+                      int                  n_positions)
 {
   int i;
   int last_cluster;
@@ -726,67 +933,67 @@ pango_shape_internal (const char          *item_text,
       pango_glyph_string_reverse_range (glyphs, 0, glyphs->num_glyphs);
     }
 
-  if (flags & PANGO_SHAPE_ROUND_POSITIONS)
+  if ((flags & PANGO_SHAPE_ROUND_POSITIONS) || n_positions != 0)
     {
-      if (analysis->font && pango_font_is_hinted (analysis->font))
-        {
-          double x_scale_inv, y_scale_inv;
-          double x_scale, y_scale;
+      PositionRounding rounding;
 
-          pango_font_get_scale_factors (analysis->font, &x_scale_inv, &y_scale_inv);
+      position_rounding_init (&rounding, analysis, flags, n_positions);
+      for (i = 0; i < glyphs->num_glyphs; i++)
+        position_rounding_apply (&rounding, &glyphs->glyphs[i].geometry);
+    }
+}
 
-          if (PANGO_GRAVITY_IS_IMPROPER (analysis->gravity))
-            {
-              x_scale_inv = -x_scale_inv;
-              y_scale_inv = -y_scale_inv;
-            }
+/* Shapes into a temporary glyph string and copies the result out.
+ * Used by pango_shape_item_to_buffers() for the cases that HarfBuzz
+ * does not handle, such as items without font.
+ */
+static int
+shape_item_to_buffers_slow (PangoItem       *item,
+                            const char      *paragraph_text,
+                            int              paragraph_length,
+                            PangoLogAttr    *log_attrs,
+                            PangoShapeFlags  flags,
+                            int              n_glyphs,
+                            PangoGlyph      *glyphs,
+                            int             *advances,
+                            int             *x_offsets,
+                            int             *y_offsets,
+                            int             *log_clusters)
+{
+  PangoGlyphString *string;
+  int num_glyphs;
+  int i;
 
-          x_scale = 1.0 / x_scale_inv;
-          y_scale = 1.0 / y_scale_inv;
+  string = pango_glyph_string_new ();
 
-          if (x_scale == 1.0 && y_scale == 1.0)
-            {
-              for (i = 0; i < glyphs->num_glyphs; i++)
-                glyphs->glyphs[i].geometry.width = PANGO_UNITS_ROUND (glyphs->glyphs[i].geometry.width);
-            }
-          else
-            {
-    #if 0
-                  if (PANGO_GRAVITY_IS_VERTICAL (analysis->gravity))
-                    {
-                      /* XXX */
-                      double tmp = x_scale;
-                      x_scale = y_scale;
-                      y_scale = -tmp;
-                    }
-    #endif
-    #define HINT(value, scale_inv, scale) (PANGO_UNITS_ROUND ((int) ((value) * scale)) * scale_inv)
-    #define HINT_X(value) HINT ((value), x_scale, x_scale_inv)
-    #define HINT_Y(value) HINT ((value), y_scale, y_scale_inv)
-              for (i = 0; i < glyphs->num_glyphs; i++)
-                {
-                  glyphs->glyphs[i].geometry.width    = HINT_X (glyphs->glyphs[i].geometry.width);
-                  glyphs->glyphs[i].geometry.x_offset = HINT_X (glyphs->glyphs[i].geometry.x_offset);
-                  glyphs->glyphs[i].geometry.y_offset = HINT_Y (glyphs->glyphs[i].geometry.y_offset);
-                }
-    #undef HINT_Y
-    #undef HINT_X
-    #undef HINT
-            }
-        }
-      else
+  pango_shape_internal (paragraph_text + item->offset, item->length,
+                        paragraph_text, paragraph_length,
+                        &item->analysis,
+                        log_attrs, item->num_chars,
+                        string, flags, 0);
+
+  num_glyphs = string->num_glyphs;
+
+  if (num_glyphs <= n_glyphs)
+    {
+      for (i = 0; i < num_glyphs; i++)
         {
-          for (i = 0; i < glyphs->num_glyphs; i++)
-            {
-              glyphs->glyphs[i].geometry.width =
-                PANGO_UNITS_ROUND (glyphs->glyphs[i].geometry.width);
-              glyphs->glyphs[i].geometry.x_offset =
-                PANGO_UNITS_ROUND (glyphs->glyphs[i].geometry.x_offset);
-              glyphs->glyphs[i].geometry.y_offset =
-                PANGO_UNITS_ROUND (glyphs->glyphs[i].geometry.y_offset);
-            }
+          if (glyphs)
+            glyphs[i] = string->glyphs[i].glyph;
+          if (advances)
+            advances[i] = string->glyphs[i].geometry.width;
+          if (x_offsets)
+            x_offsets[i] = string->glyphs[i].geometry.x_offset;
+          if (y_offsets)
+            y_offsets[i] = string->glyphs[i].geometry.y_offset;
+          if (log_clusters)
+            log_clusters[i] = string->log_clusters[i];
         }
     }
+
+  pango_glyph_string_free (string);
+
+  return num_glyphs;
 }
 
 /* }}} */
@@ -920,7 +1127,7 @@ pango_shape_with_flags (const char          *item_text,
   pango_shape_internal (item_text, item_length,
                         paragraph_text, paragraph_length,
                         analysis, NULL, 0,
-                        glyphs, flags);
+                        glyphs, flags, 0);
 }
 
 /**
@@ -961,7 +1168,171 @@ pango_shape_item (PangoItem        *item,
                         paragraph_text, paragraph_length,
                         &item->analysis,
                         log_attrs, item->num_chars,
-                        glyphs, flags);
+                        glyphs, flags, 0);
+}
+
+/**
+ * pango_shape_item_to_buffers:
+ * @item: `PangoItem` to shape
+ * @paragraph_text: text of the paragraph (see details)
+ * @paragraph_length: the length (in bytes) of @paragraph_text.
+ *     -1 means nul-terminated text.
+ * @log_attrs: (nullable): array of `PangoLogAttr` for @item
+ * @flags: flags influencing the shaping process
+ * @n_glyphs: the number of elements available in each of the
+ *   output arrays
+ * @glyphs: (nullable) (array length=n_glyphs): return location
+ *   for the glyph IDs
+ * @advances: (nullable) (array length=n_glyphs): return location
+ *   for the glyph advances, in Pango units
+ * @x_offsets: (nullable) (array length=n_glyphs): return location
+ *   for the horizontal glyph offsets, in Pango units
+ * @y_offsets: (nullable) (array length=n_glyphs): return location
+ *   for the vertical glyph offsets, in Pango units
+ * @log_clusters: (nullable) (array length=n_glyphs): return location
+ *   for the byte offset of the cluster start of each glyph,
+ *   relative to the start of @item
+ *
+ * Convert the characters in @item into glyphs, storing the results
+ * in caller-provided arrays.
+ *
+ * This is similar to [func@Pango.shape_item], except that the shaping
+ * results are written directly into separate arrays instead of a
+ * `PangoGlyphString`. The values stored are the same as those found
+ * in the `glyph`, `geometry` and `log_clusters` fields of the glyph
+ * string that [func@Pango.shape_item] would produce. Any of the output
+ * arrays may be %NULL if the caller is not interested in the values.
+ *
+ * If @n_glyphs is smaller than the number of glyphs produced, nothing
+ * is stored and the required number of glyphs is returned. Passing
+ * 0 for @n_glyphs can thus be used to query the size that the arrays
+ * need to have. Note that this requires shaping the item, so callers
+ * should try with a reasonable estimate, such as the number of
+ * characters in the item, first.
+ *
+ * Returns: the number of glyphs that @item shapes to
+ *
+ * Since: 1.56
+ */
+int
+pango_shape_item_to_buffers (PangoItem       *item,
+                             const char      *paragraph_text,
+                             int              paragraph_length,
+                             PangoLogAttr    *log_attrs,
+                             PangoShapeFlags  flags,
+                             int              n_glyphs,
+                             PangoGlyph      *glyphs,
+                             int             *advances,
+                             int             *x_offsets,
+                             int             *y_offsets,
+                             int             *log_clusters)
+{
+  PangoHbShapeResult result = { { 0, }, };
+  const PangoAnalysis *analysis;
+  hb_glyph_info_t *hb_glyph;
+  hb_glyph_position_t *hb_position;
+  PositionRounding rounding;
+  gboolean vertical;
+  gboolean reverse;
+  int num_glyphs;
+  int i;
+
+  g_return_val_if_fail (item != NULL, 0);
+  g_return_val_if_fail (paragraph_text != NULL, 0);
+  g_return_val_if_fail (n_glyphs >= 0, 0);
+
+  analysis = &item->analysis;
+
+  if (paragraph_length == -1)
+    paragraph_length = strlen (paragraph_text);
+
+  g_return_val_if_fail (item->offset + item->length <= paragraph_length, 0);
+
+  if (G_UNLIKELY (!analysis->font))
+    return shape_item_to_buffers_slow (item, paragraph_text, paragraph_length,
+                                       log_attrs, flags, n_glyphs,
+                                       glyphs, advances, x_offsets, y_offsets,
+                                       log_clusters);
+
+  pango_hb_shape_to_buffer (paragraph_text + item->offset, item->length,
+                            paragraph_text, paragraph_length,
+                            analysis,
+                            log_attrs, item->num_chars,
+                            &result);
+
+  num_glyphs = hb_buffer_get_length (result.hb_buffer);
+
+  /* Let the slow path deal with warnings and fallback shaping */
+  if (G_UNLIKELY (num_glyphs == 0))
+    {
+      pango_hb_shape_result_clear (&result);
+      return shape_item_to_buffers_slow (item, paragraph_text, paragraph_length,
+                                         log_attrs, flags, n_glyphs,
+                                         glyphs, advances, x_offsets, y_offsets,
+                                         log_clusters);
+    }
+
+  if (num_glyphs > n_glyphs)
+    {
+      pango_hb_shape_result_clear (&result);
+      return num_glyphs;
+    }
+
+  hb_glyph = hb_buffer_get_glyph_infos (result.hb_buffer, NULL);
+  hb_position = hb_buffer_get_glyph_positions (result.hb_buffer, NULL);
+  vertical = PANGO_GRAVITY_IS_VERTICAL (analysis->gravity);
+
+  /* Make sure the glyph order conforms to analysis->level,
+   * see pango_shape_internal()
+   */
+  reverse = (analysis->level & 1) && hb_glyph[0].cluster < hb_glyph[num_glyphs - 1].cluster;
+  if (G_UNLIKELY (reverse))
+    g_warning ("Expected RTL run but got LTR. Fixing.");
+
+  position_rounding_init (&rounding, analysis, flags, 0);
+
+  for (i = 0; i < num_glyphs; i++)
+    {
+      PangoGlyphGeometry geometry;
+      int j = G_UNLIKELY (reverse) ? num_glyphs - 1 - i : i;
+
+      if (vertical)
+        {
+          /* 90 degrees rotation counter-clockwise. */
+          geometry.width    = - hb_position[i].y_advance;
+          geometry.x_offset = - hb_position[i].y_offset;
+          geometry.y_offset = - hb_position[i].x_offset;
+        }
+      else
+        {
+          geometry.width    =   hb_position[i].x_advance;
+          geometry.x_offset =   hb_position[i].x_offset;
+          geometry.y_offset = - hb_position[i].y_offset;
+        }
+
+      if (geometry.width < 0)
+        {
+          geometry.width = - geometry.width;
+          geometry.x_offset += geometry.width;
+        }
+
+      position_rounding_apply (&rounding, &geometry);
+
+      if (glyphs)
+        glyphs[j] = hb_glyph[i].codepoint;
+      if (advances)
+        advances[j] = geometry.width;
+      if (x_offsets)
+        x_offsets[j] = geometry.x_offset;
+      if (y_offsets)
+        y_offsets[j] = geometry.y_offset;
+      if (log_clusters)
+        log_clusters[j] = hb_glyph[i].cluster - result.item_offset;
+    }
+
+  pango_hb_shape_result_clear (&result);
+
+  return num_glyphs;
 }
 
 /* }}} */
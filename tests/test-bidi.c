@@ -129,6 +129,12 @@ test_bidi_embedding_levels (void)
     { "one two ثلاثة ١٢٣٤ خمسة", PANGO_DIRECTION_LTR, "\0\0\0\0\0\0\0\0\1\1\1\1\1\1\2\2\2\2\1\1\1\1\1", PANGO_DIRECTION_LTR },
     { "abאב12cd", PANGO_DIRECTION_LTR, "\0\0\1\1\2\2\0\0" },
     { "abאב‪xy‬cd", PANGO_DIRECTION_LTR, "\0\0\1\1\1\2\2\2\0\0" },
+    /* Unidirectional text that does not go through FriBidi */
+    { "abc def", PANGO_DIRECTION_WEAK_LTR, "\0\0\0\0\0\0\0", PANGO_DIRECTION_LTR },
+    { "abc def", PANGO_DIRECTION_WEAK_RTL, "\0\0\0\0\0\0\0", PANGO_DIRECTION_LTR },
+    { "abc def", PANGO_DIRECTION_RTL, "\2\2\2\2\2\2\2", PANGO_DIRECTION_RTL },
+    { "Crème brûlée", PANGO_DIRECTION_NEUTRAL, "\0\0\0\0\0\0\0\0\0\0\0\0", PANGO_DIRECTION_LTR },
+    { "abcdefghijklmnop אב", PANGO_DIRECTION_LTR, "\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\1\1", PANGO_DIRECTION_LTR },
 
   };
 
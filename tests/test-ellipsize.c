@@ -122,6 +122,100 @@ test_ellipsize_fully (void)
   g_object_unref (fontmap);
 }
 
+/* Check that resizing an ellipsized layout gives the same
+ * result as laying it out at the new width from scratch.
+ */
+static void
+test_ellipsize_resize (void)
+{
+  const PangoEllipsizeMode modes[] = {
+    PANGO_ELLIPSIZE_START,
+    PANGO_ELLIPSIZE_MIDDLE,
+    PANGO_ELLIPSIZE_END,
+  };
+  PangoFontMap *fontmap;
+  PangoContext *context;
+  PangoLayout *layout, *fresh;
+  guint i;
+  int width;
+
+  fontmap = pango_cairo_font_map_new ();
+  context = pango_font_map_create_context (fontmap);
+
+  for (i = 0; i < G_N_ELEMENTS (modes); i++)
+    {
+      layout = pango_layout_new (context);
+      pango_layout_set_markup (layout, "some <b>text</b> that should be <i>ellipsized</i> while resizing", -1);
+      pango_layout_set_ellipsize (layout, modes[i]);
+
+      for (width = 400; width >= 0; width -= 7)
+        {
+          PangoRectangle logical, fresh_logical;
+
+          pango_layout_set_width (layout, width * PANGO_SCALE);
+
+          fresh = pango_layout_copy (layout);
+
+          pango_layout_get_extents (layout, NULL, &logical);
+          pango_layout_get_extents (fresh, NULL, &fresh_logical);
+
+          g_assert_cmpint (pango_layout_is_ellipsized (layout), ==, pango_layout_is_ellipsized (fresh));
+          g_assert_cmpint (logical.width, ==, fresh_logical.width);
+          g_assert_cmpint (pango_layout_get_line_readonly (layout, 0)->length, ==,
+                           pango_layout_get_line_readonly (fresh, 0)->length);
+          g_assert_cmpint (g_slist_length (pango_layout_get_line_readonly (layout, 0)->runs), ==,
+                           g_slist_length (pango_layout_get_line_readonly (fresh, 0)->runs));
+
+          g_object_unref (fresh);
+        }
+
+      g_object_unref (layout);
+    }
+
+  g_object_unref (context);
+  g_object_unref (fontmap);
+}
+
+static void
+test_ellipsize_resize_perf (void)
+{
+  PangoFontMap *fontmap;
+  PangoContext *context;
+  PangoLayout *layout;
+  GString *text;
+  PangoRectangle logical;
+  int i, width;
+  gdouble elapsed;
+
+  fontmap = pango_cairo_font_map_new ();
+  context = pango_font_map_create_context (fontmap);
+  layout = pango_layout_new (context);
+
+  text = g_string_new ("");
+  for (i = 0; i < 50; i++)
+    g_string_append (text, "Some text that should be ellipsized while resizing.\n");
+
+  pango_layout_set_text (layout, text->str, text->len);
+  pango_layout_set_ellipsize (layout, PANGO_ELLIPSIZE_MIDDLE);
+
+  g_test_timer_start ();
+
+  for (i = 0; i < 20; i++)
+    for (width = 600; width > 0; width -= 3)
+      {
+        pango_layout_set_width (layout, width * PANGO_SCALE);
+        pango_layout_get_extents (layout, NULL, &logical);
+      }
+
+  elapsed = g_test_timer_elapsed ();
+  g_test_minimized_result (elapsed, "resized 50 ellipsized lines 4000 times in %g seconds", elapsed);
+
+  g_string_free (text, TRUE);
+  g_object_unref (layout);
+  g_object_unref (context);
+  g_object_unref (fontmap);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -130,6 +224,10 @@ main (int argc, char *argv[])
   g_test_add_func ("/layout/ellipsize/height", test_ellipsize_height);
   g_test_add_func ("/layout/ellipsize/crash", test_ellipsize_crash);
   g_test_add_func ("/layout/ellipsize/fully", test_ellipsize_fully);
+  g_test_add_func ("/layout/ellipsize/resize", test_ellipsize_resize);
+
+  if (g_test_perf ())
+    g_test_add_func ("/perf/ellipsize-resize", test_ellipsize_resize_perf);
 
   return g_test_run ();
 }
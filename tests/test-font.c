@@ -88,6 +88,144 @@ test_roundtrip (void)
   g_free (str);
 }
 
+static void
+test_parse_keywords (void)
+{
+  PangoFontDescription *desc;
+
+  desc = pango_font_description_from_string ("Sans SemiBold Italic 12");
+  g_assert_cmpstr (pango_font_description_get_family (desc), ==, "Sans");
+  g_assert_cmpint (pango_font_description_get_weight (desc), ==, PANGO_WEIGHT_SEMIBOLD);
+  g_assert_cmpint (pango_font_description_get_style (desc), ==, PANGO_STYLE_ITALIC);
+  g_assert_cmpint (pango_font_description_get_size (desc), ==, 12 * PANGO_SCALE);
+  pango_font_description_free (desc);
+
+  /* Keywords are case-insensitive and ignore dashes */
+  desc = pango_font_description_from_string ("Sans semi-bold ULTRA-condensed 12");
+  g_assert_cmpstr (pango_font_description_get_family (desc), ==, "Sans");
+  g_assert_cmpint (pango_font_description_get_weight (desc), ==, PANGO_WEIGHT_SEMIBOLD);
+  g_assert_cmpint (pango_font_description_get_stretch (desc), ==, PANGO_STRETCH_ULTRA_CONDENSED);
+  pango_font_description_free (desc);
+
+  desc = pango_font_description_from_string ("Sans weight=bold 12");
+  g_assert_cmpint (pango_font_description_get_weight (desc), ==, PANGO_WEIGHT_BOLD);
+  pango_font_description_free (desc);
+
+  /* Words that only look like keywords stay in the family */
+  desc = pango_font_description_from_string ("Sans Boldest 12");
+  g_assert_cmpstr (pango_font_description_get_family (desc), ==, "Sans Boldest");
+  g_assert_cmpint (pango_font_description_get_weight (desc), ==, PANGO_WEIGHT_NORMAL);
+  pango_font_description_free (desc);
+
+  /* Repeated parses hand out independent copies */
+  desc = pango_font_description_from_string ("Sans Bold 12");
+  pango_font_description_set_size (desc, 20 * PANGO_SCALE);
+  pango_font_description_free (desc);
+  desc = pango_font_description_from_string ("Sans Bold 12");
+  g_assert_cmpint (pango_font_description_get_size (desc), ==, 12 * PANGO_SCALE);
+  pango_font_description_free (desc);
+}
+
+static void
+test_intern (void)
+{
+  PangoFontDescription *desc1, *desc2;
+  const PangoFontDescription *interned1, *interned2;
+
+  desc1 = pango_font_description_from_string ("Cantarell Bold 14");
+  desc2 = pango_font_description_new ();
+  pango_font_description_set_family (desc2, "Cantarell");
+  pango_font_description_set_weight (desc2, PANGO_WEIGHT_BOLD);
+  pango_font_description_set_size (desc2, 14 * PANGO_SCALE);
+
+  interned1 = pango_font_description_intern (desc1);
+  interned2 = pango_font_description_intern (desc2);
+
+  g_assert_true (interned1 == interned2);
+  g_assert_true (interned1 != desc1);
+  g_assert_true (pango_font_description_equal (interned1, desc1));
+  g_assert_cmpuint (pango_font_description_hash (interned1), ==, pango_font_description_hash (desc1));
+  g_assert_true (pango_font_description_intern (interned1) == interned1);
+
+  /* Differing set fields give a different description */
+  pango_font_description_unset_fields (desc2, PANGO_FONT_MASK_WEIGHT);
+  pango_font_description_set_weight (desc2, PANGO_WEIGHT_NORMAL);
+  interned2 = pango_font_description_intern (desc2);
+  g_assert_true (interned1 != interned2);
+  g_assert_false (pango_font_description_equal (interned1, interned2));
+
+  pango_font_description_free (desc1);
+  pango_font_description_free (desc2);
+}
+
+static void
+test_parse_perf (void)
+{
+  const char *strings[] = {
+    "Cantarell 14",
+    "Sans Bold Italic Condensed 22.5px",
+    "Monospace Semi-Light 10",
+    "DejaVu Serif Ultra-Bold Small-Caps 9",
+  };
+  PangoFontDescription *desc;
+  guint i;
+  gdouble elapsed;
+
+  g_test_timer_start ();
+
+  for (i = 0; i < 1000000; i++)
+    {
+      desc = pango_font_description_from_string (strings[i % G_N_ELEMENTS (strings)]);
+      pango_font_description_free (desc);
+    }
+
+  elapsed = g_test_timer_elapsed ();
+  g_test_minimized_result (elapsed, "parsed 1000000 font descriptions in %g seconds", elapsed);
+}
+
+/* More distinct strings than the parse cache holds, so
+ * this times the parser itself
+ */
+static void
+test_parse_distinct_perf (void)
+{
+  const char *families[] = { "Cantarell", "Sans", "Monospace", "DejaVu Serif" };
+  const char *styles[] = {
+    "Bold Italic Condensed",
+    "Semi-Light",
+    "Ultra-Bold Small-Caps",
+    "Oblique Expanded",
+    "Heavy",
+    "Light Italic",
+    "Medium Semi-Condensed",
+    "Book",
+  };
+  char *strings[4096];
+  PangoFontDescription *desc;
+  guint i;
+  gdouble elapsed;
+
+  for (i = 0; i < G_N_ELEMENTS (strings); i++)
+    strings[i] = g_strdup_printf ("%s %s %d",
+                                  families[i % G_N_ELEMENTS (families)],
+                                  styles[(i / G_N_ELEMENTS (families)) % G_N_ELEMENTS (styles)],
+                                  6 + i / (G_N_ELEMENTS (families) * G_N_ELEMENTS (styles)));
+
+  g_test_timer_start ();
+
+  for (i = 0; i < 1000000; i++)
+    {
+      desc = pango_font_description_from_string (strings[i % G_N_ELEMENTS (strings)]);
+      pango_font_description_free (desc);
+    }
+
+  elapsed = g_test_timer_elapsed ();
+  g_test_minimized_result (elapsed, "parsed 1000000 font descriptions from 4096 strings in %g seconds", elapsed);
+
+  for (i = 0; i < G_N_ELEMENTS (strings); i++)
+    g_free (strings[i]);
+}
+
 static void
 test_variations (void)
 {
@@ -231,6 +369,167 @@ test_extents (void)
   g_object_unref (fontmap);
 }
 
+/* Computes the extents the simple way, one glyph at a time */
+static void
+get_reference_extents (PangoGlyphString *glyphs,
+                       int               start,
+                       int               end,
+                       PangoFont        *font,
+                       PangoRectangle   *ink_rect,
+                       PangoRectangle   *logical_rect)
+{
+  int x_pos = 0;
+
+  *ink_rect = (PangoRectangle) { 0, };
+  *logical_rect = (PangoRectangle) { 0, };
+
+  for (int i = start; i < end; i++)
+    {
+      PangoGlyphGeometry *geometry = &glyphs->glyphs[i].geometry;
+      PangoRectangle ink, logical;
+
+      pango_font_get_glyph_extents (font, glyphs->glyphs[i].glyph, &ink, &logical);
+
+      if (ink.width != 0 && ink.height != 0)
+        {
+          if (ink_rect->width == 0 || ink_rect->height == 0)
+            *ink_rect = (PangoRectangle) { x_pos + ink.x + geometry->x_offset, ink.y + geometry->y_offset, ink.width, ink.height };
+          else
+            {
+              int x = MIN (ink_rect->x, x_pos + ink.x + geometry->x_offset);
+              int y = MIN (ink_rect->y, ink.y + geometry->y_offset);
+
+              ink_rect->width = MAX (ink_rect->x + ink_rect->width, x_pos + ink.x + ink.width + geometry->x_offset) - x;
+              ink_rect->height = MAX (ink_rect->y + ink_rect->height, ink.y + ink.height + geometry->y_offset) - y;
+              ink_rect->x = x;
+              ink_rect->y = y;
+            }
+        }
+
+      if (i == start)
+        {
+          logical_rect->y = logical.y;
+          logical_rect->height = logical.height;
+        }
+      else
+        {
+          int y = MIN (logical_rect->y, logical.y);
+
+          logical_rect->height = MAX (logical_rect->y + logical_rect->height, logical.y + logical.height) - y;
+          logical_rect->y = y;
+        }
+
+      logical_rect->width += geometry->width;
+      x_pos += geometry->width;
+    }
+}
+
+static void
+assert_rect_equal (PangoRectangle *a,
+                   PangoRectangle *b)
+{
+  g_assert_cmpint (a->x, ==, b->x);
+  g_assert_cmpint (a->y, ==, b->y);
+  g_assert_cmpint (a->width, ==, b->width);
+  g_assert_cmpint (a->height, ==, b->height);
+}
+
+static void
+test_extents_range (void)
+{
+  const char *str = "The quick brown fox jumps over the lazy dog, "
+                    "and then it jumps back over the same dog again.";
+  GList *items;
+  PangoItem *item;
+  PangoGlyphString *glyphs;
+  PangoFontMap *fontmap;
+  PangoContext *context;
+  int ranges[][2] = { { 0, 0 }, { 0, 1 }, { 3, 10 }, { 0, -1 }, { 60, -1 } };
+
+  fontmap = pango_cairo_font_map_new ();
+  context = pango_font_map_create_context (fontmap);
+
+  items = pango_itemize (context, str, 0, strlen (str), NULL, NULL);
+  glyphs = pango_glyph_string_new ();
+  item = items->data;
+  pango_shape (str, strlen (str), &item->analysis, glyphs);
+  g_assert_cmpint (glyphs->num_glyphs, >, 64);
+
+  /* Hex boxes have their own logical extents */
+  glyphs->glyphs[5].glyph = PANGO_GET_UNKNOWN_GLYPH (0x1234);
+  glyphs->glyphs[70].glyph = PANGO_GLYPH_EMPTY;
+
+  for (int i = 0; i < G_N_ELEMENTS (ranges); i++)
+    {
+      int start = ranges[i][0];
+      int end = ranges[i][1] < 0 ? glyphs->num_glyphs : ranges[i][1];
+      PangoRectangle ink, logical, ref_ink, ref_logical;
+
+      get_reference_extents (glyphs, start, end, item->analysis.font, &ref_ink, &ref_logical);
+
+      pango_glyph_string_extents_range (glyphs, start, end, item->analysis.font, &ink, &logical);
+      assert_rect_equal (&ink, &ref_ink);
+      assert_rect_equal (&logical, &ref_logical);
+
+      pango_glyph_string_extents_range (glyphs, start, end, item->analysis.font, NULL, &logical);
+      assert_rect_equal (&logical, &ref_logical);
+
+      pango_glyph_string_extents_range (glyphs, start, end, item->analysis.font, &ink, NULL);
+      assert_rect_equal (&ink, &ref_ink);
+    }
+
+  pango_glyph_string_free (glyphs);
+  g_list_free_full (items, (GDestroyNotify)pango_item_free);
+  g_object_unref (context);
+  g_object_unref (fontmap);
+}
+
+static void
+test_extents_perf (void)
+{
+  GString *str;
+  GList *items;
+  PangoItem *item;
+  PangoGlyphString *glyphs;
+  PangoFontMap *fontmap;
+  PangoContext *context;
+  PangoRectangle ink, logical;
+  gdouble both_time, logical_time;
+
+  str = g_string_new ("");
+  for (int i = 0; i < 100; i++)
+    g_string_append (str, "The quick brown fox jumps over the lazy dog. ");
+
+  fontmap = pango_cairo_font_map_new ();
+  context = pango_font_map_create_context (fontmap);
+
+  items = pango_itemize (context, str->str, 0, str->len, NULL, NULL);
+  glyphs = pango_glyph_string_new ();
+  item = items->data;
+  pango_shape (str->str, str->len, &item->analysis, glyphs);
+
+  g_test_timer_start ();
+  for (int i = 0; i < 1000; i++)
+    pango_glyph_string_extents (glyphs, item->analysis.font, &ink, &logical);
+  both_time = g_test_timer_elapsed ();
+
+  g_test_timer_start ();
+  for (int i = 0; i < 1000; i++)
+    pango_glyph_string_extents (glyphs, item->analysis.font, NULL, &logical);
+  logical_time = g_test_timer_elapsed ();
+
+  g_test_minimized_result (both_time, "ink and logical extents of %d glyphs, 1000 times: %g seconds",
+                           glyphs->num_glyphs, both_time);
+  g_test_minimized_result (logical_time, "logical extents of %d glyphs, 1000 times: %g seconds",
+                           glyphs->num_glyphs, logical_time);
+
+  pango_glyph_string_free (glyphs);
+  g_list_free_full (items, (GDestroyNotify)pango_item_free);
+  g_object_unref (context);
+  g_object_unref (fontmap);
+  g_string_free (str, TRUE);
+}
+
 static void
 test_enumerate (void)
 {
@@ -872,6 +1171,8 @@ main (int argc, char *argv[])
   g_test_add_func ("/pango/font/metrics", test_metrics);
   g_test_add_func ("/pango/fontdescription/parse", test_parse);
   g_test_add_func ("/pango/fontdescription/roundtrip", test_roundtrip);
+  g_test_add_func ("/pango/fontdescription/parse-keywords", test_parse_keywords);
+  g_test_add_func ("/pango/fontdescription/intern", test_intern);
   g_test_add_func ("/pango/fontdescription/variations", test_variations);
   g_test_add_func ("/pango/fontdescription/empty-variations", test_empty_variations);
   g_test_add_func ("/pango/fontdescription/to-filename", test_to_filename);
@@ -886,10 +1187,18 @@ main (int argc, char *argv[])
   g_test_add_func ("/pango/font/roundtrip/emoji", test_roundtrip_emoji);
   g_test_add_func ("/pango/font/models", test_font_models);
   g_test_add_func ("/pango/font/glyph-extents", test_glyph_extents);
+  g_test_add_func ("/pango/font/extents-range", test_extents_range);
   g_test_add_func ("/pango/font/font-metrics", test_font_metrics);
   g_test_add_func ("/pango/font/scale-font/plain", test_font_scale);
   g_test_add_func ("/pango/font/scale-font/variations", test_font_scale_variations);
   g_test_add_func ("/pango/font/custom", test_font_custom);
 
+  if (g_test_perf ())
+    {
+      g_test_add_func ("/perf/fontdescription/parse", test_parse_perf);
+      g_test_add_func ("/perf/fontdescription/parse-distinct", test_parse_distinct_perf);
+      g_test_add_func ("/perf/glyph-string/extents", test_extents_perf);
+    }
+
   return g_test_run ();
 }
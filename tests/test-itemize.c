@@ -338,6 +338,69 @@ test_itemize (gconstpointer d)
   g_free (expected_file);
 }
 
+static void
+test_itemize_perf (void)
+{
+  PangoFontMap *fontmap;
+  PangoContext *context;
+  GDir *dir;
+  GError *error = NULL;
+  const char *name;
+  char *path;
+  GString *text;
+  double elapsed;
+
+  text = g_string_new ("");
+  path = g_test_build_filename (G_TEST_DIST, "..", "utils", NULL);
+  dir = g_dir_open (path, 0, &error);
+  g_assert_no_error (error);
+  while ((name = g_dir_read_name (dir)) != NULL)
+    {
+      char *filename;
+      char *contents;
+      gsize length;
+
+      if (!g_str_has_prefix (name, "test-") || !g_str_has_suffix (name, ".txt"))
+        continue;
+
+      filename = g_build_filename (path, name, NULL);
+      g_file_get_contents (filename, &contents, &length, &error);
+      g_assert_no_error (error);
+      g_string_append_len (text, contents, length);
+      g_free (contents);
+      g_free (filename);
+    }
+  g_dir_close (dir);
+  g_free (path);
+
+  fontmap = pango_cairo_font_map_new ();
+  context = pango_font_map_create_context (fontmap);
+
+  for (int gravity = PANGO_GRAVITY_SOUTH; gravity <= PANGO_GRAVITY_EAST; gravity++)
+    {
+      pango_context_set_base_gravity (context, gravity);
+
+      g_test_timer_start ();
+      for (int i = 0; i < 100; i++)
+        {
+          GList *items;
+
+          items = pango_itemize (context, text->str, 0, text->len, NULL, NULL);
+          g_list_free_full (items, (GDestroyNotify)pango_item_free);
+        }
+      elapsed = g_test_timer_elapsed ();
+
+      g_test_minimized_result (elapsed, "itemize %lu bytes, %s: %f s",
+                               (gulong) text->len,
+                               gravity == PANGO_GRAVITY_SOUTH ? "horizontal" : "vertical",
+                               elapsed);
+    }
+
+  g_object_unref (context);
+  g_object_unref (fontmap);
+  g_string_free (text, TRUE);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -376,5 +439,8 @@ main (int argc, char *argv[])
     }
   g_dir_close (dir);
 
+  if (g_test_perf ())
+    g_test_add_func ("/perf/itemize", test_itemize_perf);
+
   return g_test_run ();
 }
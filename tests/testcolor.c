@@ -110,6 +110,16 @@ ColorSpec specs [] = {
   { "#aabbccdd",     1, ALPHA, 0xaaaa, 0xbbbb, 0xcccc, 0xdddd },
   { "#aaaabbbbccccdddd",
                      1, ALPHA, 0xaaaa, 0xbbbb, 0xcccc, 0xdddd },
+  { "AliceBlue",     1, BOTH, 0xf0f0, 0xf8f8, 0xffff, 0xffff },
+  { "aliceblue",     1, BOTH, 0xf0f0, 0xf8f8, 0xffff, 0xffff },
+  { "alice blue",    1, BOTH, 0xf0f0, 0xf8f8, 0xffff, 0xffff },
+  { "ALICEBLUE",     1, BOTH, 0xf0f0, 0xf8f8, 0xffff, 0xffff },
+  { "AliceBlue ",    0, BOTH, 0, 0, 0, 0 },
+  { "AliceBlu",      0, BOTH, 0, 0, 0, 0 },
+  { "AliceBlueX",    0, BOTH, 0, 0, 0, 0 },
+  { "LightGoldenrodYellowish", 0, BOTH, 0, 0, 0, 0 },
+  { "yellow",        1, BOTH, 0xffff, 0xffff, 0x0000, 0xffff },
+  { "YellowGreen",   1, BOTH, 0x9a9a, 0xcdcd, 0x3232, 0xffff },
   { NULL,            0, BOTH, 0, 0, 0, 0 }
 };
 
@@ -150,6 +160,33 @@ test_color_serialize (void)
   g_free (string);
 }
 
+static void
+test_color_parse_perf (void)
+{
+  const char *specs[] = {
+    "red",
+    "LightGoldenrodYellow",
+    "#abc",
+    "#aabbcc",
+    "#aaaabbbbccccdddd",
+  };
+  PangoColor color;
+  guint16 alpha;
+  guint i, j;
+  gdouble elapsed;
+
+  for (i = 0; i < G_N_ELEMENTS (specs); i++)
+    {
+      g_test_timer_start ();
+
+      for (j = 0; j < 1000000; j++)
+        pango_color_parse_with_alpha (&color, &alpha, specs[i]);
+
+      elapsed = g_test_timer_elapsed ();
+      g_test_minimized_result (elapsed, "parsed %s 1000000 times in %g seconds", specs[i], elapsed);
+    }
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -159,5 +196,8 @@ main (int argc, char *argv[])
   g_test_add_func ("/color/copy", test_color_copy);
   g_test_add_func ("/color/serialize", test_color_serialize);
 
+  if (g_test_perf ())
+    g_test_add_func ("/perf/color-parse", test_color_parse_perf);
+
   return g_test_run ();
 }
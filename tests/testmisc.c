@@ -22,11 +22,17 @@
 #include "config.h"
 #include <glib.h>
 #include <pango/pangocairo.h>
+#include "pango/pango-emoji-table.h"
+#include "pango/pango-vertical-orientation-table.h"
 
 #ifdef HAVE_CAIRO_FREETYPE
 #include <pango/pango-ot.h>
 #endif
 
+#ifdef HAVE_FREETYPE
+#include <pango/pangoft2.h>
+#endif
+
 /* test that we don't crash in shape_tab when the layout
  * is such that we don't have effective attributes
  */
@@ -83,6 +89,37 @@ test_itemize_utf8 (void)
   g_object_unref (fontmap);
 }
 
+/* Test that vertical text is split where upright and
+ * rotated characters of the same script meet
+ */
+static void
+test_itemize_vertical_width (void)
+{
+  PangoFontMap *fontmap;
+  PangoContext *context;
+  GList *result, *l;
+  gboolean split = FALSE;
+
+  fontmap = pango_cairo_font_map_new ();
+  context = pango_font_map_create_context (fontmap);
+  pango_context_set_base_gravity (context, PANGO_GRAVITY_EAST);
+
+  /* 'a', FULLWIDTH LATIN CAPITAL LETTER A, 'b' */
+  result = pango_itemize (context, "a\xef\xbc\xa1" "b", 0, 5, NULL, NULL);
+  for (l = result; l; l = l->next)
+    {
+      PangoItem *item = l->data;
+
+      if (item->offset == 1)
+        split = TRUE;
+    }
+  g_assert_true (split);
+
+  g_list_free_full (result, (GDestroyNotify)pango_item_free);
+  g_object_unref (context);
+  g_object_unref (fontmap);
+}
+
 /* Test that pango_layout_set_text (layout, "short", 200)
  * does not lead to a crash. (pidgin does this)
  */
@@ -483,6 +520,71 @@ test_fallback_shape (void)
   g_object_unref (fontmap);
 }
 
+/* Test that shaping into caller-provided arrays gives
+ * the same results as shaping into a glyph string
+ */
+static void
+test_shape_to_buffers (void)
+{
+  PangoFontMap *fontmap;
+  PangoContext *context;
+  const char *text;
+  GList *items, *l;
+
+  fontmap = pango_cairo_font_map_new ();
+  context = pango_font_map_create_context (fontmap);
+
+  text = "Some text to sha​pe ﺄﻧﺍ ﻕﺍﺩﺭ ﻊﻟﻯ ﺄﻜﻟ";
+  items = pango_itemize (context, text, 0, strlen (text), NULL, NULL);
+  for (l = items; l; l = l->next)
+    {
+      PangoItem *item = l->data;
+      PangoGlyphString *glyphs;
+      PangoGlyph *ids;
+      int *advances, *x_offsets, *y_offsets, *clusters;
+      int n_glyphs;
+
+      glyphs = pango_glyph_string_new ();
+      pango_shape_item (item, text, -1, NULL, glyphs, PANGO_SHAPE_ROUND_POSITIONS);
+
+      /* preflight */
+      n_glyphs = pango_shape_item_to_buffers (item, text, -1, NULL, PANGO_SHAPE_ROUND_POSITIONS,
+                                              0, NULL, NULL, NULL, NULL, NULL);
+      g_assert_cmpint (n_glyphs, ==, glyphs->num_glyphs);
+
+      ids = g_new (PangoGlyph, n_glyphs);
+      advances = g_new (int, n_glyphs);
+      x_offsets = g_new (int, n_glyphs);
+      y_offsets = g_new (int, n_glyphs);
+      clusters = g_new (int, n_glyphs);
+
+      n_glyphs = pango_shape_item_to_buffers (item, text, -1, NULL, PANGO_SHAPE_ROUND_POSITIONS,
+                                              n_glyphs, ids, advances, x_offsets, y_offsets, clusters);
+      g_assert_cmpint (n_glyphs, ==, glyphs->num_glyphs);
+
+      for (int i = 0; i < n_glyphs; i++)
+        {
+          g_assert_cmpuint (ids[i], ==, glyphs->glyphs[i].glyph);
+          g_assert_cmpint (advances[i], ==, glyphs->glyphs[i].geometry.width);
+          g_assert_cmpint (x_offsets[i], ==, glyphs->glyphs[i].geometry.x_offset);
+          g_assert_cmpint (y_offsets[i], ==, glyphs->glyphs[i].geometry.y_offset);
+          g_assert_cmpint (clusters[i], ==, glyphs->log_clusters[i]);
+        }
+
+      g_free (ids);
+      g_free (advances);
+      g_free (x_offsets);
+      g_free (y_offsets);
+      g_free (clusters);
+      pango_glyph_string_free (glyphs);
+    }
+
+  g_list_free_full (items, (GDestroyNotify)pango_item_free);
+
+  g_object_unref (context);
+  g_object_unref (fontmap);
+}
+
 /* https://bugzilla.gnome.org/show_bug.cgi?id=547303 */
 static void
 test_get_cursor_crash (void)
@@ -604,6 +706,66 @@ test_index_to_x (void)
   g_object_unref (fontmap);
 }
 
+/* Compare hit testing on lines with hit testing on their runs */
+static void
+test_line_hit_testing (void)
+{
+  PangoFontMap *fontmap;
+  PangoContext *context;
+  PangoLayout *layout;
+  PangoLayoutLine *line;
+  const char *text;
+  int x0;
+
+  fontmap = pango_cairo_font_map_new ();
+  context = pango_font_map_create_context (fontmap);
+  layout = pango_layout_new (context);
+  pango_layout_set_text (layout, "Hello world, שלום עולם and some more text. Oh, 123 שלום!", -1);
+  text = pango_layout_get_text (layout);
+  line = pango_layout_get_line_readonly (layout, 0);
+
+  x0 = 0;
+  for (GSList *l = line->runs; l; l = l->next)
+    {
+      PangoLayoutRun *run = l->data;
+      PangoItem *item = run->item;
+      int width = pango_glyph_string_get_width (run->glyphs);
+      const char *p;
+
+      for (int x = x0; x < x0 + width; x += PANGO_SCALE / 2)
+        {
+          int pos, index, trailing;
+          gboolean char_trailing;
+
+          pango_glyph_string_x_to_index (run->glyphs, text + item->offset, item->length,
+                                         &item->analysis, x - x0, &pos, &char_trailing);
+
+          g_assert_true (pango_layout_line_x_to_index (line, x, &index, &trailing));
+          g_assert_cmpint (index, ==, item->offset + pos);
+          g_assert_cmpint (trailing, ==, char_trailing ? 1 : 0);
+        }
+
+      for (p = text + item->offset; p < text + item->offset + item->length; p = g_utf8_next_char (p))
+        {
+          for (int trailing = 0; trailing < 2; trailing++)
+            {
+              int x, x2;
+
+              pango_glyph_string_index_to_x (run->glyphs, (char *) text + item->offset, item->length,
+                                             &item->analysis, p - (text + item->offset), trailing, &x);
+              pango_layout_line_index_to_x (line, p - text, trailing, &x2);
+              g_assert_cmpint (x0 + x, ==, x2);
+            }
+        }
+
+      x0 += width;
+    }
+
+  g_object_unref (layout);
+  g_object_unref (context);
+  g_object_unref (fontmap);
+}
+
 static gboolean
 pango_rectangle_contains (const PangoRectangle *r1,
                           const PangoRectangle *r2)
@@ -846,74 +1008,2012 @@ test_wrap_char (void)
   g_object_unref (fontmap);
 }
 
-/* Test the crash with Small Caps in itemization from #627 */
+/* Changing only the width reuses items and glyphs;
+ * check that we get the same lines as a fresh layout
+ */
 static void
-test_small_caps_crash (void)
+test_width_relayout (void)
 {
   PangoFontMap *fontmap;
   PangoContext *context;
   PangoLayout *layout;
-  PangoFontDescription *desc;
-  int w, h;
 
   fontmap = pango_cairo_font_map_new ();
-  if (strcmp (G_OBJECT_TYPE_NAME (fontmap), "PangoCairoCoreTextFontMap") == 0)
+  context = pango_font_map_create_context (fontmap);
+  layout = pango_layout_new (context);
+  pango_layout_set_markup (layout,
+                           "Some <b>bold text</b> and a verylongwordthatwillneedbreaking, "
+                           "\tsome tabs\tand שלום עולם in between.\n"
+                           "A second paragraph with <i>italic</i> words.", -1);
+  pango_layout_set_wrap (layout, PANGO_WRAP_WORD_CHAR);
+  pango_layout_get_size (layout, NULL, NULL);
+
+  for (int width = 20; width <= 400; width += 17)
     {
-      g_test_skip ("This test needs a fontmap that supports Small-Caps");
-      g_object_unref (fontmap);
-      return;
+      PangoLayout *fresh;
+      PangoRectangle ink, logical, ink2, logical2;
+      GSList *l, *l2;
+
+      pango_layout_set_width (layout, width * PANGO_SCALE);
+      fresh = pango_layout_copy (layout);
+
+      pango_layout_get_extents (layout, &ink, &logical);
+      pango_layout_get_extents (fresh, &ink2, &logical2);
+      g_assert_true (memcmp (&ink, &ink2, sizeof (PangoRectangle)) == 0);
+      g_assert_true (memcmp (&logical, &logical2, sizeof (PangoRectangle)) == 0);
+      g_assert_cmpint (pango_layout_get_line_count (layout), ==, pango_layout_get_line_count (fresh));
+
+      for (int i = 0; i < pango_layout_get_line_count (layout); i++)
+        {
+          PangoLayoutLine *line = pango_layout_get_line_readonly (layout, i);
+          PangoLayoutLine *line2 = pango_layout_get_line_readonly (fresh, i);
+
+          g_assert_cmpint (line->start_index, ==, line2->start_index);
+          g_assert_cmpint (line->length, ==, line2->length);
+
+          for (l = line->runs, l2 = line2->runs; l && l2; l = l->next, l2 = l2->next)
+            {
+              PangoGlyphItem *run = l->data;
+              PangoGlyphItem *run2 = l2->data;
+
+              g_assert_cmpint (run->item->offset, ==, run2->item->offset);
+              g_assert_cmpint (run->glyphs->num_glyphs, ==, run2->glyphs->num_glyphs);
+              g_assert_true (memcmp (run->glyphs->glyphs, run2->glyphs->glyphs,
+                                     run->glyphs->num_glyphs * sizeof (PangoGlyphInfo)) == 0);
+            }
+          g_assert_true (l == NULL && l2 == NULL);
+        }
+
+      g_object_unref (fresh);
     }
 
+  g_object_unref (layout);
+  g_object_unref (context);
+  g_object_unref (fontmap);
+}
+
+static void
+test_measure (void)
+{
+  PangoFontMap *fontmap;
+  PangoContext *context;
+  PangoLayout *layout;
+  const char *texts[] = {
+    "",
+    "Short",
+    "Some text that will need to wrap across a few lines",
+    "First paragraph\nשלום עולם and more\n\nLast one, after an empty line",
+    "A longer paragraph that wraps into many lines, so that the height "
+    "limit cuts it off somewhere in the middle and ellipsizes the last "
+    "line that still fits.\n\nAnd another one after it",
+  };
+  struct {
+    int width;
+    PangoWrapMode wrap;
+    PangoEllipsizeMode ellipsize;
+    PangoAlignment alignment;
+    float line_spacing;
+    int height;
+  } settings[] = {
+    { -1, PANGO_WRAP_WORD, PANGO_ELLIPSIZE_NONE, PANGO_ALIGN_LEFT, 0, -1 },
+    { 80, PANGO_WRAP_WORD, PANGO_ELLIPSIZE_NONE, PANGO_ALIGN_LEFT, 0, -1 },
+    { 80, PANGO_WRAP_CHAR, PANGO_ELLIPSIZE_NONE, PANGO_ALIGN_CENTER, 0, -1 },
+    { 80, PANGO_WRAP_WORD, PANGO_ELLIPSIZE_END, PANGO_ALIGN_RIGHT, 0, -1 },
+    { 120, PANGO_WRAP_WORD_CHAR, PANGO_ELLIPSIZE_NONE, PANGO_ALIGN_LEFT, 1.5, -1 },
+    { 80, PANGO_WRAP_WORD, PANGO_ELLIPSIZE_END, PANGO_ALIGN_LEFT, 0, -3 },
+    { 80, PANGO_WRAP_WORD, PANGO_ELLIPSIZE_MIDDLE, PANGO_ALIGN_LEFT, 0, 50 * PANGO_SCALE },
+  };
+
+  fontmap = pango_cairo_font_map_new ();
+  context = pango_font_map_create_context (fontmap);
+  layout = pango_layout_new (context);
+
+  for (int i = 0; i < G_N_ELEMENTS (texts); i++)
+    for (int j = 0; j < G_N_ELEMENTS (settings); j++)
+      {
+        int width, height, line_count, baseline;
+        int width2, height2;
+
+        pango_layout_set_text (layout, texts[i], -1);
+        pango_layout_set_width (layout, settings[j].width < 0 ? -1 : settings[j].width * PANGO_SCALE);
+        pango_layout_set_wrap (layout, settings[j].wrap);
+        pango_layout_set_ellipsize (layout, settings[j].ellipsize);
+        pango_layout_set_alignment (layout, settings[j].alignment);
+        pango_layout_set_line_spacing (layout, settings[j].line_spacing);
+        pango_layout_set_height (layout, settings[j].height);
+
+        pango_layout_measure (layout, &width, &height, &line_count, &baseline);
+
+        pango_layout_get_size (layout, &width2, &height2);
+        g_assert_cmpint (width, ==, width2);
+        g_assert_cmpint (height, ==, height2);
+        g_assert_cmpint (line_count, ==, pango_layout_get_line_count (layout));
+        g_assert_cmpint (baseline, ==, pango_layout_get_baseline (layout));
+
+        /* Now that there are lines, they are used */
+        pango_layout_measure (layout, &width, &height, &line_count, &baseline);
+        g_assert_cmpint (width, ==, width2);
+        g_assert_cmpint (height, ==, height2);
+        g_assert_cmpint (line_count, ==, pango_layout_get_line_count (layout));
+        g_assert_cmpint (baseline, ==, pango_layout_get_baseline (layout));
+      }
+
+  g_object_unref (layout);
+  g_object_unref (context);
+  g_object_unref (fontmap);
+}
+
+#ifdef HAVE_FREETYPE
+static void (* real_get_glyph_extents) (PangoFont      *font,
+                                        PangoGlyph      glyph,
+                                        PangoRectangle *ink_rect,
+                                        PangoRectangle *logical_rect);
+static int ink_extents_calls;
+
+static void
+counting_get_glyph_extents (PangoFont      *font,
+                            PangoGlyph      glyph,
+                            PangoRectangle *ink_rect,
+                            PangoRectangle *logical_rect)
+{
+  if (ink_rect)
+    ink_extents_calls++;
+
+  real_get_glyph_extents (font, glyph, ink_rect, logical_rect);
+}
+
+/* Check that asking for logical sizes never
+ * looks at the ink extents of glyphs
+ */
+static void
+test_size_without_ink (void)
+{
+  PangoFontMap *fontmap;
+  PangoContext *context;
+  PangoLayout *layout;
+  PangoFont *font;
+  PangoFontDescription *desc;
+  PangoFontClass *font_class;
+  PangoRectangle ink;
+  int width, height;
+
+  /* The ft2 fonts get extents one glyph at a time, so we can count them */
+  fontmap = pango_ft2_font_map_new ();
   context = pango_font_map_create_context (fontmap);
+  desc = pango_font_description_from_string ("Sans 11");
+  pango_context_set_font_description (context, desc);
+
+  font = pango_font_map_load_font (fontmap, context, desc);
+  font_class = PANGO_FONT_GET_CLASS (font);
+  real_get_glyph_extents = font_class->get_glyph_extents;
+  font_class->get_glyph_extents = counting_get_glyph_extents;
+  ink_extents_calls = 0;
+
   layout = pango_layout_new (context);
-  desc = pango_font_description_from_string ("Cantarell Small-Caps 11");
-  pango_layout_set_font_description (layout, desc);
+  pango_layout_set_markup (layout,
+                           "Some <u>underlined</u> and <s>struck</s> text\n"
+                           "that wraps over a few lines, <span rise='2000'>raised</span>", -1);
+  pango_layout_set_width (layout, 60 * PANGO_SCALE);
+  pango_layout_set_height (layout, 1000 * PANGO_SCALE);
 
-  pango_layout_set_text (layout, "Pere Ràfols Soler\nEqualiser, LV2\nAudio: 1, 1\nMidi: 0, 0\nControls: 53, 2\nCV: 0, 0", -1);
+  pango_layout_get_size (layout, &width, &height);
+  pango_layout_get_pixel_size (layout, &width, &height);
+  pango_layout_get_baseline (layout);
+  pango_layout_get_line_count (layout);
+  pango_layout_line_get_height (pango_layout_get_line_readonly (layout, 0), &height);
 
-  pango_layout_get_size (layout, &w, &h);
+  g_assert_cmpint (width, >, 0);
+  g_assert_cmpint (ink_extents_calls, ==, 0);
 
+  /* Make sure we are counting the right thing */
+  pango_layout_get_extents (layout, &ink, NULL);
+  g_assert_cmpint (ink_extents_calls, >, 0);
+
+  font_class->get_glyph_extents = real_get_glyph_extents;
+
+  g_object_unref (layout);
+  g_object_unref (font);
+  pango_font_description_free (desc);
+  g_object_unref (context);
+  g_object_unref (fontmap);
+}
+
+static void
+init_ft_bitmap (FT_Bitmap *bitmap,
+                int        width,
+                int        height)
+{
+  bitmap->width = width;
+  bitmap->rows = height;
+  bitmap->pitch = width;
+  bitmap->num_grays = 256;
+  bitmap->pixel_mode = ft_pixel_mode_grays;
+  bitmap->buffer = g_malloc0 (width * height);
+}
+
+/* Draw the quads the way the FT2 renderer draws glyphs,
+ * adding up coverage
+ */
+static void
+composite_quads (FT_Bitmap               *bitmap,
+                 const FT_Bitmap         *atlas,
+                 const PangoFT2AtlasQuad *quads,
+                 int                      n_quads)
+{
+  for (int i = 0; i < n_quads; i++)
+    {
+      const PangoFT2AtlasQuad *q = &quads[i];
+
+      for (int y = MAX (q->device.y, 0); y < MIN (q->device.y + q->device.height, (int) bitmap->rows); y++)
+        for (int x = MAX (q->device.x, 0); x < MIN (q->device.x + q->device.width, (int) bitmap->width); x++)
+          {
+            int ax = q->atlas.x + (x - q->device.x) * q->atlas.width / q->device.width;
+            int ay = q->atlas.y + (y - q->device.y) * q->atlas.height / q->device.height;
+            guchar *d = &bitmap->buffer[y * bitmap->pitch + x];
+
+            *d = MIN (*d + atlas->buffer[ay * atlas->pitch + ax], 0xff);
+          }
+    }
+}
+
+static void
+test_ft2_atlas (void)
+{
+  PangoFontMap *fontmap;
+  PangoContext *context;
+  PangoFontDescription *desc;
+  PangoLayout *layout;
+  PangoFT2Atlas *atlas;
+  PangoFT2AtlasQuad *quads;
+  int n_quads;
+  PangoRectangle damage;
+  const char *texts[] = {
+    "The quick brown fox",
+    "jumps over the lazy dog",
+    "THE QUICK BROWN FOX",
+    "JUMPS OVER THE LAZY DOG",
+    "0123456789 !?\u00e9\u00df\ue000",
+  };
+
+  fontmap = pango_ft2_font_map_new ();
+  context = pango_font_map_create_context (fontmap);
+  desc = pango_font_description_from_string ("Sans 14");
+  pango_context_set_font_description (context, desc);
   pango_font_description_free (desc);
+  layout = pango_layout_new (context);
+
+  /* Small enough that later texts evict the glyphs of earlier ones */
+  atlas = pango_ft2_atlas_new (256, 64, 1);
+
+  g_assert_true (pango_ft2_atlas_get_damage (atlas, &damage));
+  g_assert_false (pango_ft2_atlas_get_damage (atlas, &damage));
+
+  for (int pass = 0; pass < 2; pass++)
+    for (int i = 0; i < G_N_ELEMENTS (texts); i++)
+      {
+        FT_Bitmap expected, composited;
+
+        pango_layout_set_text (layout, texts[i], -1);
+
+        init_ft_bitmap (&expected, 300, 40);
+        init_ft_bitmap (&composited, 300, 40);
+
+        pango_ft2_render_layout (&expected, layout, 3, 2);
+
+        quads = pango_ft2_atlas_render_layout (atlas, layout, 3, 2, &n_quads);
+        g_assert_cmpint (n_quads, >, 0);
+        composite_quads (&composited, pango_ft2_atlas_get_bitmap (atlas), quads, n_quads);
+
+        g_assert_true (memcmp (expected.buffer, composited.buffer, 300 * 40) == 0);
+
+        g_free (quads);
+        g_free (expected.buffer);
+        g_free (composited.buffer);
+      }
+
+  /* Glyphs that are in the atlas already don't change it */
+  pango_ft2_atlas_get_damage (atlas, &damage);
+  quads = pango_ft2_atlas_render_layout (atlas, layout, 0, 0, &n_quads);
+  g_assert_false (pango_ft2_atlas_get_damage (atlas, &damage));
+  g_free (quads);
+
+  pango_ft2_atlas_unref (atlas);
+
+  /* With positions at fractions of a pixel, glyphs still end up
+   * near where they would be otherwise
+   */
+  atlas = pango_ft2_atlas_new (512, 512, 4);
+  pango_layout_set_text (layout, "iiiiiiii", -1);
+  quads = pango_ft2_atlas_render_layout (atlas, layout, 0, 0, &n_quads);
+  g_assert_cmpint (n_quads, ==, 8);
+  for (int i = 1; i < n_quads; i++)
+    g_assert_cmpint (quads[i].device.x, >, quads[i - 1].device.x);
+  g_free (quads);
+  pango_ft2_atlas_unref (atlas);
+
   g_object_unref (layout);
   g_object_unref (context);
   g_object_unref (fontmap);
 }
 
-int
-main (int argc, char *argv[])
+static double
+row_center (const FT_Bitmap *bitmap,
+            int              y,
+            guint64         *total)
 {
-  g_test_init (&argc, &argv, NULL);
+  guint64 sum = 0, weighted = 0;
 
-  g_test_add_func ("/layout/shape-tab-crash", test_shape_tab_crash);
-  g_test_add_func ("/layout/itemize-empty-crash", test_itemize_empty_crash);
-  g_test_add_func ("/layout/itemize-utf8", test_itemize_utf8);
-  g_test_add_func ("/layout/short-string-crash", test_short_string_crash);
-  g_test_add_func ("/language/emoji-crash", test_language_emoji_crash);
-  g_test_add_func ("/layout/line-height", test_line_height);
-  g_test_add_func ("/layout/line-height2", test_line_height2);
-  g_test_add_func ("/layout/line-height3", test_line_height3);
-  g_test_add_func ("/layout/run-height", test_run_height);
-  g_test_add_func ("/layout/cursor-height", test_cursor_height);
-  g_test_add_func ("/layout/cursor-height2", test_cursor_height2);
-  g_test_add_func ("/attr-list/update", test_attr_list_update);
-  g_test_add_func ("/misc/version-info", test_version_info);
-  g_test_add_func ("/misc/is-zerowidth", test_is_zero_width);
-  g_test_add_func ("/gravity/to-rotation", test_gravity_to_rotation);
-  g_test_add_func ("/gravity/from-matrix", test_gravity_from_matrix);
-  g_test_add_func ("/gravity/for-script", test_gravity_for_script);
-  g_test_add_func ("/layout/fallback-shape", test_fallback_shape);
-#ifdef HAVE_CAIRO_FREETYPE
-  g_test_add_func ("/language/to-tag", test_language_to_tag);
-#endif
-  g_test_add_func ("/bidi/get-cursor-crash", test_get_cursor_crash);
-  g_test_add_func ("/bidi/get-cursor", test_get_cursor);
-  g_test_add_func ("/layout/index-to-x", test_index_to_x);
-  g_test_add_func ("/layout/extents", test_extents);
-  g_test_add_func ("/layout/empty-line-height", test_empty_line_height);
-  g_test_add_func ("/layout/gravity-metrics", test_gravity_metrics);
-  g_test_add_func ("/layout/wrap-char", test_wrap_char);
-  g_test_add_func ("/matrix/transform-rectangle", test_transform_rectangle);
-  g_test_add_func ("/itemize/small-caps-crash", test_small_caps_crash);
+  for (int x = 0; x < (int) bitmap->width; x++)
+    {
+      guchar c = bitmap->buffer[y * bitmap->pitch + x];
+
+      sum += c;
+      weighted += (guint64) c * x;
+    }
+
+  *total = sum;
+
+  return sum ? (double) weighted / sum : 0;
+}
+
+static void
+render_slanted (PangoFontMap  *fontmap,
+                const char    *text,
+                FT_Bitmap     *bitmap,
+                PangoFT2Atlas *atlas)
+{
+  PangoContext *context;
+  PangoFontDescription *desc;
+  PangoLayout *layout;
+  PangoMatrix matrix = PANGO_MATRIX_INIT;
+
+  /* The matrix ends up as FC_MATRIX on the font pattern */
+  matrix.xy = 0.4;
+
+  context = pango_font_map_create_context (fontmap);
+  pango_context_set_matrix (context, &matrix);
+  desc = pango_font_description_from_string ("Sans 20");
+  pango_context_set_font_description (context, desc);
+  pango_font_description_free (desc);
+  layout = pango_layout_new (context);
+  pango_layout_set_text (layout, text, -1);
+
+  if (atlas)
+    {
+      PangoFT2AtlasQuad *quads;
+      int n_quads;
+
+      quads = pango_ft2_atlas_render_layout (atlas, layout, 5, 2, &n_quads);
+      g_assert_cmpint (n_quads, >, 0);
+      composite_quads (bitmap, pango_ft2_atlas_get_bitmap (atlas), quads, n_quads);
+      g_free (quads);
+    }
+  else
+    pango_ft2_render_layout (bitmap, layout, 5, 2);
+
+  g_object_unref (layout);
+  g_object_unref (context);
+}
+
+/* Glyphs drawn at subpixel offsets keep the font matrix,
+ * and so does the face afterwards
+ */
+static void
+test_ft2_atlas_matrix (void)
+{
+  PangoFontMap *fontmap;
+  PangoFT2Atlas *atlas;
+  FT_Bitmap expected, composited, after;
+  int rows = 0;
+
+  /* Separate font maps, so that no glyphs are cached on
+   * the fonts before the atlas draws them
+   */
+  fontmap = pango_ft2_font_map_new ();
+  init_ft_bitmap (&expected, 300, 50);
+  render_slanted (fontmap, "I I I I I I I", &expected, NULL);
+  g_object_unref (fontmap);
+
+  fontmap = pango_ft2_font_map_new ();
+  atlas = pango_ft2_atlas_new (512, 512, 64);
+  init_ft_bitmap (&composited, 300, 50);
+  render_slanted (fontmap, "I I I I I I I", &composited, atlas);
+  init_ft_bitmap (&after, 300, 50);
+  render_slanted (fontmap, "I I I I I I I", &after, NULL);
+  pango_ft2_atlas_unref (atlas);
+  g_object_unref (fontmap);
+
+  g_assert_true (memcmp (expected.buffer, after.buffer, 300 * 50) == 0);
+
+  /* Subpixel positions move the glyphs by less than a pixel,
+   * while dropping the slant would move the top rows by several
+   */
+  for (int y = 0; y < 50; y++)
+    {
+      guint64 expected_total, composited_total;
+      double expected_center, composited_center;
+
+      expected_center = row_center (&expected, y, &expected_total);
+      composited_center = row_center (&composited, y, &composited_total);
+
+      if (expected_total < 0xff * 4 || composited_total < 0xff * 4)
+        continue;
+
+      g_assert_cmpfloat_with_epsilon (expected_center, composited_center, 1.0);
+      rows++;
+    }
+
+  g_assert_cmpint (rows, >, 10);
+
+  g_free (expected.buffer);
+  g_free (composited.buffer);
+  g_free (after.buffer);
+}
+
+static guint64
+bitmap_coverage (const FT_Bitmap *bitmap)
+{
+  guint64 sum = 0;
+
+  for (int i = 0; i < (int) (bitmap->rows * bitmap->pitch); i++)
+    sum += bitmap->buffer[i];
+
+  return sum;
+}
+
+/* An underline covers the same area, wherever it is put. A shear
+ * turns it into a slanted parallelogram with the same area, drawn
+ * as trapezoids
+ */
+static void
+test_ft2_decorations (void)
+{
+  PangoFontMap *fontmap;
+  PangoContext *context;
+  PangoFontDescription *desc;
+  PangoLayout *layout;
+  PangoMatrix matrices[2] = { PANGO_MATRIX_INIT, PANGO_MATRIX_INIT };
+
+  matrices[1].xy = 0.5;
+
+  fontmap = pango_ft2_font_map_new ();
+  context = pango_font_map_create_context (fontmap);
+  desc = pango_font_description_from_string ("Sans 14");
+  pango_context_set_font_description (context, desc);
+
+  /* Spaces have no ink, so only the underline is drawn */
+  layout = pango_layout_new (context);
+  pango_layout_set_markup (layout, "<u>        </u>", -1);
+
+  for (int m = 0; m < G_N_ELEMENTS (matrices); m++)
+    {
+      PangoFontMetrics *metrics;
+      PangoRectangle logical;
+      double expected;
+
+      pango_context_set_matrix (context, &matrices[m]);
+      pango_layout_context_changed (layout);
+
+      metrics = pango_context_get_metrics (context, desc, NULL);
+      pango_layout_get_extents (layout, NULL, &logical);
+
+      expected = (double) logical.width * pango_font_metrics_get_underline_thickness (metrics) / (PANGO_SCALE * PANGO_SCALE);
+      g_assert_cmpfloat (expected, >, 0);
+
+      for (int i = 0; i < 4; i++)
+        {
+          FT_Bitmap bitmap;
+          double area;
+
+          init_ft_bitmap (&bitmap, 200, 40);
+          pango_ft2_render_layout_subpixel (&bitmap, layout,
+                                            3 * PANGO_SCALE + i * PANGO_SCALE / 4,
+                                            2 * PANGO_SCALE + i * PANGO_SCALE / 3);
+
+          area = bitmap_coverage (&bitmap) / 255.;
+          g_assert_cmpfloat_with_epsilon (area, expected, expected * 0.05);
+
+          g_free (bitmap.buffer);
+        }
+
+      pango_font_metrics_unref (metrics);
+    }
+
+  pango_font_description_free (desc);
+  g_object_unref (layout);
+  g_object_unref (context);
+  g_object_unref (fontmap);
+}
+
+static void
+test_ft2_decorations_perf (void)
+{
+  PangoFontMap *fontmap;
+  PangoContext *context;
+  PangoLayout *layout;
+  PangoAttrList *attrs;
+  FT_Bitmap bitmap;
+  char *filename;
+  char *contents;
+  gsize length;
+  GError *error = NULL;
+  int width, height;
+  double elapsed;
+
+  filename = g_test_build_filename (G_TEST_DIST, "..", "utils", "test-mixed.markup", NULL);
+  g_file_get_contents (filename, &contents, &length, &error);
+  g_assert_no_error (error);
+
+  fontmap = pango_ft2_font_map_new ();
+  context = pango_font_map_create_context (fontmap);
+  layout = pango_layout_new (context);
+  pango_layout_set_markup (layout, contents, length);
+
+  attrs = pango_attr_list_copy (pango_layout_get_attributes (layout));
+  if (!attrs)
+    attrs = pango_attr_list_new ();
+  pango_attr_list_insert (attrs, pango_attr_underline_new (PANGO_UNDERLINE_ERROR));
+  pango_attr_list_insert (attrs, pango_attr_strikethrough_new (TRUE));
+  pango_attr_list_insert (attrs, pango_attr_overline_new (PANGO_OVERLINE_SINGLE));
+  pango_layout_set_attributes (layout, attrs);
+  pango_attr_list_unref (attrs);
+
+  pango_layout_get_pixel_size (layout, &width, &height);
+  init_ft_bitmap (&bitmap, width, height);
+
+  g_test_timer_start ();
+  for (int i = 0; i < 200; i++)
+    pango_ft2_render_layout (&bitmap, layout, 0, 0);
+  elapsed = g_test_timer_elapsed ();
+
+  g_test_minimized_result (elapsed, "200 draws of test-mixed.markup with decorations: %f s", elapsed);
+
+  g_free (bitmap.buffer);
+  g_object_unref (layout);
+  g_object_unref (context);
+  g_object_unref (fontmap);
+  g_free (contents);
+  g_free (filename);
+}
+#endif
+
+/* Iterators share the line extents of the layout, check
+ * that they keep working while the layout changes under them
+ */
+static void
+test_iter_line_extents (void)
+{
+  PangoFontMap *fontmap;
+  PangoContext *context;
+  PangoLayout *layout;
+  PangoLayoutIter *iter, *copy;
+  PangoRectangle logical, logical2;
+  int baseline;
+
+  fontmap = pango_cairo_font_map_new ();
+  context = pango_font_map_create_context (fontmap);
+  layout = pango_layout_new (context);
+  pango_layout_set_text (layout, "one\ntwo\nthree", -1);
+  pango_layout_set_alignment (layout, PANGO_ALIGN_RIGHT);
+
+  iter = pango_layout_get_iter (layout);
+  g_assert_true (pango_layout_iter_next_line (iter));
+  pango_layout_iter_get_line_extents (iter, NULL, &logical);
+  baseline = pango_layout_iter_get_baseline (iter);
+
+  copy = pango_layout_iter_copy (iter);
+  pango_layout_iter_get_line_extents (copy, NULL, &logical2);
+  g_assert_true (memcmp (&logical, &logical2, sizeof (PangoRectangle)) == 0);
+  g_assert_cmpint (pango_layout_iter_get_baseline (copy), ==, baseline);
+  pango_layout_iter_free (copy);
+
+  pango_layout_iter_free (iter);
+
+  /* A second iterator sees the same lines */
+  iter = pango_layout_get_iter (layout);
+  g_assert_cmpint (pango_layout_iter_get_baseline (iter), ==, pango_layout_get_baseline (layout));
+  g_assert_true (pango_layout_iter_next_line (iter));
+  pango_layout_iter_get_line_extents (iter, NULL, &logical2);
+  g_assert_true (memcmp (&logical, &logical2, sizeof (PangoRectangle)) == 0);
+  g_assert_cmpint (pango_layout_iter_get_baseline (iter), ==, baseline);
+
+  /* Changing the layout must not pull the extents out
+   * from under an existing iterator
+   */
+  pango_layout_set_text (layout, "a much longer line", -1);
+  pango_layout_iter_get_line_extents (iter, NULL, &logical2);
+  g_assert_true (memcmp (&logical, &logical2, sizeof (PangoRectangle)) == 0);
+  pango_layout_iter_free (iter);
+
+  iter = pango_layout_get_iter (layout);
+  g_assert_false (pango_layout_iter_next_line (iter));
+  pango_layout_iter_get_line_extents (iter, NULL, &logical2);
+  g_assert_cmpint (logical2.x, ==, 0);
+  pango_layout_iter_free (iter);
+
+  g_object_unref (layout);
+  g_object_unref (context);
+  g_object_unref (fontmap);
+}
+
+static cairo_surface_t *
+draw_scrolled_layout (PangoLayout *layout,
+                      int          scroll_x,
+                      int          scroll_y,
+                      gboolean     clipped)
+{
+  cairo_surface_t *surface;
+  cairo_t *cr;
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 200, 100);
+  cr = cairo_create (surface);
+
+  if (clipped)
+    {
+      cairo_move_to (cr, - scroll_x, - scroll_y);
+      pango_cairo_show_layout (cr, layout);
+    }
+  else
+    {
+      cairo_surface_t *recording;
+      cairo_t *cr2;
+
+      /* Recording surfaces are unbounded, so everything gets drawn */
+      recording = cairo_recording_surface_create (CAIRO_CONTENT_COLOR_ALPHA, NULL);
+      cr2 = cairo_create (recording);
+      pango_cairo_show_layout (cr2, layout);
+      cairo_destroy (cr2);
+
+      cairo_set_source_surface (cr, recording, - scroll_x, - scroll_y);
+      cairo_paint (cr);
+      cairo_surface_destroy (recording);
+    }
+
+  cairo_destroy (cr);
+
+  return surface;
+}
+
+/* Drawing into a small surface skips most of a long layout,
+ * check that this doesn't change what ends up in the surface
+ */
+static void
+test_clipped_draw (void)
+{
+  PangoFontMap *fontmap;
+  PangoContext *context;
+  PangoLayout *layout;
+  PangoAttrList *attrs;
+  GString *str;
+  int scroll[][2] = { { 0, 0 }, { 0, 1234 }, { 150, 2000 }, { 0, 100000 } };
+
+  str = g_string_new ("");
+  for (int i = 0; i < 300; i++)
+    g_string_append_printf (str, "Line %d: the quick brown fox jumps over the lazy dog\n", i);
+
+  attrs = pango_attr_list_from_string ("0 -1 underline single, 0 -1 background red, 100 300 rise 3000, 500 520 size 40000");
+
+  fontmap = pango_cairo_font_map_new ();
+  context = pango_font_map_create_context (fontmap);
+  layout = pango_layout_new (context);
+  pango_layout_set_text (layout, str->str, str->len);
+  pango_layout_set_attributes (layout, attrs);
+
+  for (int i = 0; i < G_N_ELEMENTS (scroll); i++)
+    {
+      cairo_surface_t *full, *clipped;
+      int stride;
+
+      full = draw_scrolled_layout (layout, scroll[i][0], scroll[i][1], FALSE);
+      clipped = draw_scrolled_layout (layout, scroll[i][0], scroll[i][1], TRUE);
+
+      cairo_surface_flush (full);
+      cairo_surface_flush (clipped);
+      stride = cairo_image_surface_get_stride (full);
+
+      g_assert_true (memcmp (cairo_image_surface_get_data (full),
+                             cairo_image_surface_get_data (clipped),
+                             stride * 100) == 0);
+
+      cairo_surface_destroy (full);
+      cairo_surface_destroy (clipped);
+    }
+
+  pango_attr_list_unref (attrs);
+  g_string_free (str, TRUE);
+  g_object_unref (layout);
+  g_object_unref (context);
+  g_object_unref (fontmap);
+}
+
+static void
+test_render_list (void)
+{
+  PangoFontMap *fontmap;
+  PangoContext *context;
+  PangoLayout *layout;
+  PangoAttrList *attrs;
+  PangoRenderList *list;
+  cairo_surface_t *direct, *replayed;
+  cairo_t *cr;
+
+  fontmap = pango_cairo_font_map_new ();
+  context = pango_font_map_create_context (fontmap);
+  layout = pango_layout_new (context);
+  pango_layout_set_text (layout, "Some underlined\nand struck through, wrongly spelt text", -1);
+  attrs = pango_attr_list_from_string ("0 15 underline double, 0 15 foreground blue, "
+                                       "20 34 strikethrough true, 20 34 background #ff000080, "
+                                       "36 50 underline error, 45 50 underline-color green");
+  pango_layout_set_attributes (layout, attrs);
+  pango_attr_list_unref (attrs);
+
+  list = pango_render_list_new (layout);
+  g_assert_true (pango_render_list_is_current (list, layout));
+
+  direct = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 300, 100);
+  cr = cairo_create (direct);
+  cairo_move_to (cr, 10, 20);
+  pango_cairo_show_layout (cr, layout);
+  cairo_destroy (cr);
+
+  replayed = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 300, 100);
+  cr = cairo_create (replayed);
+  cairo_move_to (cr, 10, 20);
+  pango_cairo_show_render_list (cr, list);
+  cairo_destroy (cr);
+
+  cairo_surface_flush (direct);
+  cairo_surface_flush (replayed);
+  g_assert_true (memcmp (cairo_image_surface_get_data (direct),
+                         cairo_image_surface_get_data (replayed),
+                         cairo_image_surface_get_stride (direct) * 100) == 0);
+
+  /* The list doesn't follow changes to the layout */
+  pango_layout_set_text (layout, "Something else", -1);
+  g_assert_false (pango_render_list_is_current (list, layout));
+
+  cr = cairo_create (replayed);
+  cairo_move_to (cr, 10, 20);
+  pango_cairo_show_render_list (cr, list);
+  cairo_destroy (cr);
+
+  pango_render_list_unref (list);
+  cairo_surface_destroy (direct);
+  cairo_surface_destroy (replayed);
+
+  list = pango_render_list_new (layout);
+  g_object_unref (layout);
+
+  /* ... and outlives it */
+  layout = pango_layout_new (context);
+  g_assert_false (pango_render_list_is_current (list, layout));
+  pango_render_list_unref (list);
+
+  g_object_unref (layout);
+  g_object_unref (context);
+  g_object_unref (fontmap);
+}
+
+static cairo_surface_t *
+draw_layout_in_red (PangoLayout          *layout,
+                    const cairo_matrix_t *ctm,
+                    gboolean              as_path)
+{
+  cairo_surface_t *surface;
+  cairo_t *cr;
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 300, 100);
+  cr = cairo_create (surface);
+  cairo_transform (cr, ctm);
+  cairo_set_source_rgb (cr, 1, 0, 0);
+  cairo_move_to (cr, 10.5, 20.25);
+  if (as_path)
+    {
+      /* Paths don't go through the hex box cache */
+      pango_cairo_layout_path (cr, layout);
+      cairo_fill (cr);
+    }
+  else
+    pango_cairo_show_layout (cr, layout);
+  cairo_destroy (cr);
+  cairo_surface_flush (surface);
+
+  return surface;
+}
+
+/* Adds up the alpha of @surface and finds the pixels that have any */
+static guint64
+get_red_ink (cairo_surface_t *surface,
+             PangoRectangle  *ink)
+{
+  const guint32 *pixels = (const guint32 *) cairo_image_surface_get_data (surface);
+  int stride = cairo_image_surface_get_stride (surface) / 4;
+  int x1 = G_MAXINT, y1 = G_MAXINT, x2 = -1, y2 = -1;
+  guint64 sum = 0;
+
+  for (int y = 0; y < cairo_image_surface_get_height (surface); y++)
+    for (int x = 0; x < cairo_image_surface_get_width (surface); x++)
+      {
+        guint32 pixel = pixels[y * stride + x];
+
+        if (pixel == 0)
+          continue;
+
+        /* Only ever drawn in red */
+        g_assert_cmphex (pixel & 0xffff, ==, 0);
+
+        sum += pixel >> 24;
+        x1 = MIN (x1, x);
+        y1 = MIN (y1, y);
+        x2 = MAX (x2, x + 1);
+        y2 = MAX (y2, y + 1);
+      }
+
+  ink->x = x1;
+  ink->y = y1;
+  ink->width = x2 - x1;
+  ink->height = y2 - y1;
+
+  return sum;
+}
+
+/* Hex boxes for missing glyphs are drawn from a cache. Check
+ * that they come out the same every time, in the current color,
+ * and like the boxes drawn without the cache, at fractional
+ * positions and under transformations
+ */
+static void
+test_hex_boxes (void)
+{
+  PangoFontMap *fontmap;
+  PangoContext *context;
+  PangoLayout *layout;
+  cairo_font_options_t *options;
+  cairo_matrix_t ctms[2];
+
+  cairo_matrix_init_identity (&ctms[0]);
+  cairo_matrix_init (&ctms[1], 1.5, 0, 0.2, 1.25, 0.3, 0.6);
+
+  fontmap = pango_cairo_font_map_new ();
+  context = pango_font_map_create_context (fontmap);
+
+  /* Without hinting, glyphs look the same as paths */
+  options = cairo_font_options_create ();
+  cairo_font_options_set_hint_style (options, CAIRO_HINT_STYLE_NONE);
+  cairo_font_options_set_hint_metrics (options, CAIRO_HINT_METRICS_OFF);
+  pango_cairo_context_set_font_options (context, options);
+  cairo_font_options_destroy (options);
+
+  layout = pango_layout_new (context);
+  pango_layout_set_text (layout, "\ue000\ue001\ue000 \U0010fffd\ue000\ue001", -1);
+
+  for (int i = 0; i < G_N_ELEMENTS (ctms); i++)
+    {
+      cairo_surface_t *first, *second, *path;
+      PangoRectangle ink, path_ink;
+      guint64 coverage, path_coverage;
+
+      first = draw_layout_in_red (layout, &ctms[i], FALSE);
+      second = draw_layout_in_red (layout, &ctms[i], FALSE);
+      path = draw_layout_in_red (layout, &ctms[i], TRUE);
+
+      g_assert_true (memcmp (cairo_image_surface_get_data (first),
+                             cairo_image_surface_get_data (second),
+                             cairo_image_surface_get_stride (first) * 100) == 0);
+
+      coverage = get_red_ink (first, &ink);
+      path_coverage = get_red_ink (path, &path_ink);
+
+      g_assert_cmpuint (coverage, >, 0);
+      g_assert_cmpfloat_with_epsilon ((double) coverage, (double) path_coverage, path_coverage * 0.05);
+      g_assert_cmpint (ABS (ink.x - path_ink.x), <=, 1);
+      g_assert_cmpint (ABS (ink.y - path_ink.y), <=, 1);
+      g_assert_cmpint (ABS (ink.width - path_ink.width), <=, 2);
+      g_assert_cmpint (ABS (ink.height - path_ink.height), <=, 2);
+
+      cairo_surface_destroy (first);
+      cairo_surface_destroy (second);
+      cairo_surface_destroy (path);
+    }
+
+  g_object_unref (layout);
+  g_object_unref (context);
+  g_object_unref (fontmap);
+}
+
+static void
+count_shapes (cairo_t        *cr,
+              PangoAttrShape *attr,
+              gboolean        do_path,
+              gpointer        data)
+{
+  int *count = data;
+
+  (*count)++;
+}
+
+/* Shapes are drawn by looking at the layout, which may
+ * have changed since the list was recorded
+ */
+static void
+test_render_list_shape (void)
+{
+  PangoFontMap *fontmap;
+  PangoContext *context;
+  PangoLayout *layout;
+  PangoAttrList *attrs;
+  PangoAttribute *attr;
+  PangoRectangle rect = { 0, -10 * PANGO_SCALE, 10 * PANGO_SCALE, 10 * PANGO_SCALE };
+  PangoRenderList *list;
+  cairo_surface_t *surface;
+  cairo_t *cr;
+  int count = 0;
+
+  fontmap = pango_cairo_font_map_new ();
+  context = pango_font_map_create_context (fontmap);
+  pango_cairo_context_set_shape_renderer (context, count_shapes, &count, NULL);
+
+  layout = pango_layout_new (context);
+  pango_layout_set_text (layout, "a\xef\xbf\xbc" "b", -1);
+  attrs = pango_attr_list_new ();
+  attr = pango_attr_shape_new (&rect, &rect);
+  attr->start_index = 1;
+  attr->end_index = 4;
+  pango_attr_list_insert (attrs, attr);
+  pango_layout_set_attributes (layout, attrs);
+  pango_attr_list_unref (attrs);
+
+  list = pango_render_list_new (layout);
+
+  pango_layout_set_text (layout, "no shapes", -1);
+  pango_layout_set_attributes (layout, NULL);
+  g_assert_false (pango_render_list_is_current (list, layout));
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 100, 50);
+  cr = cairo_create (surface);
+  pango_cairo_show_render_list (cr, list);
+  g_assert_cmpint (count, ==, 1);
+
+  /* ... even once it is gone */
+  g_object_unref (layout);
+  pango_cairo_show_render_list (cr, list);
+  g_assert_cmpint (count, ==, 2);
+
+  cairo_destroy (cr);
+  cairo_surface_destroy (surface);
+  pango_render_list_unref (list);
+  g_object_unref (context);
+  g_object_unref (fontmap);
+}
+
+/* Test the crash with Small Caps in itemization from #627 */
+static void
+test_small_caps_crash (void)
+{
+  PangoFontMap *fontmap;
+  PangoContext *context;
+  PangoLayout *layout;
+  PangoFontDescription *desc;
+  int w, h;
+
+  fontmap = pango_cairo_font_map_new ();
+  if (strcmp (G_OBJECT_TYPE_NAME (fontmap), "PangoCairoCoreTextFontMap") == 0)
+    {
+      g_test_skip ("This test needs a fontmap that supports Small-Caps");
+      g_object_unref (fontmap);
+      return;
+    }
+
+  context = pango_font_map_create_context (fontmap);
+  layout = pango_layout_new (context);
+  desc = pango_font_description_from_string ("Cantarell Small-Caps 11");
+  pango_layout_set_font_description (layout, desc);
+
+  pango_layout_set_text (layout, "Pere Ràfols Soler\nEqualiser, LV2\nAudio: 1, 1\nMidi: 0, 0\nControls: 53, 2\nCV: 0, 0", -1);
+
+  pango_layout_get_size (layout, &w, &h);
+
+  pango_font_description_free (desc);
+  g_object_unref (layout);
+  g_object_unref (context);
+  g_object_unref (fontmap);
+}
+
+static void
+test_merge_shaping (void)
+{
+  PangoFontMap *fontmap;
+  PangoContext *context;
+  PangoLayout *layout;
+  PangoLayoutLine *line;
+  GSList *runs, *l, *m;
+  int n_runs;
+  const char *markup = "int <span rise='1024'>main</span> (<span rise='1024'>void</span>) { return 0; }";
+
+  fontmap = pango_cairo_font_map_new ();
+  context = pango_font_map_create_context (fontmap);
+  g_assert_false (pango_context_get_merge_shaping (context));
+
+  layout = pango_layout_new (context);
+  pango_layout_set_markup (layout, markup, -1);
+
+  line = pango_layout_get_line_readonly (layout, 0);
+  runs = g_slist_copy_deep (line->runs, (GCopyFunc) pango_glyph_item_copy, NULL);
+  n_runs = g_slist_length (runs);
+  g_assert_cmpint (n_runs, >, 1);
+
+  pango_context_set_merge_shaping (context, TRUE);
+  g_assert_true (pango_context_get_merge_shaping (context));
+  pango_layout_context_changed (layout);
+
+  line = pango_layout_get_line_readonly (layout, 0);
+  g_assert_cmpint (g_slist_length (line->runs), ==, n_runs);
+
+  /* The glyphs and clusters must not change, only their positions may */
+  for (l = runs, m = line->runs; l; l = l->next, m = m->next)
+    {
+      PangoGlyphItem *run1 = l->data;
+      PangoGlyphItem *run2 = m->data;
+
+      g_assert_cmpint (run1->item->offset, ==, run2->item->offset);
+      g_assert_cmpint (run1->item->length, ==, run2->item->length);
+      g_assert_cmpint (run1->glyphs->num_glyphs, ==, run2->glyphs->num_glyphs);
+
+      for (int i = 0; i < run1->glyphs->num_glyphs; i++)
+        {
+          g_assert_cmpuint (run1->glyphs->glyphs[i].glyph, ==, run2->glyphs->glyphs[i].glyph);
+          g_assert_cmpint (run1->glyphs->log_clusters[i], ==, run2->glyphs->log_clusters[i]);
+        }
+    }
+
+  g_slist_free_full (runs, (GDestroyNotify) pango_glyph_item_free);
+  g_object_unref (layout);
+  g_object_unref (context);
+  g_object_unref (fontmap);
+}
+
+static void
+check_subpixel_positions (PangoLayout *layout,
+                          int          quantum)
+{
+  PangoLayoutIter *iter;
+
+  iter = pango_layout_get_iter (layout);
+  do
+    {
+      PangoLayoutRun *run = pango_layout_iter_get_run_readonly (iter);
+
+      if (!run)
+        continue;
+
+      for (int i = 0; i < run->glyphs->num_glyphs; i++)
+        {
+          PangoGlyphGeometry *geometry = &run->glyphs->glyphs[i].geometry;
+
+          g_assert_cmpint (geometry->width % quantum, ==, 0);
+          g_assert_cmpint (geometry->x_offset % quantum, ==, 0);
+          g_assert_cmpint (geometry->y_offset % quantum, ==, 0);
+        }
+    }
+  while (pango_layout_iter_next_run (iter));
+  pango_layout_iter_free (iter);
+}
+
+static void
+test_subpixel_positions (void)
+{
+  PangoFontMap *fontmap;
+  PangoContext *context;
+  PangoLayout *layout;
+  PangoMatrix matrix = PANGO_MATRIX_INIT;
+
+  fontmap = pango_cairo_font_map_new ();
+  context = pango_font_map_create_context (fontmap);
+  g_assert_cmpint (pango_context_get_subpixel_positions (context), ==, 0);
+
+  pango_context_set_round_glyph_positions (context, FALSE);
+  pango_context_set_subpixel_positions (context, 4);
+  g_assert_cmpint (pango_context_get_subpixel_positions (context), ==, 4);
+
+  layout = pango_layout_new (context);
+  pango_layout_set_markup (layout,
+                           "<span letter_spacing='300'>Quantized glyph positions</span> "
+                           "keep glyph caches small, even when justified.", -1);
+  pango_layout_set_width (layout, 130 * PANGO_SCALE + 77);
+  pango_layout_set_justify (layout, TRUE);
+
+  check_subpixel_positions (layout, PANGO_SCALE / 4);
+
+  /* Positions are quantized in device units, letter spacing
+   * and justification included
+   */
+  pango_matrix_scale (&matrix, 0.5, 0.5);
+  pango_context_set_matrix (context, &matrix);
+  pango_layout_context_changed (layout);
+
+  check_subpixel_positions (layout, 2 * PANGO_SCALE / 4);
+
+  g_object_unref (layout);
+  g_object_unref (context);
+  g_object_unref (fontmap);
+}
+
+static void
+test_coalesce_itemize_attrs (void)
+{
+  PangoFontMap *fontmap;
+  PangoContext *context;
+  PangoLayout *layout;
+  PangoLayoutLine *line;
+
+  fontmap = pango_cairo_font_map_new ();
+  context = pango_font_map_create_context (fontmap);
+  layout = pango_layout_new (context);
+
+  /* Adjacent spans with equal font attributes, and color
+   * changes, should not split items
+   */
+  pango_layout_set_markup (layout,
+                           "<b>int</b><b> </b><b><span foreground='red'>main</span></b>"
+                           "<span foreground='blue'><b>()</b></span>", -1);
+
+  line = pango_layout_get_line_readonly (layout, 0);
+  g_assert_cmpint (g_slist_length (line->runs), ==, 3);
+
+  g_object_unref (layout);
+  g_object_unref (context);
+  g_object_unref (fontmap);
+}
+
+static void
+test_lazy_sentence_attrs (void)
+{
+  PangoFontMap *fontmap;
+  PangoContext *context;
+  PangoLayout *layout;
+  const PangoLogAttr *attrs;
+  PangoLogAttr *expected;
+  const char *text = "Hello there. How are you? Fine, thanks.";
+  int n_attrs;
+  int n_sentences = 0;
+
+  fontmap = pango_cairo_font_map_new ();
+  context = pango_font_map_create_context (fontmap);
+  layout = pango_layout_new (context);
+  pango_layout_set_text (layout, text, -1);
+  pango_layout_set_width (layout, 50 * PANGO_SCALE);
+
+  /* Lay out first, so the sentence attrs get filled in lazily */
+  pango_layout_get_size (layout, NULL, NULL);
+  attrs = pango_layout_get_log_attrs_readonly (layout, &n_attrs);
+
+  expected = g_new0 (PangoLogAttr, n_attrs);
+  pango_get_log_attrs (text, -1, 0, pango_language_from_string ("en"), expected, n_attrs);
+
+  for (int i = 0; i < n_attrs; i++)
+    {
+      g_assert_cmpint (attrs[i].is_sentence_boundary, ==, expected[i].is_sentence_boundary);
+      g_assert_cmpint (attrs[i].is_sentence_start, ==, expected[i].is_sentence_start);
+      g_assert_cmpint (attrs[i].is_sentence_end, ==, expected[i].is_sentence_end);
+      g_assert_cmpint (attrs[i].is_word_start, ==, expected[i].is_word_start);
+      g_assert_cmpint (attrs[i].is_line_break, ==, expected[i].is_line_break);
+
+      if (attrs[i].is_sentence_end)
+        n_sentences++;
+    }
+
+  g_assert_cmpint (n_sentences, ==, 3);
+
+  g_free (expected);
+  g_object_unref (layout);
+  g_object_unref (context);
+  g_object_unref (fontmap);
+}
+
+/* Sentence attributes must survive the sentence boundaries
+ * being computed on demand
+ */
+static void
+test_sentence_attr_log_attrs (void)
+{
+  PangoFontMap *fontmap;
+  PangoContext *context;
+  PangoLayout *layout;
+  PangoAttrList *list;
+  PangoAttribute *attr;
+  const PangoLogAttr *attrs;
+  PangoLogAttr *expected;
+  const char *text = "Hello there. How are you? Fine, thanks.";
+  int n_attrs;
+
+  fontmap = pango_cairo_font_map_new ();
+  context = pango_font_map_create_context (fontmap);
+  layout = pango_layout_new (context);
+  pango_layout_set_text (layout, text, -1);
+  pango_layout_set_width (layout, 50 * PANGO_SCALE);
+
+  /* Make the first two sentences one */
+  list = pango_attr_list_new ();
+  attr = pango_attr_sentence_new ();
+  attr->start_index = 0;
+  attr->end_index = 26;
+  pango_attr_list_insert (list, attr);
+  pango_layout_set_attributes (layout, list);
+
+  pango_layout_get_size (layout, NULL, NULL);
+  attrs = pango_layout_get_log_attrs_readonly (layout, &n_attrs);
+
+  expected = g_new0 (PangoLogAttr, n_attrs);
+  pango_get_log_attrs (text, -1, 0, pango_language_from_string ("en"), expected, n_attrs);
+  pango_attr_break (text, -1, list, 0, expected, n_attrs);
+
+  g_assert_false (expected[13].is_sentence_boundary);
+  g_assert_true (expected[26].is_sentence_boundary);
+
+  for (int i = 0; i < n_attrs; i++)
+    {
+      g_assert_cmpint (attrs[i].is_sentence_boundary, ==, expected[i].is_sentence_boundary);
+      g_assert_cmpint (attrs[i].is_sentence_start, ==, expected[i].is_sentence_start);
+      g_assert_cmpint (attrs[i].is_sentence_end, ==, expected[i].is_sentence_end);
+    }
+
+  pango_attr_list_unref (list);
+  g_free (expected);
+  g_object_unref (layout);
+  g_object_unref (context);
+  g_object_unref (fontmap);
+}
+
+/* Test that tailoring sees across item boundaries that
+ * don't change the script or language
+ */
+static void
+test_tailor_across_items (void)
+{
+  PangoFontMap *fontmap;
+  PangoContext *context;
+  PangoLayout *layout;
+  PangoAttrList *attrs;
+  PangoAttribute *attr;
+  const PangoLogAttr *log_attrs;
+  /* ALEF, MADDAH ABOVE */
+  const char *text = "\xd8\xa7\xd9\x93";
+  int n_attrs;
+
+  fontmap = pango_cairo_font_map_new ();
+  context = pango_font_map_create_context (fontmap);
+  layout = pango_layout_new (context);
+  pango_layout_set_text (layout, text, -1);
+
+  attrs = pango_attr_list_new ();
+  attr = pango_attr_size_new (20 * PANGO_SCALE);
+  attr->start_index = 2;
+  attr->end_index = 4;
+  pango_attr_list_insert (attrs, attr);
+  pango_layout_set_attributes (layout, attrs);
+  pango_attr_list_unref (attrs);
+
+  log_attrs = pango_layout_get_log_attrs_readonly (layout, &n_attrs);
+  g_assert_cmpint (n_attrs, ==, 3);
+  g_assert_false (log_attrs[2].backspace_deletes_character);
+
+  g_object_unref (layout);
+  g_object_unref (context);
+  g_object_unref (fontmap);
+}
+
+/* Test dictionary-based breaking, with the dictionary
+ * in tests/dicts/lao.dict
+ */
+static void
+test_break_dict (void)
+{
+  /* "sabai" "di" */
+  const char *text = "\xe0\xba\xaa\xe0\xba\xb0\xe0\xba\x9a\xe0\xba\xb2\xe0\xba\x8d"
+                     "\xe0\xba\x94\xe0\xba\xb5";
+  PangoLogAttr attrs[8];
+
+  pango_get_log_attrs (text, -1, -1, pango_language_from_string ("lo"), attrs, G_N_ELEMENTS (attrs));
+
+  for (int i = 1; i < 7; i++)
+    g_assert_true (attrs[i].is_line_break == (i == 5));
+  g_assert_true (attrs[5].is_word_start);
+  g_assert_true (attrs[5].is_word_end);
+}
+
+/* Runs of letters too long to segment at once still
+ * get all their word boundaries
+ */
+static void
+test_break_dict_long (void)
+{
+  GString *text;
+  PangoLogAttr attrs[40 * 7 + 1];
+
+  text = g_string_new (NULL);
+  for (int i = 0; i < 40; i++)
+    g_string_append (text, "\xe0\xba\xaa\xe0\xba\xb0\xe0\xba\x9a\xe0\xba\xb2\xe0\xba\x8d"
+                           "\xe0\xba\x94\xe0\xba\xb5");
+
+  pango_get_log_attrs (text->str, text->len, -1, pango_language_from_string ("lo"), attrs, G_N_ELEMENTS (attrs));
+
+  for (int i = 1; i < G_N_ELEMENTS (attrs) - 1; i++)
+    g_assert_true (attrs[i].is_line_break == (i % 7 == 0 || i % 7 == 5));
+
+  g_string_free (text, TRUE);
+}
+
+static void
+test_log_attrs_perf (void)
+{
+  PangoFontMap *fontmap;
+  PangoContext *context;
+  PangoLayout *layout;
+  GString *str;
+  double layout_time, attrs_time;
+
+  str = g_string_new ("");
+  for (int i = 0; i < 2000; i++)
+    g_string_append (str, "The quick brown fox jumps over the lazy dog. Is it? It is!\n");
+
+  fontmap = pango_cairo_font_map_new ();
+  context = pango_font_map_create_context (fontmap);
+  layout = pango_layout_new (context);
+  pango_layout_set_width (layout, 200 * PANGO_SCALE);
+  pango_layout_set_text (layout, str->str, str->len);
+
+  g_test_timer_start ();
+  pango_layout_get_size (layout, NULL, NULL);
+  layout_time = g_test_timer_elapsed ();
+
+  g_test_timer_start ();
+  pango_layout_get_log_attrs_readonly (layout, NULL);
+  attrs_time = g_test_timer_elapsed ();
+
+  g_test_minimized_result (layout_time, "layout %lu bytes: %f s", (gulong) str->len, layout_time);
+  g_test_minimized_result (attrs_time, "sentence attrs on demand: %f s", attrs_time);
+
+  g_string_free (str, TRUE);
+  g_object_unref (layout);
+  g_object_unref (context);
+  g_object_unref (fontmap);
+}
+
+static void
+test_width_relayout_perf (void)
+{
+  PangoFontMap *fontmap;
+  PangoContext *context;
+  PangoLayout *layout;
+  GString *str;
+  double first_time, resize_time;
+
+  str = g_string_new ("");
+  for (int i = 0; i < 200; i++)
+    g_string_append (str, "The quick brown fox jumps over the lazy dog. Is it? It is!\n");
+
+  fontmap = pango_cairo_font_map_new ();
+  context = pango_font_map_create_context (fontmap);
+  layout = pango_layout_new (context);
+  pango_layout_set_text (layout, str->str, str->len);
+  pango_layout_set_width (layout, 100 * PANGO_SCALE);
+
+  g_test_timer_start ();
+  pango_layout_get_size (layout, NULL, NULL);
+  first_time = g_test_timer_elapsed ();
+
+  g_test_timer_start ();
+  for (int i = 0; i < 100; i++)
+    {
+      pango_layout_set_width (layout, (100 + 4 * i) * PANGO_SCALE);
+      pango_layout_get_size (layout, NULL, NULL);
+    }
+  resize_time = g_test_timer_elapsed ();
+
+  g_test_minimized_result (first_time, "first layout: %f s", first_time);
+  g_test_minimized_result (resize_time, "100 width changes: %f s", resize_time);
+
+  g_string_free (str, TRUE);
+  g_object_unref (layout);
+  g_object_unref (context);
+  g_object_unref (fontmap);
+}
+
+static void
+test_measure_perf (void)
+{
+  PangoFontMap *fontmap;
+  PangoContext *context;
+  PangoLayout *layout;
+  char text[64];
+  double size_time, measure_time;
+
+  fontmap = pango_cairo_font_map_new ();
+  context = pango_font_map_create_context (fontmap);
+  layout = pango_layout_new (context);
+  pango_layout_set_width (layout, 100 * PANGO_SCALE);
+
+  g_test_timer_start ();
+  for (int i = 0; i < 10000; i++)
+    {
+      int width, height;
+
+      g_snprintf (text, sizeof (text), "Cell %d of a rather large table", i);
+      pango_layout_set_text (layout, text, -1);
+      pango_layout_get_pixel_size (layout, &width, &height);
+    }
+  size_time = g_test_timer_elapsed ();
+
+  g_test_timer_start ();
+  for (int i = 0; i < 10000; i++)
+    {
+      int width, height;
+
+      g_snprintf (text, sizeof (text), "Cell %d of a rather large table", i);
+      pango_layout_set_text (layout, text, -1);
+      pango_layout_measure (layout, &width, &height, NULL, NULL);
+    }
+  measure_time = g_test_timer_elapsed ();
+
+  g_test_minimized_result (size_time, "10000 cells, get_pixel_size: %f s", size_time);
+  g_test_minimized_result (measure_time, "10000 cells, measure: %f s", measure_time);
+
+  g_object_unref (layout);
+  g_object_unref (context);
+  g_object_unref (fontmap);
+}
+
+static void
+test_hit_testing_perf (void)
+{
+  PangoFontMap *fontmap;
+  PangoContext *context;
+  PangoLayout *layout;
+  PangoLayoutLine *line;
+  GString *str;
+  int width;
+  double x_time, index_time;
+
+  str = g_string_new ("");
+  while (str->len < 10000)
+    g_string_append (str, "The quick brown fox jumps over the lazy dog. ");
+
+  fontmap = pango_cairo_font_map_new ();
+  context = pango_font_map_create_context (fontmap);
+  layout = pango_layout_new (context);
+  pango_layout_set_text (layout, str->str, str->len);
+  line = pango_layout_get_line_readonly (layout, 0);
+  pango_layout_get_size (layout, &width, NULL);
+
+  /* Move the mouse across the line */
+  g_test_timer_start ();
+  for (int i = 0; i < 10000; i++)
+    {
+      int index, trailing;
+
+      pango_layout_line_x_to_index (line, (gint64) width * i / 10000, &index, &trailing);
+    }
+  x_time = g_test_timer_elapsed ();
+
+  g_test_timer_start ();
+  for (int i = 0; i < str->len; i++)
+    {
+      int x;
+
+      pango_layout_line_index_to_x (line, i, FALSE, &x);
+    }
+  index_time = g_test_timer_elapsed ();
+
+  g_test_minimized_result (x_time, "10000 x_to_index on a line of %lu chars: %f s", (gulong) str->len, x_time);
+  g_test_minimized_result (index_time, "%lu index_to_x: %f s", (gulong) str->len, index_time);
+
+  g_string_free (str, TRUE);
+  g_object_unref (layout);
+  g_object_unref (context);
+  g_object_unref (fontmap);
+}
+
+/* Draw a small layout over and over, as a widget
+ * redrawing a label would
+ */
+static void
+test_redraw_perf (void)
+{
+  PangoFontMap *fontmap;
+  PangoContext *context;
+  PangoLayout *layout;
+  cairo_surface_t *surface;
+  cairo_t *cr;
+  double iter_time, draw_time;
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 200, 100);
+  cr = cairo_create (surface);
+
+  fontmap = pango_cairo_font_map_new ();
+  context = pango_font_map_create_context (fontmap);
+  layout = pango_layout_new (context);
+  pango_layout_set_text (layout, "Cancel\nOK", -1);
+  pango_layout_set_alignment (layout, PANGO_ALIGN_CENTER);
+  pango_layout_set_width (layout, 200 * PANGO_SCALE);
+
+  g_test_timer_start ();
+  for (int i = 0; i < 100000; i++)
+    {
+      PangoLayoutIter *iter;
+
+      iter = pango_layout_get_iter (layout);
+      while (pango_layout_iter_next_run (iter))
+        ;
+      pango_layout_iter_free (iter);
+    }
+  iter_time = g_test_timer_elapsed ();
+
+  g_test_timer_start ();
+  for (int i = 0; i < 10000; i++)
+    {
+      cairo_move_to (cr, 0, 0);
+      pango_cairo_show_layout (cr, layout);
+    }
+  draw_time = g_test_timer_elapsed ();
+
+  g_test_minimized_result (iter_time, "100000 iterations over a 2 line layout: %f s", iter_time);
+  g_test_minimized_result (draw_time, "10000 draws of a 2 line layout: %f s", draw_time);
+
+  g_object_unref (layout);
+  g_object_unref (context);
+  g_object_unref (fontmap);
+  cairo_destroy (cr);
+  cairo_surface_destroy (surface);
+}
+
+static double
+time_hex_boxes (cairo_t *cr,
+                int      n_distinct)
+{
+  PangoFontMap *fontmap;
+  PangoContext *context;
+  PangoLayout *layout;
+  GString *text;
+  double elapsed;
+
+  /* Like a log with binary junk in it */
+  text = g_string_new (NULL);
+  for (int i = 0; i < 2000; i++)
+    {
+      g_string_append_unichar (text, 0xe000 + (i * 7919) % n_distinct);
+      if (i % 80 == 79)
+        g_string_append_c (text, '\n');
+    }
+
+  /* A new font map, so no boxes are cached yet */
+  fontmap = pango_cairo_font_map_new ();
+  context = pango_font_map_create_context (fontmap);
+  layout = pango_layout_new (context);
+  pango_layout_set_text (layout, text->str, text->len);
+  pango_layout_get_extents (layout, NULL, NULL);
+
+  g_test_timer_start ();
+  for (int i = 0; i < 20; i++)
+    {
+      cairo_move_to (cr, 0, 0);
+      pango_cairo_show_layout (cr, layout);
+    }
+  elapsed = g_test_timer_elapsed ();
+
+  g_object_unref (layout);
+  g_object_unref (context);
+  g_object_unref (fontmap);
+  g_string_free (text, TRUE);
+
+  return elapsed;
+}
+
+static void
+test_hex_boxes_perf (void)
+{
+  cairo_surface_t *surface;
+  cairo_t *cr;
+  double elapsed;
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 800, 600);
+  cr = cairo_create (surface);
+
+  elapsed = time_hex_boxes (cr, 64);
+  g_test_minimized_result (elapsed, "20 draws of 2000 hex boxes: %f s", elapsed);
+
+  /* With more distinct boxes than the cache holds, the boxes
+   * that don't fit are drawn directly, without being recorded
+   */
+  elapsed = time_hex_boxes (cr, 2000);
+  g_test_minimized_result (elapsed, "20 draws of 2000 uncached hex boxes: %f s", elapsed);
+
+  cairo_destroy (cr);
+  cairo_surface_destroy (surface);
+}
+
+/* Scroll through a long layout, drawing only
+ * what is visible in a small window
+ */
+static void
+test_clipped_draw_perf (void)
+{
+  PangoFontMap *fontmap;
+  PangoContext *context;
+  PangoLayout *layout;
+  cairo_surface_t *surface;
+  cairo_t *cr;
+  GString *str;
+  int height;
+  double time;
+
+  str = g_string_new ("");
+  for (int i = 0; i < 10000; i++)
+    g_string_append_printf (str, "Line %d: the quick brown fox jumps over the lazy dog\n", i);
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 800, 600);
+  cr = cairo_create (surface);
+
+  fontmap = pango_cairo_font_map_new ();
+  context = pango_font_map_create_context (fontmap);
+  layout = pango_layout_new (context);
+  pango_layout_set_text (layout, str->str, str->len);
+  pango_layout_get_pixel_size (layout, NULL, &height);
+
+  g_test_timer_start ();
+  for (int i = 0; i < 1000; i++)
+    {
+      cairo_move_to (cr, 0, - (double) height * i / 1000);
+      pango_cairo_show_layout (cr, layout);
+    }
+  time = g_test_timer_elapsed ();
+
+  g_test_minimized_result (time, "1000 draws of a 600px window into %d lines: %f s", 10000, time);
+
+  g_string_free (str, TRUE);
+  g_object_unref (layout);
+  g_object_unref (context);
+  g_object_unref (fontmap);
+  cairo_destroy (cr);
+  cairo_surface_destroy (surface);
+}
+
+static void
+test_render_list_perf (void)
+{
+  PangoFontMap *fontmap;
+  PangoContext *context;
+  PangoLayout *layout;
+  PangoRenderList *list;
+  cairo_surface_t *surface;
+  cairo_t *cr;
+  double layout_time, list_time;
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 400, 200);
+  cr = cairo_create (surface);
+
+  fontmap = pango_cairo_font_map_new ();
+  context = pango_font_map_create_context (fontmap);
+  layout = pango_layout_new (context);
+  pango_layout_set_markup (layout,
+                           "<u>File</u>  <b>Edit</b>  <span foreground='red'>View</span>\n"
+                           "<s>Help</s>  <span background='yellow'>Tools</span>",
+                           -1);
+  list = pango_render_list_new (layout);
+
+  g_test_timer_start ();
+  for (int i = 0; i < 10000; i++)
+    {
+      cairo_move_to (cr, 0, 0);
+      pango_cairo_show_layout (cr, layout);
+    }
+  layout_time = g_test_timer_elapsed ();
+
+  g_test_timer_start ();
+  for (int i = 0; i < 10000; i++)
+    {
+      cairo_move_to (cr, 0, 0);
+      pango_cairo_show_render_list (cr, list);
+    }
+  list_time = g_test_timer_elapsed ();
+
+  g_test_minimized_result (layout_time, "10000 draws of a layout: %f s", layout_time);
+  g_test_minimized_result (list_time, "10000 draws of its render list: %f s", list_time);
+
+  pango_render_list_unref (list);
+  g_object_unref (layout);
+  g_object_unref (context);
+  g_object_unref (fontmap);
+  cairo_destroy (cr);
+  cairo_surface_destroy (surface);
+}
+
+static gboolean
+in_intervals (gunichar              ch,
+              const struct Interval *table,
+              guint                  n)
+{
+  for (guint i = 0; i < n; i++)
+    {
+      if (table[i].start <= ch && ch <= table[i].end)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+/* Check the lookup tries against the interval tables they were
+ * generated from. Walking all of Unicode takes a while, so unless
+ * running slow tests, only sample it and check the interval ends.
+ */
+static void
+check_emoji_trie (gunichar ch)
+{
+  guint8 props = _pango_emoji_props_lookup (ch);
+
+#define CHECK(table, prop) \
+  g_assert_true (in_intervals (ch, table, G_N_ELEMENTS (table)) == ((props & prop) != 0))
+
+  CHECK (_pango_Emoji_table, PANGO_EMOJI_PROP_EMOJI);
+  CHECK (_pango_Emoji_Presentation_table, PANGO_EMOJI_PROP_PRESENTATION);
+  CHECK (_pango_Emoji_Modifier_table, PANGO_EMOJI_PROP_MODIFIER);
+  CHECK (_pango_Emoji_Modifier_Base_table, PANGO_EMOJI_PROP_MODIFIER_BASE);
+  CHECK (_pango_Extended_Pictographic_table, PANGO_EMOJI_PROP_EXTENDED_PICTOGRAPHIC);
+
+#undef CHECK
+}
+
+static void
+check_upright_trie (gunichar ch)
+{
+  gboolean upright = FALSE;
+
+  for (guint i = 0; i < G_N_ELEMENTS (_pango_upright_table); i++)
+    {
+      if (_pango_upright_table[i][0] <= ch && ch <= _pango_upright_table[i][1])
+        {
+          upright = TRUE;
+          break;
+        }
+    }
+
+  g_assert_true (upright == (_pango_upright_lookup (ch) != 0));
+}
+
+static void
+check_emoji_interval_ends (const struct Interval *table,
+                           guint                  n)
+{
+  for (guint i = 0; i < n; i++)
+    {
+      if (table[i].start > 0)
+        check_emoji_trie (table[i].start - 1);
+      check_emoji_trie (table[i].start);
+      check_emoji_trie (table[i].end);
+      check_emoji_trie (table[i].end + 1);
+    }
+}
+
+static void
+test_emoji_trie (void)
+{
+  gunichar step = g_test_slow () ? 1 : 61;
+
+  for (gunichar ch = 0; ch <= 0x10FFFF + 1; ch += step)
+    check_emoji_trie (ch);
+
+  check_emoji_trie (0x10FFFF);
+  check_emoji_trie (0x10FFFF + 1);
+  check_emoji_interval_ends (_pango_Emoji_table, G_N_ELEMENTS (_pango_Emoji_table));
+  check_emoji_interval_ends (_pango_Emoji_Presentation_table, G_N_ELEMENTS (_pango_Emoji_Presentation_table));
+  check_emoji_interval_ends (_pango_Emoji_Modifier_table, G_N_ELEMENTS (_pango_Emoji_Modifier_table));
+  check_emoji_interval_ends (_pango_Emoji_Modifier_Base_table, G_N_ELEMENTS (_pango_Emoji_Modifier_Base_table));
+  check_emoji_interval_ends (_pango_Extended_Pictographic_table, G_N_ELEMENTS (_pango_Extended_Pictographic_table));
+}
+
+static void
+test_upright_trie (void)
+{
+  gunichar step = g_test_slow () ? 1 : 61;
+
+  for (gunichar ch = 0; ch <= 0x10FFFF + 1; ch += step)
+    check_upright_trie (ch);
+
+  check_upright_trie (0x10FFFF);
+  check_upright_trie (0x10FFFF + 1);
+
+  for (guint i = 0; i < G_N_ELEMENTS (_pango_upright_table); i++)
+    {
+      check_upright_trie (_pango_upright_table[i][0] - 1);
+      check_upright_trie (_pango_upright_table[i][0]);
+      check_upright_trie (_pango_upright_table[i][1]);
+      check_upright_trie (_pango_upright_table[i][1] + 1);
+    }
+}
+
+static void
+test_tailor_break_perf (void)
+{
+  const char *names[] = { "test-thai.txt", "test-lao.txt", "test-arabic.txt" };
+
+  for (guint i = 0; i < G_N_ELEMENTS (names); i++)
+    {
+      PangoFontMap *fontmap;
+      PangoContext *context;
+      PangoLayout *layout;
+      char *filename;
+      char *contents;
+      gsize length;
+      GError *error = NULL;
+      double elapsed;
+
+      filename = g_test_build_filename (G_TEST_DIST, "..", "utils", names[i], NULL);
+      g_file_get_contents (filename, &contents, &length, &error);
+      g_assert_no_error (error);
+
+      fontmap = pango_cairo_font_map_new ();
+      context = pango_font_map_create_context (fontmap);
+      layout = pango_layout_new (context);
+
+      g_test_timer_start ();
+      for (int j = 0; j < 100; j++)
+        {
+          pango_layout_set_text (layout, contents, length);
+          pango_layout_get_log_attrs_readonly (layout, NULL);
+        }
+      elapsed = g_test_timer_elapsed ();
+
+      g_test_minimized_result (elapsed, "%s: %f s", names[i], elapsed);
+
+      g_object_unref (layout);
+      g_object_unref (context);
+      g_object_unref (fontmap);
+      g_free (contents);
+      g_free (filename);
+    }
+}
+
+static void
+test_markup_cache (void)
+{
+  const char *markup = "<b>bold</b> and <span foreground='red'>_red</span>";
+  PangoAttrList *attrs1, *attrs2, *attrs3;
+  char *text1, *text2;
+  gunichar accel1, accel2;
+  guint hits, misses, hits_before, misses_before;
+  char *str1, *str2;
+
+  pango_markup_cache_set_max_entries (16);
+  pango_markup_cache_get_stats (&hits_before, &misses_before);
+
+  g_assert_true (pango_parse_markup (markup, -1, '_', &attrs1, &text1, &accel1, NULL));
+  g_assert_true (pango_parse_markup (markup, -1, '_', &attrs2, &text2, &accel2, NULL));
+
+  pango_markup_cache_get_stats (&hits, &misses);
+  g_assert_cmpuint (hits - hits_before, ==, 1);
+  g_assert_cmpuint (misses - misses_before, ==, 1);
+
+  g_assert_cmpstr (text1, ==, text2);
+  g_assert_cmpstr (text1, ==, "bold and red");
+  g_assert_true (accel1 == 'r' && accel2 == 'r');
+  g_assert_true (attrs1 != attrs2);
+  g_assert_true (pango_attr_list_equal (attrs1, attrs2));
+
+  /* Modifying a result must not affect the cache */
+  pango_attr_list_insert (attrs1, pango_attr_size_new (10 * PANGO_SCALE));
+  g_assert_false (pango_attr_list_equal (attrs1, attrs2));
+
+  g_assert_true (pango_parse_markup (markup, -1, '_', &attrs3, NULL, NULL, NULL));
+  str1 = pango_attr_list_to_string (attrs2);
+  str2 = pango_attr_list_to_string (attrs3);
+  g_assert_cmpstr (str1, ==, str2);
+  g_free (str1);
+  g_free (str2);
+
+  /* A different accel marker is a different entry */
+  pango_attr_list_unref (attrs3);
+  g_assert_true (pango_parse_markup (markup, -1, 0, &attrs3, NULL, NULL, NULL));
+  g_assert_false (pango_attr_list_equal (attrs2, attrs3));
+
+  pango_markup_cache_get_stats (&hits, &misses);
+  g_assert_cmpuint (hits - hits_before, ==, 2);
+  g_assert_cmpuint (misses - misses_before, ==, 2);
+
+  /* Errors are reported every time */
+  g_assert_false (pango_parse_markup ("<b>bold", -1, 0, NULL, NULL, NULL, NULL));
+  g_assert_false (pango_parse_markup ("<b>bold", -1, 0, NULL, NULL, NULL, NULL));
+
+  pango_markup_cache_set_max_entries (0);
+
+  pango_attr_list_unref (attrs1);
+  pango_attr_list_unref (attrs2);
+  pango_attr_list_unref (attrs3);
+  g_free (text1);
+  g_free (text2);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  /* Dictionaries are loaded once, on first use, so this
+   * has to be set before any test breaks text with them
+   */
+  g_setenv ("PANGO_DICTDIR", g_test_get_filename (G_TEST_DIST, "dicts", NULL), TRUE);
+
+  g_test_add_func ("/layout/shape-tab-crash", test_shape_tab_crash);
+  g_test_add_func ("/layout/itemize-empty-crash", test_itemize_empty_crash);
+  g_test_add_func ("/layout/itemize-utf8", test_itemize_utf8);
+  g_test_add_func ("/layout/itemize-vertical-width", test_itemize_vertical_width);
+  g_test_add_func ("/layout/short-string-crash", test_short_string_crash);
+  g_test_add_func ("/language/emoji-crash", test_language_emoji_crash);
+  g_test_add_func ("/layout/line-height", test_line_height);
+  g_test_add_func ("/layout/line-height2", test_line_height2);
+  g_test_add_func ("/layout/line-height3", test_line_height3);
+  g_test_add_func ("/layout/run-height", test_run_height);
+  g_test_add_func ("/layout/cursor-height", test_cursor_height);
+  g_test_add_func ("/layout/cursor-height2", test_cursor_height2);
+  g_test_add_func ("/attr-list/update", test_attr_list_update);
+  g_test_add_func ("/misc/version-info", test_version_info);
+  g_test_add_func ("/misc/is-zerowidth", test_is_zero_width);
+  g_test_add_func ("/misc/emoji-trie", test_emoji_trie);
+  g_test_add_func ("/misc/upright-trie", test_upright_trie);
+  g_test_add_func ("/gravity/to-rotation", test_gravity_to_rotation);
+  g_test_add_func ("/gravity/from-matrix", test_gravity_from_matrix);
+  g_test_add_func ("/gravity/for-script", test_gravity_for_script);
+  g_test_add_func ("/layout/fallback-shape", test_fallback_shape);
+  g_test_add_func ("/layout/shape-to-buffers", test_shape_to_buffers);
+  g_test_add_func ("/layout/merge-shaping", test_merge_shaping);
+  g_test_add_func ("/layout/subpixel-positions", test_subpixel_positions);
+  g_test_add_func ("/layout/coalesce-itemize-attrs", test_coalesce_itemize_attrs);
+  g_test_add_func ("/layout/lazy-sentence-attrs", test_lazy_sentence_attrs);
+  g_test_add_func ("/layout/sentence-attr-log-attrs", test_sentence_attr_log_attrs);
+  g_test_add_func ("/layout/tailor-across-items", test_tailor_across_items);
+  g_test_add_func ("/break/dict", test_break_dict);
+  g_test_add_func ("/break/dict-long", test_break_dict_long);
+#ifdef HAVE_CAIRO_FREETYPE
+  g_test_add_func ("/language/to-tag", test_language_to_tag);
+#endif
+  g_test_add_func ("/bidi/get-cursor-crash", test_get_cursor_crash);
+  g_test_add_func ("/bidi/get-cursor", test_get_cursor);
+  g_test_add_func ("/layout/index-to-x", test_index_to_x);
+  g_test_add_func ("/layout/line-hit-testing", test_line_hit_testing);
+  g_test_add_func ("/layout/extents", test_extents);
+  g_test_add_func ("/layout/empty-line-height", test_empty_line_height);
+  g_test_add_func ("/layout/gravity-metrics", test_gravity_metrics);
+  g_test_add_func ("/layout/wrap-char", test_wrap_char);
+  g_test_add_func ("/layout/width-relayout", test_width_relayout);
+  g_test_add_func ("/layout/measure", test_measure);
+  g_test_add_func ("/layout/iter-line-extents", test_iter_line_extents);
+  g_test_add_func ("/layout/clipped-draw", test_clipped_draw);
+  g_test_add_func ("/layout/render-list", test_render_list);
+  g_test_add_func ("/layout/render-list-shape", test_render_list_shape);
+  g_test_add_func ("/layout/hex-boxes", test_hex_boxes);
+#ifdef HAVE_FREETYPE
+  g_test_add_func ("/layout/size-without-ink", test_size_without_ink);
+  g_test_add_func ("/ft2/atlas", test_ft2_atlas);
+  g_test_add_func ("/ft2/atlas-matrix", test_ft2_atlas_matrix);
+  g_test_add_func ("/ft2/decorations", test_ft2_decorations);
+#endif
+  g_test_add_func ("/matrix/transform-rectangle", test_transform_rectangle);
+  g_test_add_func ("/itemize/small-caps-crash", test_small_caps_crash);
+  g_test_add_func ("/markup/cache", test_markup_cache);
+
+  if (g_test_perf ())
+    {
+      g_test_add_func ("/perf/log-attrs", test_log_attrs_perf);
+      g_test_add_func ("/perf/tailor-break", test_tailor_break_perf);
+      g_test_add_func ("/perf/width-relayout", test_width_relayout_perf);
+      g_test_add_func ("/perf/measure", test_measure_perf);
+      g_test_add_func ("/perf/hit-testing", test_hit_testing_perf);
+      g_test_add_func ("/perf/redraw", test_redraw_perf);
+      g_test_add_func ("/perf/clipped-draw", test_clipped_draw_perf);
+      g_test_add_func ("/perf/render-list", test_render_list_perf);
+      g_test_add_func ("/perf/hex-boxes", test_hex_boxes_perf);
+#ifdef HAVE_FREETYPE
+      g_test_add_func ("/perf/ft2-decorations", test_ft2_decorations_perf);
+#endif
+    }
 
   return g_test_run ();
 }
@@ -0,0 +1,73 @@
+#!/usr/bin/python3
+#
+# Compiles a word list into a break dictionary for
+# pango/break-dict.c. The word list is UTF-8 text with one
+# word per line; empty lines and lines starting with '#' are
+# ignored. All characters of the words must lie in the 256
+# codepoints starting at BASE.
+#
+# usage: ./gen-break-dict.py BASE words.txt output.dict
+#
+# e.g. ./gen-break-dict.py 0x0E80 lao-words.txt lao.dict
+#
+# The build runs this for the word lists in the directory given
+# by the break-dicts option, and installs the dictionaries into
+# $datadir/pango/dict.
+
+import struct
+import sys
+
+MAGIC = 0x44424750 # "PGBD"
+VERSION = 1
+
+if len(sys.argv) != 4:
+	print("usage: ./gen-break-dict.py BASE words.txt output.dict", file=sys.stderr)
+	sys.exit(1)
+
+base = int(sys.argv[1], 0)
+
+words = set()
+with open(sys.argv[2], encoding='utf-8') as f:
+	for line in f:
+		word = line.strip()
+		if not word or word[0] == '#':
+			continue
+		for ch in word:
+			if not base <= ord(ch) <= base + 255:
+				print("%s: U+%04X is outside the dictionary range" % (word, ord(ch)), file=sys.stderr)
+				sys.exit(1)
+		words.add(word)
+
+# Build the trie as nested dicts, then number the nodes breadth-first
+root = {}
+for word in words:
+	node = root
+	for ch in word:
+		node = node.setdefault(ord(ch) - base, {})
+	node[None] = True
+
+nodes = [root]
+i = 0
+while i < len(nodes):
+	for label in sorted(k for k in nodes[i] if k is not None):
+		nodes.append(nodes[i][label])
+	i += 1
+index = {id(node): i for i, node in enumerate(nodes)}
+
+node_data = []
+targets = []
+labels = []
+for node in nodes:
+	edges = sorted(k for k in node if k is not None)
+	node_data.append(struct.pack('<IHH', len(targets), len(edges), 1 if None in node else 0))
+	for label in edges:
+		targets.append(index[id(node[label])])
+		labels.append(label)
+
+max_word_length = max((len(w) for w in words), default=0)
+
+with open(sys.argv[3], 'wb') as f:
+	f.write(struct.pack('<6I', MAGIC, VERSION, base, len(nodes), len(targets), max_word_length))
+	f.write(b''.join(node_data))
+	f.write(struct.pack('<%dI' % len(targets), *targets))
+	f.write(bytes(labels))
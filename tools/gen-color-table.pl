@@ -71,4 +71,107 @@ for $color (@colors) {
     $i++;
 }
 
-print "\n};\n";
+print "\n};\n\n";
+
+# Perfect hash over the lowercased names, with the "hash and
+# displace" scheme: the hash of a name picks a bucket, and the
+# displacement stored for the bucket picks the final slot.
+
+sub mul32 {
+    my ($a, $b) = @_;
+    return (($a * ($b & 0xffff)) + ((($a * ($b >> 16)) & 0xffff) << 16)) & 0xffffffff;
+}
+
+sub color_hash {
+    my $h = 0x811c9dc5;
+    for $c (unpack ("C*", lc ($_[0]))) {
+	$h = mul32 ($h ^ $c, 0x01000193);
+    }
+    return $h;
+}
+
+sub color_slot {
+    my ($h, $d) = @_;
+    return mul32 ($h ^ $d, 0x9e3779b1) >> (32 - $slot_bits);
+}
+
+$bucket_bits = 8;
+$slot_bits = 10;
+$max_length = 0;
+
+@buckets = ();
+for ($i = 0; $i < @colors; $i++) {
+    $name = $colors[$i]->[3];
+    $max_length = length ($name) if length ($name) > $max_length;
+    $colors[$i]->[5] = color_hash ($name);
+    push @{$buckets[$colors[$i]->[5] & ((1 << $bucket_bits) - 1)]}, $i;
+}
+
+@displacements = (0) x (1 << $bucket_bits);
+@slots = (0) x (1 << $slot_bits);
+
+# Place the biggest buckets first, while there is most room
+for $b (sort { scalar (@{$buckets[$b] || []}) <=> scalar (@{$buckets[$a] || []}) } 0 .. (1 << $bucket_bits) - 1) {
+    next unless $buckets[$b];
+  DISPLACEMENT:
+    for ($d = 0; ; $d++) {
+	die "Cannot find a perfect hash" if $d > 0xffff;
+	%taken = ();
+	for $i (@{$buckets[$b]}) {
+	    $slot = color_slot ($colors[$i]->[5], $d);
+	    next DISPLACEMENT if $slots[$slot] || $taken{$slot};
+	    $taken{$slot} = $i + 1;
+	}
+	$slots[$_] = $taken{$_} for keys %taken;
+	$displacements[$b] = $d;
+	last;
+    }
+}
+
+print <<EOT;
+#define COLOR_NAME_MAX_LENGTH $max_length
+
+static inline guint32
+color_name_hash (const char *key,
+                 int         len)
+{
+  guint32 h = 0x811c9dc5u;
+
+  for (int i = 0; i < len; i++)
+    h = (h ^ (guchar) key[i]) * 0x01000193u;
+
+  return h;
+}
+
+static const guint16 color_displacements[@{[1 << $bucket_bits]}] = {
+EOT
+
+sub print_rows {
+    my @values = @_;
+    while (@values) {
+	print "  " . join (" ", map { "$_," } splice (@values, 0, 16)) . "\n";
+    }
+}
+
+print_rows (@displacements);
+
+print <<EOT;
+};
+
+/* Index into color_entries + 1 for each slot, 0 if unused */
+static const guint16 color_slots[@{[1 << $slot_bits]}] = {
+EOT
+
+print_rows (@slots);
+
+print <<EOT;
+};
+
+static inline guint
+color_name_slot (guint32 h)
+{
+  guint32 d = color_displacements[h & @{[(1 << $bucket_bits) - 1]}];
+
+  return ((h ^ d) * 0x9e3779b1u) >> @{[32 - $slot_bits]};
+}
+EOT
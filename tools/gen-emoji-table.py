@@ -5,6 +5,9 @@ import sys
 import os.path
 from collections import OrderedDict
 
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from gen_trie import print_trie
+
 if len (sys.argv) != 2:
 	print("usage: ./gen-emoji-table.py emoji-data.txt", file=sys.stderr)
 	sys.exit (1)
@@ -53,12 +56,15 @@ print("#include <glib.h>")
 print()
 print("struct Interval {\n  gunichar start, end;\n};")
 
+props = OrderedDict([('Emoji', 'PANGO_EMOJI_PROP_EMOJI'),
+		      ('Emoji_Presentation', 'PANGO_EMOJI_PROP_PRESENTATION'),
+		      ('Emoji_Modifier', 'PANGO_EMOJI_PROP_MODIFIER'),
+		      ('Emoji_Modifier_Base', 'PANGO_EMOJI_PROP_MODIFIER_BASE'),
+		      ('Extended_Pictographic', 'PANGO_EMOJI_PROP_EXTENDED_PICTOGRAPHIC')])
+
+# The interval tables are kept as the reference the trie is tested against.
 for typ,s in ranges.items():
-	if typ not in ['Emoji',
-		       'Emoji_Presentation',
-		       'Emoji_Modifier',
-		       'Emoji_Modifier_Base',
-		       'Extended_Pictographic']: continue
+	if typ not in props: continue
 	print()
 	print("static const struct Interval _pango_%s_table[] =" % typ)
 	print("{")
@@ -66,6 +72,22 @@ for typ,s in ranges.items():
 		print("  {0x%04X, 0x%04X}," % pair)
 	print("};")
 
+values = [0] * 0x110000
+for i, typ in enumerate(props):
+	for start, end in ranges[typ]:
+		for ch in range(start, end + 1):
+			values[ch] |= 1 << i
+
+print()
+for i, typ in enumerate(props):
+	print("#define %s (1 << %d)" % (props[typ], i))
+
+limit = max(ch for ch in range(len(values)) if values[ch]) + 1
+limit = (limit + 0xFFF) & ~0xFFF
+
+print()
+print_trie("_pango_emoji_props", values, limit)
+
 print()
 print("#endif /* PANGO_EMOJI_TABLE_H */")
 print()
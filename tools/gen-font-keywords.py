@@ -0,0 +1,152 @@
+#!/usr/bin/python3
+#
+# Generates pango/pango-font-keywords.h, a perfect hash table of
+# the style words understood by pango_font_description_from_string().
+#
+# usage: ./gen-font-keywords.py > ../pango/pango-font-keywords.h
+#
+# Keywords are matched case-insensitively, and dashes in them are
+# optional, so the hash is computed over the lowercased keyword with
+# dashes removed. Keep the lists in sync with the maps in fonts.c.
+
+import sys
+
+keywords = [
+	('NORMAL', '0', 'Normal'),
+]
+
+for value, name in [
+	('PANGO_STYLE_NORMAL', 'Roman'),
+	('PANGO_STYLE_OBLIQUE', 'Oblique'),
+	('PANGO_STYLE_ITALIC', 'Italic'),
+]:
+	keywords.append(('STYLE', value, name))
+
+for value, name in [
+	('PANGO_VARIANT_SMALL_CAPS', 'Small-Caps'),
+	('PANGO_VARIANT_ALL_SMALL_CAPS', 'All-Small-Caps'),
+	('PANGO_VARIANT_PETITE_CAPS', 'Petite-Caps'),
+	('PANGO_VARIANT_ALL_PETITE_CAPS', 'All-Petite-Caps'),
+	('PANGO_VARIANT_UNICASE', 'Unicase'),
+	('PANGO_VARIANT_TITLE_CAPS', 'Title-Caps'),
+]:
+	keywords.append(('VARIANT', value, name))
+
+for value, name in [
+	('PANGO_WEIGHT_THIN', 'Thin'),
+	('PANGO_WEIGHT_ULTRALIGHT', 'Ultra-Light'),
+	('PANGO_WEIGHT_ULTRALIGHT', 'Extra-Light'),
+	('PANGO_WEIGHT_LIGHT', 'Light'),
+	('PANGO_WEIGHT_SEMILIGHT', 'Semi-Light'),
+	('PANGO_WEIGHT_SEMILIGHT', 'Demi-Light'),
+	('PANGO_WEIGHT_BOOK', 'Book'),
+	('PANGO_WEIGHT_NORMAL', 'Regular'),
+	('PANGO_WEIGHT_MEDIUM', 'Medium'),
+	('PANGO_WEIGHT_SEMIBOLD', 'Semi-Bold'),
+	('PANGO_WEIGHT_SEMIBOLD', 'Demi-Bold'),
+	('PANGO_WEIGHT_BOLD', 'Bold'),
+	('PANGO_WEIGHT_ULTRABOLD', 'Ultra-Bold'),
+	('PANGO_WEIGHT_ULTRABOLD', 'Extra-Bold'),
+	('PANGO_WEIGHT_HEAVY', 'Heavy'),
+	('PANGO_WEIGHT_HEAVY', 'Black'),
+	('PANGO_WEIGHT_ULTRAHEAVY', 'Ultra-Heavy'),
+	('PANGO_WEIGHT_ULTRAHEAVY', 'Extra-Heavy'),
+	('PANGO_WEIGHT_ULTRAHEAVY', 'Ultra-Black'),
+	('PANGO_WEIGHT_ULTRAHEAVY', 'Extra-Black'),
+]:
+	keywords.append(('WEIGHT', value, name))
+
+for value, name in [
+	('PANGO_STRETCH_ULTRA_CONDENSED', 'Ultra-Condensed'),
+	('PANGO_STRETCH_EXTRA_CONDENSED', 'Extra-Condensed'),
+	('PANGO_STRETCH_CONDENSED', 'Condensed'),
+	('PANGO_STRETCH_SEMI_CONDENSED', 'Semi-Condensed'),
+	('PANGO_STRETCH_SEMI_EXPANDED', 'Semi-Expanded'),
+	('PANGO_STRETCH_EXPANDED', 'Expanded'),
+	('PANGO_STRETCH_EXTRA_EXPANDED', 'Extra-Expanded'),
+	('PANGO_STRETCH_ULTRA_EXPANDED', 'Ultra-Expanded'),
+]:
+	keywords.append(('STRETCH', value, name))
+
+for value, name in [
+	('PANGO_GRAVITY_SOUTH', 'Not-Rotated'),
+	('PANGO_GRAVITY_SOUTH', 'South'),
+	('PANGO_GRAVITY_NORTH', 'Upside-Down'),
+	('PANGO_GRAVITY_NORTH', 'North'),
+	('PANGO_GRAVITY_EAST', 'Rotated-Left'),
+	('PANGO_GRAVITY_EAST', 'East'),
+	('PANGO_GRAVITY_WEST', 'Rotated-Right'),
+	('PANGO_GRAVITY_WEST', 'West'),
+]:
+	keywords.append(('GRAVITY', value, name))
+
+def key(name):
+	return name.lower().replace('-', '')
+
+def fnv1a(s, seed):
+	h = (0x811c9dc5 ^ seed) & 0xffffffff
+	for c in s.encode('ascii'):
+		h ^= c
+		h = (h * 0x01000193) & 0xffffffff
+	return h
+
+max_length = max(len(key(k[2])) for k in keywords)
+
+size = 64
+while True:
+	for seed in range(1 << 16):
+		slots = {}
+		for k in keywords:
+			slot = fnv1a(key(k[2]), seed) & (size - 1)
+			if slot in slots:
+				break
+			slots[slot] = k
+		else:
+			break
+	else:
+		size *= 2
+		continue
+	break
+
+print("/* == Start of generated table == */")
+print("/*")
+print(" * The following table is generated by running:")
+print(" *")
+print(" *   ./gen-font-keywords.py")
+print(" */")
+print()
+print("#ifndef PANGO_FONT_KEYWORDS_H")
+print("#define PANGO_FONT_KEYWORDS_H")
+print()
+print("#define FONT_KEYWORD_MAX_LENGTH %d" % max_length)
+print()
+print("static inline guint")
+print("font_keyword_hash (const char *key,")
+print("                   int         len)")
+print("{")
+print("  guint32 h = 0x811c9dc5u ^ %du;" % seed)
+print()
+print("  for (int i = 0; i < len; i++)")
+print("    h = (h ^ (guchar) key[i]) * 0x01000193u;")
+print()
+print("  return h & %d;" % (size - 1))
+print("}")
+print()
+print("static const FontKeyword font_keywords[] = {")
+for field, value, name in keywords:
+	print("  { \"%s\", FONT_KEYWORD_%s, %s }," % (name, field, value))
+print("};")
+print()
+print("/* Index into font_keywords + 1 for each hash value, 0 if unused */")
+print("static const guint8 font_keyword_slots[%d] = {" % size)
+row = []
+for slot in range(size):
+	row.append("%d," % (keywords.index(slots[slot]) + 1 if slot in slots else 0))
+	if len(row) == 16:
+		print("  " + " ".join(row))
+		row = []
+print("};")
+print()
+print("#endif /* PANGO_FONT_KEYWORDS_H */")
+print()
+print("/* == End of generated table == */")
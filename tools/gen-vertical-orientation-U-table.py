@@ -3,6 +3,9 @@
 import os
 import sys
 
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from gen_trie import print_trie
+
 if len(sys.argv) != 2:
     print('usage;./' + os.path.basename(__file__)  + ' VerticalOrientation.txt')
     sys.exit(1)
@@ -10,6 +13,7 @@ if len(sys.argv) != 2:
 #pick up all data from text
 data = []
 f = open(sys.argv[1], 'r')
+header = f.readline().strip()
 for line in f:
     line = line.split("#")[0].strip()
     if len(line) == 0:
@@ -48,7 +52,40 @@ for d in data:
 compressed.append(t)
 
 
-#dump vo=U
-for d in compressed:
-    if d[2] == 'U':
-        print('{0x%04X, 0x%04X},' % tuple(d[0:2]))
+#dump vo=U, as intervals and as a trie
+upright = [d[0:2] for d in compressed if d[2] == 'U']
+values = [0] * 0x110000
+for st, ed in upright:
+    for ch in range(st, ed + 1):
+        values[ch] = 1
+
+print('/* == Start of generated table == */')
+print('/*')
+print(' * The following tables are generated by running:')
+print(' *')
+print(' *   ./gen-vertical-orientation-U-table.py VerticalOrientation.txt')
+print(' *')
+print(' * on file with this header:')
+print(' *')
+print(' * %s' % header)
+print(' *')
+print(' * VO=U and VO=Tu characters are listed as upright.')
+print(' */')
+print('')
+print('#ifndef PANGO_VERTICAL_ORIENTATION_TABLE_H')
+print('#define PANGO_VERTICAL_ORIENTATION_TABLE_H')
+print('')
+print('#include <glib.h>')
+print('')
+print('/* The intervals are kept as the reference the trie is tested against */')
+print('static const gunichar _pango_upright_table[][2] =')
+print('{')
+for d in upright:
+    print('  {0x%04X, 0x%04X},' % tuple(d))
+print('};')
+print('')
+print_trie('_pango_upright', values, 0x110000)
+print('')
+print('#endif /* PANGO_VERTICAL_ORIENTATION_TABLE_H */')
+print('')
+print('/* == End of generated table == */')
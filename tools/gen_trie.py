@@ -0,0 +1,75 @@
+# Helper for the table generators: emits a three-stage lookup
+# trie for a per-codepoint byte value.
+#
+# A codepoint is split into a page (ch >> PAGE_SHIFT), a block
+# within the page and an offset within a leaf of 1 << LEAF_SHIFT
+# values. Identical leaves and identical pages are shared, so the
+# tables stay small while lookups take three loads.
+
+from __future__ import print_function, division, absolute_import
+
+PAGE_SHIFT = 12
+LEAF_SHIFT = 5
+
+def build_trie (values, limit):
+	leaf_size = 1 << LEAF_SHIFT
+	blocks_per_page = 1 << (PAGE_SHIFT - LEAF_SHIFT)
+
+	leaves = {}
+	blocks = []
+	for start in range (0, limit, leaf_size):
+		leaf = tuple (values[start:start + leaf_size])
+		blocks.append (leaves.setdefault (leaf, len (leaves)))
+
+	pages = {}
+	index = []
+	for start in range (0, len (blocks), blocks_per_page):
+		page = tuple (blocks[start:start + blocks_per_page])
+		index.append (pages.setdefault (page, len (pages)))
+
+	leaves = sorted (leaves, key=leaves.get)
+	pages = sorted (pages, key=pages.get)
+
+	return index, pages, leaves
+
+def c_type (n):
+	return 'guint8' if n <= 256 else 'guint16'
+
+def print_array (name, type, rows, width):
+	print ("static const %s %s[%d][%d] =" % (type, name, len (rows), width))
+	print ("{")
+	for row in rows:
+		print ("  {")
+		for i in range (0, width, 16):
+			print ("    " + " ".join ("%d," % v for v in row[i:i + 16]))
+		print ("  },")
+	print ("};")
+
+def print_trie (prefix, values, limit, default=0):
+	"""Print the trie for values[0:limit] and an inline
+	   <prefix>_lookup() function returning @default past @limit."""
+	assert limit % (1 << PAGE_SHIFT) == 0
+
+	index, pages, leaves = build_trie (values, limit)
+
+	print ("/* Three-stage lookup trie, see tools/gen_trie.py */")
+	print ("static const %s %s_pages[%d] =" % (c_type (len (pages)), prefix, len (index)))
+	print ("{")
+	for i in range (0, len (index), 16):
+		print ("  " + " ".join ("%d," % v for v in index[i:i + 16]))
+	print ("};")
+	print ()
+	print_array (prefix + "_blocks", c_type (len (leaves)), pages, 1 << (PAGE_SHIFT - LEAF_SHIFT))
+	print ()
+	print_array (prefix + "_leaves", "guint8", leaves, 1 << LEAF_SHIFT)
+	print ()
+	print ("static inline guint8")
+	print ("%s_lookup (gunichar ch)" % prefix)
+	print ("{")
+	print ("  if (ch >= 0x%X)" % limit)
+	print ("    return %d;" % default)
+	print ()
+	print ("  return %s_leaves[%s_blocks[%s_pages[ch >> %d]][(ch >> %d) & %d]][ch & %d];"
+	       % (prefix, prefix, prefix, PAGE_SHIFT, LEAF_SHIFT,
+		  (1 << (PAGE_SHIFT - LEAF_SHIFT)) - 1, (1 << LEAF_SHIFT) - 1))
+	print ("}")